@@ -0,0 +1,12 @@
+#pragma once
+
+// Host stand-in for the ESP-IDF GPIO numbers; pins are driven through platform.h
+
+typedef int gpio_num_t;
+
+#define GPIO_NUM_NC -1
+#define GPIO_NUM_4 4
+#define GPIO_NUM_5 5
+#define GPIO_NUM_13 13
+#define GPIO_NUM_14 14
+#define GPIO_NUM_22 22
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "esp_err.h"
+#include <stdint.h>
+
+// Host stand-in for the RMT symbol type; encoders only exist on target
+
+typedef union {
+  struct {
+    uint16_t duration0 : 15;
+    uint16_t level0 : 1;
+    uint16_t duration1 : 15;
+    uint16_t level1 : 1;
+  };
+  uint32_t val;
+} rmt_symbol_word_t;
+
+typedef struct rmt_encoder_t rmt_encoder_t;
+typedef rmt_encoder_t *rmt_encoder_handle_t;
@@ -0,0 +1,3 @@
+#pragma once
+
+// Host stand-in: the emulated nRF24 (radio_common.h) has no SPI device
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdarg.h>
+#include <stdio.h>
+
+// Host stand-in for ESP-IDF logging: warnings and errors go to stderr, the
+// rest is checked for format errors and dropped
+
+typedef enum {
+  ESP_LOG_NONE,
+  ESP_LOG_ERROR,
+  ESP_LOG_WARN,
+  ESP_LOG_INFO,
+  ESP_LOG_DEBUG,
+  ESP_LOG_VERBOSE
+} esp_log_level_t;
+
+__attribute__((format(printf, 3, 4)))
+static inline void esp_log_host(esp_log_level_t level, const char *tag, const char *format, ...) {
+  if (level > ESP_LOG_WARN)
+    return;
+
+  va_list args;
+  va_start(args, format);
+  fprintf(stderr, "%c (%s) ", level == ESP_LOG_ERROR ? 'E' : 'W', tag);
+  vfprintf(stderr, format, args);
+  fputc('\n', stderr);
+  va_end(args);
+}
+
+#define ESP_LOGE(tag, format, ...) esp_log_host(ESP_LOG_ERROR, tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) esp_log_host(ESP_LOG_WARN, tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) esp_log_host(ESP_LOG_INFO, tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) esp_log_host(ESP_LOG_DEBUG, tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) esp_log_host(ESP_LOG_VERBOSE, tag, format, ##__VA_ARGS__)
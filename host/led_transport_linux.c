@@ -0,0 +1,195 @@
+#include "led_transport_linux.h"
+#include "../include/platform.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define SYMBOLS_PER_BYTE 8
+
+typedef struct {
+  led_transport_t base;
+  const wire_map_t *wire_map;
+  size_t max_bytes;
+
+  // Frame on the wire: read at completion, like the real backends read it
+  // while it is sent
+  bool busy;
+  const uint8_t *pixels;
+  const led_symbol_span_t *spans;
+  size_t count; // Bytes or spans
+  int64_t start_us;
+
+  uint8_t *frame; // Wire bytes of the last completed frame
+  size_t frame_size;
+  uint32_t submits;
+  uint32_t span_submits;
+} linux_transport_t;
+
+static bool auto_complete = false;
+
+// Frame accepted: on the wire until completed
+static esp_err_t start_frame(linux_transport_t *transport, const uint8_t *pixels, const led_symbol_span_t *spans,
+                             size_t count) {
+  transport->busy = true;
+  transport->pixels = pixels;
+  transport->spans = spans;
+  transport->count = count;
+  transport->start_us = platform_micros();
+  transport->submits++;
+  if (auto_complete) {
+    led_transport_linux_complete(&transport->base);
+  }
+  return ESP_OK;
+}
+
+static esp_err_t linux_submit(led_transport_t *base, const uint8_t *pixels, size_t size) {
+  linux_transport_t *transport = (linux_transport_t *)base;
+  if (transport->busy)
+    return ESP_ERR_INVALID_STATE;
+  if (size > transport->max_bytes)
+    return ESP_ERR_INVALID_ARG;
+  return start_frame(transport, pixels, NULL, size);
+}
+
+static esp_err_t linux_submit_spans(led_transport_t *base, const led_symbol_span_t *spans, size_t span_count) {
+  linux_transport_t *transport = (linux_transport_t *)base;
+  if (transport->busy)
+    return ESP_ERR_INVALID_STATE;
+
+  size_t symbols = 0;
+  for (size_t i = 0; i < span_count; i++) {
+    symbols += spans[i].count;
+  }
+  if (symbols % SYMBOLS_PER_BYTE != 0 || symbols / SYMBOLS_PER_BYTE > transport->max_bytes)
+    return ESP_ERR_INVALID_ARG;
+
+  transport->span_submits++;
+  return start_frame(transport, NULL, spans, span_count);
+}
+
+// Wire bytes of the frame on the wire; symbols decode as 1 when the high time is the longer one
+static void send_frame(linux_transport_t *transport) {
+  if (transport->spans == NULL) {
+    for (size_t i = 0; i + 3 <= transport->count; i += 3) {
+      if (transport->wire_map != NULL) {
+        wire_map_pixel(transport->wire_map, &transport->pixels[i], &transport->frame[i]);
+      } else {
+        memcpy(&transport->frame[i], &transport->pixels[i], 3);
+      }
+    }
+    transport->frame_size = transport->count;
+    return;
+  }
+
+  size_t bits = 0;
+  for (size_t i = 0; i < transport->count; i++) {
+    const led_symbol_span_t *span = &transport->spans[i];
+    for (size_t s = 0; s < span->count; s++, bits++) {
+      uint8_t *byte = &transport->frame[bits / SYMBOLS_PER_BYTE];
+      *byte = (uint8_t)(*byte << 1 | (span->symbols[s].duration0 > span->symbols[s].duration1));
+    }
+  }
+  transport->frame_size = bits / SYMBOLS_PER_BYTE;
+}
+
+static void linux_abort(led_transport_t *base) {
+  ((linux_transport_t *)base)->busy = false;
+}
+
+static void linux_del(led_transport_t *base) {
+  linux_transport_t *transport = (linux_transport_t *)base;
+  free(transport->frame);
+  free(transport);
+}
+
+static esp_err_t linux_transport_new(led_transport_kind_t kind, const led_transport_config_t *config,
+                                     led_transport_t **ret_transport) {
+  linux_transport_t *transport = calloc(1, sizeof(*transport));
+  if (transport == NULL)
+    return ESP_ERR_NO_MEM;
+  transport->max_bytes = config->max_leds * 3;
+  transport->frame = calloc(transport->max_bytes, 1);
+  if (transport->frame == NULL) {
+    free(transport);
+    return ESP_ERR_NO_MEM;
+  }
+
+  transport->wire_map = config->wire_map;
+  transport->base.name = led_transport_kind_name(kind);
+  transport->base.kind = kind;
+  transport->base.submit = linux_submit;
+  transport->base.submit_spans = kind == LED_TRANSPORT_SPI_DMA ? NULL : linux_submit_spans;
+  transport->base.abort = linux_abort;
+  transport->base.del = linux_del;
+  transport->base.on_done = config->on_done;
+  transport->base.done_arg = config->done_arg;
+  *ret_transport = &transport->base;
+  return ESP_OK;
+}
+
+esp_err_t led_transport_new_rmt(const led_transport_config_t *config, bool with_dma, led_transport_t **ret_transport) {
+  return linux_transport_new(with_dma ? LED_TRANSPORT_RMT_DMA : LED_TRANSPORT_RMT, config, ret_transport);
+}
+
+esp_err_t led_transport_new_spi(const led_transport_config_t *config, led_transport_t **ret_transport) {
+  return linux_transport_new(LED_TRANSPORT_SPI_DMA, config, ret_transport);
+}
+
+// Mock outputs have no clock to share
+esp_err_t led_transport_rmt_sync_group(led_transport_t **transports, size_t count) {
+  (void)transports;
+  (void)count;
+  return ESP_OK;
+}
+
+// Same bit timing as the target encoder (led_strip_encoder.c); whole pixels
+// when there is a wire map
+esp_err_t led_strip_encode_symbols(const led_strip_encoder_config_t *config, const uint8_t *data, size_t data_size,
+                                   rmt_symbol_word_t *symbols) {
+  if (!config || !data || !symbols)
+    return ESP_ERR_INVALID_ARG;
+
+  const rmt_symbol_word_t bit0 = {.level0 = 1, .duration0 = 3 * config->resolution / 10000000,
+                                  .level1 = 0, .duration1 = 9 * config->resolution / 10000000};
+  const rmt_symbol_word_t bit1 = {.level0 = 1, .duration0 = 9 * config->resolution / 10000000,
+                                  .level1 = 0, .duration1 = 3 * config->resolution / 10000000};
+  for (size_t i = 0; i < data_size; i++) {
+    uint8_t value = data[i];
+    if (config->wire_map != NULL) {
+      uint8_t wire[3];
+      wire_map_pixel(config->wire_map, &data[i - i % 3], wire);
+      value = wire[i % 3];
+    }
+    for (int bit = 0; bit < SYMBOLS_PER_BYTE; bit++) {
+      *symbols++ = (value & (0x80 >> bit)) ? bit1 : bit0;
+    }
+  }
+  return ESP_OK;
+}
+
+void led_transport_linux_set_auto_complete(bool enable) {
+  auto_complete = enable;
+}
+
+bool led_transport_linux_complete(led_transport_t *base) {
+  linux_transport_t *transport = (linux_transport_t *)base;
+  if (!transport->busy)
+    return false;
+  send_frame(transport);
+  transport->busy = false;
+  led_transport_frame_done(base, transport->start_us, 1, 0);
+  return true;
+}
+
+size_t led_transport_linux_frame(const led_transport_t *base, const uint8_t **wire) {
+  const linux_transport_t *transport = (const linux_transport_t *)base;
+  *wire = transport->frame;
+  return transport->frame_size;
+}
+
+uint32_t led_transport_linux_submits(const led_transport_t *transport) {
+  return ((const linux_transport_t *)transport)->submits;
+}
+
+uint32_t led_transport_linux_span_submits(const led_transport_t *transport) {
+  return ((const linux_transport_t *)transport)->span_submits;
+}
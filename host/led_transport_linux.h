@@ -0,0 +1,23 @@
+#pragma once
+
+#include "../include/led_transport.h"
+
+// Controls for the Linux mock of the LED transports. Every backend kind
+// creates a mock that holds a submitted frame on the wire until it is
+// completed, and only then reads it (pixels through the wire map, or symbol
+// spans) into the wire bytes the strip would receive. The SPI kind has no
+// submit_spans, like the real backend.
+
+// Complete frames inside submit(), as if the wire took no time
+void led_transport_linux_set_auto_complete(bool auto_complete);
+
+// Finish the frame on the wire: stats and the done callback, as from the ISR.
+// False if no frame was in flight.
+bool led_transport_linux_complete(led_transport_t *transport);
+
+// Wire bytes of the last completed frame; returns their count
+size_t led_transport_linux_frame(const led_transport_t *transport, const uint8_t **wire);
+
+// Frames accepted, and how many of them came as pre-encoded symbol spans
+uint32_t led_transport_linux_submits(const led_transport_t *transport);
+uint32_t led_transport_linux_span_submits(const led_transport_t *transport);
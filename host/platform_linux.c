@@ -0,0 +1,248 @@
+#include "platform_linux.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define PLATFORM_LINUX_GPIO_COUNT 64
+#define PLATFORM_LINUX_STORAGE_SLOTS 8
+#define PLATFORM_LINUX_STORAGE_NAME 32
+#define PLATFORM_LINUX_STORAGE_BYTES 4096
+
+struct platform_mutex_s {
+  pthread_mutex_t mutex;
+};
+
+struct platform_signal_s {
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  bool given;
+};
+
+typedef struct {
+  bool used;
+  char space[PLATFORM_LINUX_STORAGE_NAME];
+  char key[PLATFORM_LINUX_STORAGE_NAME];
+  size_t size;
+  uint8_t data[PLATFORM_LINUX_STORAGE_BYTES];
+} storage_slot_t;
+
+static bool manual_clock = false;
+static int64_t manual_now_us = 0;
+static int gpio_levels[PLATFORM_LINUX_GPIO_COUNT];
+static platform_gpio_mode_t gpio_modes[PLATFORM_LINUX_GPIO_COUNT];
+static platform_isr_t gpio_handlers[PLATFORM_LINUX_GPIO_COUNT];
+static void *gpio_handler_args[PLATFORM_LINUX_GPIO_COUNT];
+static pthread_mutex_t critical_mutex = PTHREAD_MUTEX_INITIALIZER;
+static storage_slot_t storage[PLATFORM_LINUX_STORAGE_SLOTS];
+
+int64_t platform_micros(void) {
+  if (manual_clock)
+    return manual_now_us;
+
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (int64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+uint32_t platform_millis(void) {
+  return (uint32_t)(platform_micros() / 1000);
+}
+
+void platform_delay_ms(uint32_t ms) {
+  if (manual_clock) {
+    manual_now_us += (int64_t)ms * 1000;
+    return;
+  }
+
+  struct timespec delay = {.tv_sec = ms / 1000, .tv_nsec = (long)(ms % 1000) * 1000000};
+  nanosleep(&delay, NULL);
+}
+
+void platform_delay_us(uint32_t us) {
+  if (manual_clock) {
+    manual_now_us += us;
+    return;
+  }
+
+  struct timespec delay = {.tv_sec = us / 1000000, .tv_nsec = (long)(us % 1000000) * 1000};
+  nanosleep(&delay, NULL);
+}
+
+// Real time even with the manual clock, so benchmarks still measure
+uint32_t platform_cycles(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint32_t)((uint64_t)now.tv_sec * 1000000000 + now.tv_nsec);
+}
+
+uint32_t platform_cycles_per_us(void) {
+  return 1000;
+}
+
+void platform_linux_set_manual_clock(int64_t now_us) {
+  manual_clock = true;
+  manual_now_us = now_us;
+}
+
+void platform_linux_advance_us(int64_t us) {
+  manual_now_us += us;
+}
+
+platform_mutex_t platform_mutex_create(void) {
+  platform_mutex_t mutex = malloc(sizeof(*mutex));
+  if (mutex) {
+    pthread_mutex_init(&mutex->mutex, NULL);
+  }
+  return mutex;
+}
+
+void platform_mutex_lock(platform_mutex_t mutex) {
+  pthread_mutex_lock(&mutex->mutex);
+}
+
+void platform_mutex_unlock(platform_mutex_t mutex) {
+  pthread_mutex_unlock(&mutex->mutex);
+}
+
+platform_signal_t platform_signal_create(void) {
+  platform_signal_t signal = malloc(sizeof(*signal));
+  if (signal) {
+    pthread_mutex_init(&signal->mutex, NULL);
+    pthread_cond_init(&signal->cond, NULL);
+    signal->given = false;
+  }
+  return signal;
+}
+
+void platform_signal_give(platform_signal_t signal) {
+  pthread_mutex_lock(&signal->mutex);
+  signal->given = true;
+  pthread_cond_signal(&signal->cond);
+  pthread_mutex_unlock(&signal->mutex);
+}
+
+// With the manual clock nothing else runs while the caller waits, so a take
+// that would block times out at once and the clock moves on by the timeout
+bool platform_signal_take(platform_signal_t signal, uint32_t timeout_ms) {
+  pthread_mutex_lock(&signal->mutex);
+  if (!signal->given && manual_clock) {
+    manual_now_us += (int64_t)timeout_ms * 1000;
+  } else if (!signal->given) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000) {
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000000000;
+    }
+    int result = 0;
+    while (!signal->given && result != ETIMEDOUT) {
+      result = pthread_cond_timedwait(&signal->cond, &signal->mutex, &deadline);
+    }
+  }
+  bool taken = signal->given;
+  signal->given = false;
+  pthread_mutex_unlock(&signal->mutex);
+  return taken;
+}
+
+void platform_critical_enter(void) {
+  pthread_mutex_lock(&critical_mutex);
+}
+
+void platform_critical_exit(void) {
+  pthread_mutex_unlock(&critical_mutex);
+}
+
+void *platform_malloc_internal(size_t size) {
+  return malloc(size);
+}
+
+static storage_slot_t *storage_find(const char *space, const char *key) {
+  for (int i = 0; i < PLATFORM_LINUX_STORAGE_SLOTS; i++) {
+    if (storage[i].used && strcmp(storage[i].space, space) == 0 && strcmp(storage[i].key, key) == 0)
+      return &storage[i];
+  }
+  return NULL;
+}
+
+// Same contract as nvs_get_blob(): fails if the blob is larger than *size
+bool platform_storage_load(const char *space, const char *key, void *data, size_t *size) {
+  const storage_slot_t *slot = storage_find(space, key);
+  if (slot == NULL || slot->size > *size)
+    return false;
+  memcpy(data, slot->data, slot->size);
+  *size = slot->size;
+  return true;
+}
+
+bool platform_storage_store(const char *space, const char *key, const void *data, size_t size) {
+  storage_slot_t *slot = storage_find(space, key);
+  if (data == NULL) {
+    if (slot != NULL)
+      slot->used = false;
+    return true;
+  }
+  if (size > PLATFORM_LINUX_STORAGE_BYTES || strlen(space) >= PLATFORM_LINUX_STORAGE_NAME ||
+      strlen(key) >= PLATFORM_LINUX_STORAGE_NAME)
+    return false;
+
+  for (int i = 0; slot == NULL && i < PLATFORM_LINUX_STORAGE_SLOTS; i++) {
+    if (!storage[i].used)
+      slot = &storage[i];
+  }
+  if (slot == NULL)
+    return false;
+  slot->used = true;
+  strcpy(slot->space, space);
+  strcpy(slot->key, key);
+  memcpy(slot->data, data, size);
+  slot->size = size;
+  return true;
+}
+
+void platform_linux_clear_storage(void) {
+  memset(storage, 0, sizeof(storage));
+}
+
+void platform_gpio_config(int pin, platform_gpio_mode_t mode) {
+  if (pin < 0 || pin >= PLATFORM_LINUX_GPIO_COUNT)
+    return;
+  gpio_modes[pin] = mode;
+  gpio_levels[pin] = mode == PLATFORM_GPIO_INPUT_PULLUP ? 1 : 0;
+}
+
+void platform_gpio_set(int pin, int level) {
+  if (pin < 0 || pin >= PLATFORM_LINUX_GPIO_COUNT || gpio_modes[pin] != PLATFORM_GPIO_OUTPUT)
+    return;
+  gpio_levels[pin] = level ? 1 : 0;
+}
+
+int platform_gpio_get(int pin) {
+  if (pin < 0 || pin >= PLATFORM_LINUX_GPIO_COUNT)
+    return 0;
+  return gpio_levels[pin];
+}
+
+bool platform_gpio_irq(int pin, platform_isr_t handler, void *arg) {
+  if (pin < 0 || pin >= PLATFORM_LINUX_GPIO_COUNT)
+    return false;
+  platform_gpio_config(pin, PLATFORM_GPIO_INPUT_PULLUP);
+  gpio_handler_args[pin] = arg;
+  gpio_handlers[pin] = handler;
+  return true;
+}
+
+// A falling edge runs the pin's interrupt handler in the caller's thread
+void platform_linux_set_input(int pin, int level) {
+  if (pin < 0 || pin >= PLATFORM_LINUX_GPIO_COUNT)
+    return;
+  bool falling = gpio_levels[pin] && !level;
+  gpio_levels[pin] = level ? 1 : 0;
+  if (falling && gpio_handlers[pin] != NULL) {
+    gpio_handlers[pin](gpio_handler_args[pin]);
+  }
+}
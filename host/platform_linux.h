@@ -0,0 +1,17 @@
+#pragma once
+
+#include "../include/platform.h"
+
+// Controls for the Linux mock of platform.h
+
+// Freeze the tick clock at the given time; platform_delay_ms() then advances it
+// instead of sleeping, so runs are deterministic
+void platform_linux_set_manual_clock(int64_t now_us);
+void platform_linux_advance_us(int64_t us);
+
+// Level seen by platform_gpio_get() on an input pin; a falling edge runs the
+// handler from platform_gpio_irq() at once, in the caller's thread
+void platform_linux_set_input(int pin, int level);
+
+// Forget everything written with platform_storage_store()
+void platform_linux_clear_storage(void);
@@ -0,0 +1,127 @@
+// Host benchmark runner: runs the bench.h suite against a mock of the RMT
+// symbol encoder, or reads results captured from the firmware, prints them as
+// CSV and checks them against a stored baseline.
+//
+//   play_clock_bench                           -> run, CSV on stdout
+//   play_clock_bench -b bench_baseline.csv     -> run and flag cases slower than the baseline
+//   play_clock_bench -w bench_baseline.csv     -> run and store the results as the new baseline
+//   play_clock_bench -i target.csv -b base.csv -> check results from the firmware (RUN_BENCHMARKS in main.c)
+// Exits 1 if any case regressed by more than the tolerance (-t percent).
+
+#include "../include/bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_RMT_RESOLUTION_HZ 10000000 // Same as LED_TRANSPORT_RMT_RESOLUTION_HZ
+
+// rmt_symbol_word_t as a plain word: duration0:15 level0:1 duration1:15 level1:1
+static uint32_t rmt_symbol(uint32_t level0, uint32_t duration0, uint32_t level1, uint32_t duration1) {
+  return duration0 | level0 << 15 | duration1 << 16 | level1 << 31;
+}
+
+// Mock of led_strip_encode_symbols(): wire map per pixel, WS2815 bit timing, MSB first
+static void mock_rmt_encode(const uint8_t *data, size_t size, const wire_map_t *map, uint32_t *symbols) {
+  const uint32_t ticks_per_us = BENCH_RMT_RESOLUTION_HZ / 1000000;
+  const uint32_t short_ticks = 3 * ticks_per_us / 10; // 0.3 us
+  const uint32_t long_ticks = 9 * ticks_per_us / 10;  // 0.9 us
+  const uint32_t bit0 = rmt_symbol(1, short_ticks, 0, long_ticks);
+  const uint32_t bit1 = rmt_symbol(1, long_ticks, 0, short_ticks);
+  for (size_t i = 0; i + 3 <= size; i += 3) {
+    uint8_t wire[3];
+    wire_map_pixel(map, &data[i], wire);
+    for (int slot = 0; slot < 3; slot++) {
+      for (int bit = 0; bit < 8; bit++) {
+        *symbols++ = (wire[slot] & (0x80 >> bit)) ? bit1 : bit0;
+      }
+    }
+  }
+}
+
+static size_t read_results(const char *path, bench_result_t *results, size_t max_results) {
+  FILE *file = fopen(path, "r");
+  if (file == NULL) {
+    perror(path);
+    exit(2);
+  }
+  size_t count = 0;
+  char line[128];
+  while (count < max_results && fgets(line, sizeof(line), file) != NULL) {
+    if (bench_parse(line, &results[count])) {
+      count++;
+    }
+  }
+  fclose(file);
+  return count;
+}
+
+static void write_results(FILE *file, const bench_result_t *results, size_t count) {
+  fprintf(file, "%s\n", BENCH_CSV_HEADER);
+  for (size_t i = 0; i < count; i++) {
+    char line[128];
+    bench_format(&results[i], line, sizeof(line));
+    fprintf(file, "%s\n", line);
+  }
+}
+
+int main(int argc, char **argv) {
+  const char *input_path = NULL;
+  const char *baseline_path = NULL;
+  const char *write_path = NULL;
+  uint32_t tolerance_pct = BENCH_TOLERANCE_PCT;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+      input_path = argv[++i];
+    } else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+      baseline_path = argv[++i];
+    } else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+      write_path = argv[++i];
+    } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+      tolerance_pct = (uint32_t)atoi(argv[++i]);
+    } else {
+      fprintf(stderr, "usage: %s [-i results.csv] [-b baseline.csv] [-w baseline.csv] [-t tolerance_pct]\n",
+              argv[0]);
+      return 2;
+    }
+  }
+
+  static bench_result_t results[BENCH_MAX_RESULTS];
+  size_t count;
+  if (input_path != NULL) {
+    count = read_results(input_path, results, BENCH_MAX_RESULTS);
+  } else {
+    count = bench_run_all(mock_rmt_encode, results, BENCH_MAX_RESULTS);
+  }
+  write_results(stdout, results, count);
+
+  if (write_path != NULL) {
+    FILE *file = fopen(write_path, "w");
+    if (file == NULL) {
+      perror(write_path);
+      return 2;
+    }
+    write_results(file, results, count);
+    fclose(file);
+  }
+
+  int regressions = 0;
+  if (baseline_path != NULL) {
+    static bench_result_t baseline[BENCH_MAX_RESULTS];
+    size_t baseline_count = read_results(baseline_path, baseline, BENCH_MAX_RESULTS);
+    for (size_t i = 0; i < count; i++) {
+      const bench_result_t *reference = bench_find(baseline, baseline_count, &results[i]);
+      if (reference == NULL) {
+        fprintf(stderr, "new: %s leds=%u digits=%u\n", results[i].name, results[i].leds, results[i].digits);
+      } else if (bench_regressed(&results[i], reference, tolerance_pct)) {
+        fprintf(stderr, "REGRESSION: %s leds=%u digits=%u %lu ns (baseline %lu ns, +%lu%%)\n", results[i].name,
+                results[i].leds, results[i].digits, (unsigned long)results[i].ns_per_op,
+                (unsigned long)reference->ns_per_op,
+                (unsigned long)((results[i].ns_per_op - reference->ns_per_op) * 100ULL / reference->ns_per_op));
+        regressions++;
+      }
+    }
+    fprintf(stderr, "%zu cases, %d slower than the baseline by more than %lu%%\n", count, regressions,
+            (unsigned long)tolerance_pct);
+  }
+  return regressions == 0 ? 0 : 1;
+}
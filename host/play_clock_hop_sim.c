@@ -0,0 +1,219 @@
+// Host channel hopping simulator: a controller and a clock on a simulated
+// nRF24 link, running the channel_hop.h logic on both ends, with interference
+// injected on a schedule. Frames go through the radio_protocol.h encoder and
+// parser, so hop announcements travel the way they do over the air.
+//
+//   play_clock_hop_sim          -> built-in scenario, events and a summary
+//   play_clock_hop_sim -v       -> also one status line per second
+//   play_clock_hop_sim -s 7     -> another random seed
+// Exits 1 if the clock lost the controller for longer than SIM_MAX_GAP_MS,
+// ends up on another channel, or missed a move whose announcement it ACKed.
+
+#include "../include/channel_hop.h"
+#include "../include/radio_protocol.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SIM_DURATION_MS 60000
+#define SIM_TICK_MS 10
+#define SIM_FRAME_MS 100         // Controller frame rate, 10 Hz
+#define SIM_SURVEY_MS 1000       // Controller sweep interval
+#define SIM_CLOCK_SWEEPS 4       // Same as RADIO_SURVEY_SWEEPS
+#define SIM_START_CHANNEL 76
+#define SIM_MAX_GAP_MS 7000      // Blocked clock (2.5 s), the silence before a search, and the search
+
+static const uint8_t hop_channels[] = {76, 80, 74, 83, 50, 25}; // Same as RADIO_HOP_CHANNELS
+
+// Busy share of a channel range over a time span. clock_only sources are only
+// seen at the clock (e.g. someone standing in front of it).
+typedef struct {
+  const char *name;
+  uint8_t first, last;
+  uint8_t busy_percent;
+  uint32_t start_ms, end_ms;
+  bool clock_only;
+} interference_t;
+
+static const interference_t scenario[] = {
+  {"Wi-Fi channel 1", 1, 23, 30, 0, SIM_DURATION_MS, false},
+  {"Wi-Fi channel 6", 26, 48, 50, 0, SIM_DURATION_MS, false},
+  {"Wi-Fi channel 13 access point", 61, 83, 70, 10000, SIM_DURATION_MS, false},
+  {"Clock blocked", 0, CHANNEL_SURVEY_CHANNELS - 1, 100, 30000, 32500, true},
+  {"Wireless mic", 48, 52, 80, 30500, SIM_DURATION_MS, false},
+};
+#define SCENARIO_COUNT (sizeof(scenario) / sizeof(scenario[0]))
+
+static uint32_t rng_state = 1;
+
+// xorshift32, percent 0..99
+static uint32_t random_percent(void) {
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 17;
+  rng_state ^= rng_state << 5;
+  return rng_state % 100;
+}
+
+// Chance a channel is busy at a place and time - independent sources combine
+static uint32_t busy_percent(uint8_t channel, uint32_t now_ms, bool at_clock) {
+  uint32_t clear = 100;
+  for (size_t i = 0; i < SCENARIO_COUNT; i++) {
+    const interference_t *source = &scenario[i];
+    if (channel < source->first || channel > source->last || now_ms < source->start_ms || now_ms >= source->end_ms)
+      continue;
+    if (source->clock_only && !at_clock)
+      continue;
+    clear = clear * (100 - source->busy_percent) / 100;
+  }
+  return 100 - clear;
+}
+
+static bool channel_busy(uint8_t channel, uint32_t now_ms, bool at_clock) {
+  return random_percent() < busy_percent(channel, now_ms, at_clock);
+}
+
+static void sweep(channel_survey_t *survey, uint32_t now_ms, bool at_clock) {
+  for (uint8_t channel = 0; channel < CHANNEL_SURVEY_CHANNELS; channel++) {
+    channel_survey_add(survey, channel, channel_busy(channel, now_ms, at_clock));
+  }
+  survey->sweeps++;
+}
+
+static int64_t us(uint32_t ms) {
+  return (int64_t)ms * 1000;
+}
+
+int main(int argc, char **argv) {
+  bool verbose = false;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-v") == 0) {
+      verbose = true;
+    } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+      rng_state = (uint32_t)strtoul(argv[++i], NULL, 0);
+      if (rng_state == 0)
+        rng_state = 1;
+    } else {
+      fprintf(stderr, "usage: %s [-v] [-s seed]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  for (size_t i = 0; i < SCENARIO_COUNT; i++) {
+    printf("%6.1f s  interference: %s, channels %d-%d, %d%% busy%s\n", scenario[i].start_ms / 1000.0,
+           scenario[i].name, scenario[i].first, scenario[i].last, scenario[i].busy_percent,
+           scenario[i].clock_only ? " (at the clock)" : "");
+  }
+
+  channel_survey_t controller_survey, clock_survey;
+  channel_survey_reset(&controller_survey);
+  channel_survey_reset(&clock_survey);
+  channel_hop_tx_t controller;
+  channel_hop_rx_t clock;
+  channel_hop_tx_init(&controller, hop_channels, sizeof(hop_channels), SIM_START_CHANNEL, 0);
+  channel_hop_rx_init(&clock, hop_channels, sizeof(hop_channels), SIM_START_CHANNEL, 0);
+
+  uint8_t sequence = 0;
+  uint32_t sent = 0, received = 0;
+  uint32_t last_rx_ms = 0, longest_gap_ms = 0;
+  uint32_t second_sent = 0, second_received = 0;
+  uint8_t shown_tx_channel = SIM_START_CHANNEL, shown_rx_channel = SIM_START_CHANNEL;
+  bool was_searching = false;
+
+  for (uint32_t now_ms = 0; now_ms < SIM_DURATION_MS; now_ms += SIM_TICK_MS) {
+    if (now_ms % SIM_SURVEY_MS == 0) {
+      sweep(&controller_survey, now_ms, false);
+    }
+
+    // Clock: follow announcements, search after a silence
+    channel_hop_rx_poll(&clock, us(now_ms), NULL);
+    if (clock.survey_due) {
+      for (int i = 0; i < SIM_CLOCK_SWEEPS; i++) {
+        sweep(&clock_survey, now_ms, true);
+      }
+      channel_hop_rx_rank(&clock, &clock_survey);
+      channel_hop_rx_poll(&clock, us(now_ms), NULL);
+    }
+    if (clock.searching && !was_searching) {
+      printf("%6.1f s  clock: no frames for %d ms, searching\n", now_ms / 1000.0, CHANNEL_HOP_SEARCH_AFTER_MS);
+    }
+    was_searching = clock.searching;
+    if (clock.channel != shown_rx_channel) {
+      if (!clock.searching) {
+        printf("%6.1f s  clock: moved to channel %d\n", now_ms / 1000.0, clock.channel);
+      }
+      shown_rx_channel = clock.channel;
+    }
+
+    if (now_ms % SIM_FRAME_MS != 0)
+      continue;
+
+    // Controller: one frame, through the protocol encoder
+    radio_message_t message;
+    memset(&message, 0, sizeof(message));
+    message.sequence = sequence++;
+    message.fields = RADIO_FIELD(RADIO_RECORD_PLAY_CLOCK);
+    message.play_clock = (radio_clock_t){(uint16_t)(400 - now_ms / 100 % 400), RADIO_CLOCK_RUNNING};
+    bool was_announcing = controller.announcing;
+    uint8_t channel = channel_hop_tx_prepare(&controller, &message, us(now_ms));
+    if (channel != shown_tx_channel) {
+      printf("%6.1f s  controller: moved to channel %d\n", now_ms / 1000.0, channel);
+      shown_tx_channel = channel;
+    }
+    uint8_t payload[RADIO_PROTOCOL_MAX_FRAME];
+    size_t length = radio_protocol_encode(&message, payload, sizeof(payload));
+    sent++;
+    second_sent++;
+
+    // Delivered when neither end hears interference on the channel; the ACK
+    // comes back the same way
+    bool heard = clock.channel == channel && !channel_busy(channel, now_ms, false) &&
+                 !channel_busy(channel, now_ms, true);
+    radio_message_t parsed;
+    if (heard && radio_protocol_parse(payload, length, &parsed)) {
+      channel_hop_rx_on_message(&clock, &parsed, us(now_ms));
+      if (now_ms - last_rx_ms > longest_gap_ms)
+        longest_gap_ms = now_ms - last_rx_ms;
+      last_rx_ms = now_ms;
+      received++;
+      second_received++;
+    }
+    channel_hop_tx_on_frame(&controller, heard, &controller_survey, us(now_ms));
+    if (controller.announcing && !was_announcing) {
+      printf("%6.1f s  controller: %lu%% loss on channel %d, announcing channel %d\n", now_ms / 1000.0,
+             (unsigned long)controller.stats.loss_percent, channel, controller.hop_channel);
+    }
+
+    if (verbose && (now_ms + SIM_FRAME_MS) % 1000 == 0) {
+      printf("%6.1f s  controller ch %3d loss %3lu%%, clock ch %3d%s, %2lu/%lu frames heard\n",
+             now_ms / 1000.0, controller.channel, (unsigned long)controller.stats.loss_percent, clock.channel,
+             clock.searching ? " searching" : "", (unsigned long)second_received, (unsigned long)second_sent);
+      second_sent = 0;
+      second_received = 0;
+    }
+  }
+  if (SIM_DURATION_MS - last_rx_ms > longest_gap_ms)
+    longest_gap_ms = SIM_DURATION_MS - last_rx_ms;
+
+  char map[CHANNEL_SURVEY_CHANNELS + 1];
+  channel_survey_format(&controller_survey, map);
+  printf("\nController survey: %s\n", map);
+  printf("Frames: %lu sent, %lu heard (%lu%%), longest gap %lu ms\n", (unsigned long)sent,
+         (unsigned long)received, (unsigned long)(received * 100 / sent), (unsigned long)longest_gap_ms);
+  printf("Controller: channel %d, %lu hops (%lu unconfirmed), %lu announcing frames\n", controller.channel,
+         (unsigned long)controller.stats.hops, (unsigned long)controller.stats.unconfirmed,
+         (unsigned long)controller.stats.announcements);
+  printf("Clock: channel %d, %lu hops followed, %lu announcements heard, %lu searches (%lu channels tried)\n",
+         clock.channel, (unsigned long)clock.stats.hops, (unsigned long)clock.stats.announcements,
+         (unsigned long)clock.stats.searches, (unsigned long)clock.stats.search_steps);
+
+  // ACKs here are never lost, so every confirmed move must have been followed
+  uint32_t confirmed_hops = controller.stats.hops - controller.stats.unconfirmed;
+  if (clock.stats.hops < confirmed_hops) {
+    printf("Clock followed %lu of %lu confirmed hops\n", (unsigned long)clock.stats.hops,
+           (unsigned long)confirmed_hops);
+  }
+  bool ok = clock.channel == controller.channel && longest_gap_ms <= SIM_MAX_GAP_MS &&
+            clock.stats.hops >= confirmed_hops;
+  printf("%s\n", ok ? "OK" : "FAILED");
+  return ok ? 0 : 1;
+}
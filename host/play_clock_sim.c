@@ -0,0 +1,185 @@
+// Host simulator: decodes radio payloads and renders them through the same
+// layout, glyph and color pipeline code as the firmware, then draws the
+// resulting framebuffer as ASCII 7-segment digits.
+//
+//   play_clock_sim [-b brightness] [-g] PAYLOAD_HEX...
+//   play_clock_sim C1070103012C010403FFA500 ->  v1: play clock 30.0 s running, RGB(255,165,0), seq 7
+//   play_clock_sim 001EFFA50007             ->  legacy: seconds 30, RGB(255,165,0), seq 7
+//   play_clock_sim -g C10702031770010403FFA500 -> game clock 10:00 running on a 4-digit MM:SS layout
+
+#include "../include/display_layout.h"
+#include "../include/display_render.h"
+#include "../include/radio_protocol.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SIM_LED_COUNT (LAYOUT_MAX_DIGITS * LEDS_PER_DIGIT + 64)
+#define SIM_MAX_PAYLOAD 32
+#define SIM_COLON_LEDS 16
+
+static uint8_t framebuffer[SIM_LED_COUNT * 3];
+static compiled_layout_t layout;
+static color_lut_t color_lut;
+static wire_map_t wire_map;
+static bool game_clock; // -g: MM:SS game clock instead of the play clock
+
+// Built-in wiring, digits back to back on one chain. The game clock layout has
+// four digits and a colon after the minutes.
+static const char *build_layout(void) {
+  const uint8_t digit_outputs[4] = {0, 0, 0, 0};
+  const uint16_t play_bases[2] = {0, LEDS_PER_DIGIT};
+  const uint16_t game_bases[4] = {0, LEDS_PER_DIGIT, 2 * LEDS_PER_DIGIT + SIM_COLON_LEDS,
+                                  3 * LEDS_PER_DIGIT + SIM_COLON_LEDS};
+  const layout_output_t output = {0, SIM_LED_COUNT};
+  display_layout_t source;
+
+  if (game_clock) {
+    display_layout_default(&source, 4, digit_outputs, game_bases);
+    source.indicators[LAYOUT_SEPARATOR] = (layout_indicator_t){0, 2 * LEDS_PER_DIGIT, SIM_COLON_LEDS};
+    source.indicator_count = 1;
+  } else {
+    display_layout_default(&source, 2, digit_outputs, play_bases);
+  }
+  return display_layout_compile(&source, &output, 1, &layout);
+}
+
+static bool parse_hex(const char *text, uint8_t *out, size_t *length) {
+  size_t digits = strlen(text);
+  if (digits % 2 != 0 || digits / 2 > SIM_MAX_PAYLOAD)
+    return false;
+
+  for (size_t i = 0; i < digits / 2; i++) {
+    unsigned int byte;
+    if (sscanf(&text[i * 2], "%2x", &byte) != 1)
+      return false;
+    out[i] = (uint8_t)byte;
+  }
+  *length = digits / 2;
+  return true;
+}
+
+// Seconds of the simulated clock, -1 when blank
+static int32_t shown_seconds(const radio_message_t *message) {
+  if (!game_clock)
+    return message->seconds == RADIO_PROTOCOL_BLANK_SECONDS ? -1 : message->seconds;
+  if (!(message->fields & RADIO_FIELD(RADIO_RECORD_GAME_CLOCK)) || (message->game_clock.flags & RADIO_CLOCK_BLANK))
+    return -1;
+  return (message->game_clock.tenths + 9) / 10;
+}
+
+// Same steps as display_set_time(): format the value, then fill each digit's
+// glyph spans and the separator
+static uint64_t render_message(const radio_message_t *message, uint8_t rgb[3]) {
+  uint8_t off[3] = {0, 0, 0};
+  render_fill(framebuffer, SIM_LED_COUNT, 0, SIM_LED_COUNT, off, NULL);
+  int32_t seconds = shown_seconds(message);
+  if (seconds < 0)
+    return 0;
+
+  uint8_t digits[LAYOUT_MAX_DIGITS];
+  bool separator = render_format_value(game_clock ? RENDER_FORMAT_MMSS : RENDER_FORMAT_PLAIN, (uint32_t)seconds,
+                                       game_clock, digits, layout.digit_count);
+
+  rgb[0] = message->r;
+  rgb[1] = message->g;
+  rgb[2] = message->b;
+  for (int digit = 0; digit < layout.digit_count; digit++) {
+    size_t span_count;
+    const segment_range_t *spans = layout_glyph_spans(&layout, digit, digits[digit], &span_count);
+    render_fill_spans(framebuffer, spans, span_count, rgb, NULL);
+  }
+  if (separator && layout.indicator_count > LAYOUT_SEPARATOR) {
+    render_fill_spans(framebuffer, &layout.indicators[LAYOUT_SEPARATOR], 1, rgb, NULL);
+  }
+  return render_segment_mask(digits, layout.digit_count);
+}
+
+// A run is drawn when every one of its LEDs is lit in the framebuffer
+static bool range_lit(segment_range_t range) {
+  for (uint16_t led = range.start; led < range.start + range.count; led++) {
+    const uint8_t *pixel = &framebuffer[led * 3];
+    if (pixel[0] == 0 && pixel[1] == 0 && pixel[2] == 0)
+      return false;
+  }
+  return range.count > 0;
+}
+
+static bool segment_lit(int digit, segment_t segment) {
+  return range_lit(layout.segments[digit][segment]);
+}
+
+static void draw_framebuffer(void) {
+  for (int row = 0; row < 3; row++) {
+    for (int digit = 0; digit < layout.digit_count; digit++) {
+      if (digit == 2 && layout.indicator_count > LAYOUT_SEPARATOR) {
+        printf("%c ", row > 0 && range_lit(layout.indicators[LAYOUT_SEPARATOR]) ? ':' : ' ');
+      }
+      if (row == 0) {
+        printf(" %c  ", segment_lit(digit, SEGMENT_A) ? '_' : ' ');
+      } else {
+        segment_t left = row == 1 ? SEGMENT_F : SEGMENT_E;
+        segment_t middle = row == 1 ? SEGMENT_G : SEGMENT_D;
+        segment_t right = row == 1 ? SEGMENT_B : SEGMENT_C;
+        printf("%c%c%c ", segment_lit(digit, left) ? '|' : ' ', segment_lit(digit, middle) ? '_' : ' ',
+               segment_lit(digit, right) ? '|' : ' ');
+      }
+    }
+    printf("\n");
+  }
+}
+
+int main(int argc, char **argv) {
+  uint8_t brightness = 255;
+  int first_payload = 1;
+  while (first_payload < argc && argv[first_payload][0] == '-') {
+    if (strcmp(argv[first_payload], "-b") == 0 && first_payload + 1 < argc) {
+      brightness = (uint8_t)atoi(argv[first_payload + 1]);
+      first_payload += 2;
+    } else if (strcmp(argv[first_payload], "-g") == 0) {
+      game_clock = true;
+      first_payload++;
+    } else {
+      break;
+    }
+  }
+  if (first_payload >= argc) {
+    fprintf(stderr, "usage: %s [-b brightness] [-g] PAYLOAD_HEX...\n", argv[0]);
+    return 2;
+  }
+
+  const char *error = build_layout();
+  if (error != NULL) {
+    fprintf(stderr, "layout: %s\n", error);
+    return 2;
+  }
+  display_calibration_t calibration = {
+    .color_gamma = DISPLAY_DEFAULT_COLOR_GAMMA,
+    .brightness_gamma = DISPLAY_DEFAULT_BRIGHTNESS_GAMMA,
+    .white_balance = {255, 255, 255},
+  };
+  color_lut_build(&color_lut, &calibration, brightness);
+  wire_map_build(&wire_map, &color_lut, COLOR_ORDER_RGB, WIRE_MAP_SCALE_FULL);
+
+  int failures = 0;
+  for (int i = first_payload; i < argc; i++) {
+    uint8_t payload[SIM_MAX_PAYLOAD];
+    size_t length = 0;
+    radio_message_t message;
+    if (!parse_hex(argv[i], payload, &length) || !radio_protocol_parse(payload, length, &message)) {
+      printf("%s: rejected\n", argv[i]);
+      failures++;
+      continue;
+    }
+
+    uint8_t rgb[3] = {0, 0, 0};
+    uint64_t mask = render_message(&message, rgb);
+    uint8_t wire[3];
+    wire_map_pixel(&wire_map, rgb, wire);
+    printf("%s: v%d seconds=%ld RGB(%d,%d,%d) seq=%d fields=0x%04X mask=0x%04llX wire=%02X%02X%02X\n", argv[i],
+           message.version, (long)shown_seconds(&message), message.r, message.g, message.b, message.sequence,
+           message.fields, (unsigned long long)mask, wire[0], wire[1], wire[2]);
+    draw_framebuffer();
+  }
+  return failures == 0 ? 0 : 1;
+}
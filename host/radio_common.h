@@ -0,0 +1,60 @@
+#pragma once
+
+#include "driver/gpio.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Host stand-in for the out-of-tree radio_common component: the part of its
+// interface radio_comm.c uses, backed by an emulated nRF24L01+
+// (radio_common_linux.c) instead of an SPI device
+
+typedef struct {
+  bool initialized;
+  gpio_num_t ce_pin;
+  gpio_num_t csn_pin;
+} RadioCommon;
+
+#define RADIO_PAYLOAD_SIZE 32
+
+#define NRF24_REG_CONFIG 0x00
+#define NRF24_REG_EN_AA 0x01
+#define NRF24_REG_SETUP_RETR 0x04
+#define NRF24_REG_RF_CH 0x05
+#define NRF24_REG_RF_SETUP 0x06
+#define NRF24_REG_STATUS 0x07
+#define NRF24_REG_RPD 0x09
+#define NRF24_REG_FIFO_STATUS 0x17
+
+#define NRF24_STATUS_RX_DR 0x40
+#define NRF24_STATUS_TX_DS 0x20
+#define NRF24_STATUS_MAX_RT 0x10
+
+#define RADIO_CONFIG_RX_MODE 0x0F   // PWR_UP, PRIM_RX, CRC on (2 bytes), all interrupts unmasked
+#define RADIO_STATUS_CLEAR_ALL 0x70 // RX_DR | TX_DS | MAX_RT
+
+bool radio_common_init(RadioCommon *radio, gpio_num_t ce_pin, gpio_num_t csn_pin);
+bool radio_common_configure(RadioCommon *radio);
+void radio_common_dump_registers(RadioCommon *radio);
+
+uint8_t nrf24_read_register(RadioCommon *radio, uint8_t reg);
+bool nrf24_write_register(RadioCommon *radio, uint8_t reg, uint8_t value);
+bool nrf24_read_payload(RadioCommon *radio, uint8_t *data, uint8_t length);
+uint8_t nrf24_get_status(RadioCommon *radio);
+void nrf24_flush_rx(RadioCommon *radio);
+
+// Controls for the emulation
+
+// A payload arriving over the air on pipe 0, zero-padded to RADIO_PAYLOAD_SIZE.
+// Sets RX_DR; false if the 3-deep RX FIFO was full and it was lost.
+bool radio_common_linux_receive(const uint8_t *payload, size_t length);
+
+// Drive the chip's IRQ output on this pin (platform_linux_set_input()): low
+// while an unmasked STATUS flag is set
+void radio_common_linux_set_irq_pin(int pin);
+
+// SPI transactions (register, payload and command accesses) so far
+uint32_t radio_common_linux_transactions(void);
+
+// Payloads waiting in the RX FIFO
+size_t radio_common_linux_rx_pending(void);
@@ -0,0 +1,139 @@
+#include "radio_common.h"
+#include "platform_linux.h"
+#include <string.h>
+
+// Register-level emulation of an nRF24L01+ listening on pipe 0
+
+#define RX_FIFO_DEPTH 3
+#define REGISTER_COUNT 0x20
+
+#define STATUS_FLAGS (NRF24_STATUS_RX_DR | NRF24_STATUS_TX_DS | NRF24_STATUS_MAX_RT)
+#define STATUS_RX_P_NO_EMPTY 0x0E // RX_P_NO = 111
+#define FIFO_STATUS_RX_EMPTY 0x01
+#define FIFO_STATUS_RX_FULL 0x02
+
+static uint8_t registers[REGISTER_COUNT];
+static uint8_t rx_fifo[RX_FIFO_DEPTH][RADIO_PAYLOAD_SIZE];
+static size_t rx_count = 0;
+static int irq_pin = -1;
+static uint32_t transactions = 0;
+
+static uint8_t status_register(void) {
+  return (registers[NRF24_REG_STATUS] & STATUS_FLAGS) | (rx_count == 0 ? STATUS_RX_P_NO_EMPTY : 0);
+}
+
+// IRQ is active low; CONFIG bits 6..4 mask the flags with the same positions in STATUS
+static void update_irq(void) {
+  if (irq_pin < 0)
+    return;
+  bool active = (registers[NRF24_REG_STATUS] & STATUS_FLAGS & ~registers[NRF24_REG_CONFIG]) != 0;
+  platform_linux_set_input(irq_pin, active ? 0 : 1);
+}
+
+bool radio_common_init(RadioCommon *radio, gpio_num_t ce_pin, gpio_num_t csn_pin) {
+  // Power-on reset values
+  memset(registers, 0, sizeof(registers));
+  registers[NRF24_REG_CONFIG] = 0x08;
+  registers[NRF24_REG_EN_AA] = 0x3F;
+  registers[NRF24_REG_SETUP_RETR] = 0x03;
+  registers[NRF24_REG_RF_CH] = 0x02;
+  registers[NRF24_REG_RF_SETUP] = 0x0E;
+  rx_count = 0;
+  transactions = 0;
+
+  radio->ce_pin = ce_pin;
+  radio->csn_pin = csn_pin;
+  platform_gpio_config(ce_pin, PLATFORM_GPIO_OUTPUT);
+  platform_gpio_config(csn_pin, PLATFORM_GPIO_OUTPUT);
+  platform_gpio_set(csn_pin, 1);
+  radio->initialized = true;
+  return true;
+}
+
+bool radio_common_configure(RadioCommon *radio) {
+  return nrf24_write_register(radio, NRF24_REG_CONFIG, RADIO_CONFIG_RX_MODE);
+}
+
+void radio_common_dump_registers(RadioCommon *radio) {
+  (void)radio;
+}
+
+uint8_t nrf24_read_register(RadioCommon *radio, uint8_t reg) {
+  (void)radio;
+  transactions++;
+  if (reg == NRF24_REG_STATUS)
+    return status_register();
+  if (reg == NRF24_REG_FIFO_STATUS)
+    return (rx_count == 0 ? FIFO_STATUS_RX_EMPTY : 0) | (rx_count == RX_FIFO_DEPTH ? FIFO_STATUS_RX_FULL : 0);
+  return reg < REGISTER_COUNT ? registers[reg] : 0;
+}
+
+bool nrf24_write_register(RadioCommon *radio, uint8_t reg, uint8_t value) {
+  (void)radio;
+  transactions++;
+  if (reg >= REGISTER_COUNT)
+    return false;
+
+  if (reg == NRF24_REG_STATUS) {
+    // Flags are cleared by writing 1
+    registers[reg] &= ~(value & STATUS_FLAGS);
+  } else {
+    registers[reg] = value;
+  }
+  update_irq();
+  return true;
+}
+
+// Reads the oldest payload; an empty FIFO reads as zeros
+bool nrf24_read_payload(RadioCommon *radio, uint8_t *data, uint8_t length) {
+  (void)radio;
+  transactions++;
+  size_t size = length < RADIO_PAYLOAD_SIZE ? length : RADIO_PAYLOAD_SIZE;
+  if (rx_count == 0) {
+    memset(data, 0, size);
+    return true;
+  }
+
+  memcpy(data, rx_fifo[0], size);
+  memmove(rx_fifo[0], rx_fifo[1], (RX_FIFO_DEPTH - 1) * RADIO_PAYLOAD_SIZE);
+  rx_count--;
+  return true;
+}
+
+uint8_t nrf24_get_status(RadioCommon *radio) {
+  (void)radio;
+  transactions++;
+  return status_register();
+}
+
+void nrf24_flush_rx(RadioCommon *radio) {
+  (void)radio;
+  transactions++;
+  rx_count = 0;
+}
+
+bool radio_common_linux_receive(const uint8_t *payload, size_t length) {
+  if (rx_count == RX_FIFO_DEPTH)
+    return false;
+
+  size_t size = length < RADIO_PAYLOAD_SIZE ? length : RADIO_PAYLOAD_SIZE;
+  memset(rx_fifo[rx_count], 0, RADIO_PAYLOAD_SIZE);
+  memcpy(rx_fifo[rx_count], payload, size);
+  rx_count++;
+  registers[NRF24_REG_STATUS] |= NRF24_STATUS_RX_DR;
+  update_irq();
+  return true;
+}
+
+void radio_common_linux_set_irq_pin(int pin) {
+  irq_pin = pin;
+  update_irq();
+}
+
+uint32_t radio_common_linux_transactions(void) {
+  return transactions;
+}
+
+size_t radio_common_linux_rx_pending(void) {
+  return rx_count;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stdio.h>
+#include <string.h>
+
+// Minimal assertions for the host unit tests. A failed check prints where it
+// is and the test carries on; TEST_RESULT() is the exit status for ctest.
+
+static int test_checks = 0;
+static int test_failures = 0;
+
+#define CHECK(condition)                                                                     \
+  do {                                                                                       \
+    test_checks++;                                                                           \
+    if (!(condition)) {                                                                      \
+      test_failures++;                                                                       \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition);          \
+    }                                                                                        \
+  } while (0)
+
+#define CHECK_EQ(actual, expected)                                                           \
+  do {                                                                                       \
+    long long actual_value = (long long)(actual);                                            \
+    long long expected_value = (long long)(expected);                                        \
+    test_checks++;                                                                           \
+    if (actual_value != expected_value) {                                                    \
+      test_failures++;                                                                       \
+      fprintf(stderr, "%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual,     \
+              actual_value, expected_value);                                                 \
+    }                                                                                        \
+  } while (0)
+
+#define CHECK_STR(actual, expected)                                                          \
+  do {                                                                                       \
+    const char *actual_value = (actual);                                                     \
+    const char *expected_value = (expected);                                                 \
+    test_checks++;                                                                           \
+    if (actual_value == NULL || expected_value == NULL ? actual_value != expected_value      \
+                                                       : strcmp(actual_value, expected_value) != 0) { \
+      test_failures++;                                                                       \
+      fprintf(stderr, "%s:%d: %s is \"%s\", expected \"%s\"\n", __FILE__, __LINE__, #actual, \
+              actual_value ? actual_value : "(null)", expected_value ? expected_value : "(null)"); \
+    }                                                                                        \
+  } while (0)
+
+#define RUN_TEST(test)                                                                       \
+  do {                                                                                       \
+    int failures_before = test_failures;                                                     \
+    test();                                                                                  \
+    printf("%-40s %s\n", #test, test_failures == failures_before ? "ok" : "FAILED");        \
+  } while (0)
+
+#define TEST_RESULT()                                                                        \
+  (printf("%d checks, %d failed\n", test_checks, test_failures), test_failures == 0 ? 0 : 1)
@@ -0,0 +1,230 @@
+// channel_hop.h: channel survey, announced moves and the clock's search
+
+#include "../../include/channel_hop.h"
+#include "test.h"
+
+static const uint8_t hop_set[] = {76, 80, 74, 83, 50, 25};
+#define START_CHANNEL 76
+#define FRAME_US 100000
+
+static int64_t ms(int64_t value) {
+  return value * 1000;
+}
+
+// Channel 76 always busy, everything else clear
+static void busy_start_channel(channel_survey_t *survey) {
+  channel_survey_reset(survey);
+  for (int channel = 0; channel < CHANNEL_SURVEY_CHANNELS; channel++) {
+    channel_survey_add(survey, channel, channel == START_CHANNEL);
+  }
+}
+
+static void test_survey(void) {
+  channel_survey_t survey;
+  channel_survey_reset(&survey);
+  CHECK_EQ(channel_survey_occupancy(&survey, 10), 0);
+
+  // The first reading sets the average, later ones move it a quarter of the way
+  channel_survey_add(&survey, 10, true);
+  CHECK_EQ(channel_survey_occupancy(&survey, 10), 100);
+  channel_survey_add(&survey, 10, false);
+  CHECK_EQ(channel_survey_occupancy(&survey, 10), 75);
+  channel_survey_add(&survey, CHANNEL_SURVEY_CHANNELS, true); // Ignored
+
+  // Neighbours count half
+  CHECK_EQ(channel_survey_score(&survey, 10), 150);
+  CHECK_EQ(channel_survey_score(&survey, 11), 75);
+  CHECK_EQ(channel_survey_score(&survey, 12), 0);
+
+  const uint8_t set[] = {10, 11, 12, 13};
+  CHECK_EQ(channel_survey_best(&survey, set, 4, 13), 12);
+  CHECK_EQ(channel_survey_best(&survey, set, 4, 12), 13);
+
+  char map[CHANNEL_SURVEY_CHANNELS + 1];
+  channel_survey_format(&survey, map);
+  CHECK_EQ(map[9], '.');
+  CHECK_EQ(map[10], '8');
+  CHECK_EQ(map[CHANNEL_SURVEY_CHANNELS], '\0');
+}
+
+static void test_clock_follows_announcement(void) {
+  channel_hop_rx_t rx;
+  channel_hop_rx_init(&rx, hop_set, sizeof(hop_set), START_CHANNEL, 0);
+
+  radio_message_t message = {0};
+  message.fields = RADIO_FIELD(RADIO_RECORD_HOP);
+  message.hop_channel = 50;
+  message.hop_delay_ms = 600;
+  channel_hop_rx_on_message(&rx, &message, ms(1000));
+
+  // A later announcement restates the same move time
+  message.hop_delay_ms = 400;
+  channel_hop_rx_on_message(&rx, &message, ms(1200));
+  int64_t next_us;
+  CHECK_EQ(channel_hop_rx_poll(&rx, ms(1500), &next_us), START_CHANNEL);
+  CHECK_EQ(next_us, ms(1600));
+  CHECK_EQ(channel_hop_rx_poll(&rx, ms(1600), &next_us), 50);
+  CHECK_EQ(rx.stats.hops, 1);
+  CHECK_EQ(rx.stats.announcements, 2);
+
+  // The new channel gets a full silence before a search
+  CHECK_EQ(next_us, ms(1600 + CHANNEL_HOP_SEARCH_AFTER_MS));
+  CHECK(!rx.searching);
+
+  // Announcing the tuned channel is no move
+  message.hop_channel = 50;
+  channel_hop_rx_on_message(&rx, &message, ms(1700));
+  CHECK(!rx.hop_pending);
+}
+
+static void test_clock_searches_after_silence(void) {
+  channel_hop_rx_t rx;
+  channel_hop_rx_init(&rx, hop_set, sizeof(hop_set), START_CHANNEL, 0);
+  CHECK_EQ(channel_hop_rx_poll(&rx, ms(CHANNEL_HOP_SEARCH_AFTER_MS - 10), NULL), START_CHANNEL);
+
+  // Silence: ranked by the clock's survey, then cleanest first, skipping the channel just left
+  channel_hop_rx_poll(&rx, ms(CHANNEL_HOP_SEARCH_AFTER_MS), NULL);
+  CHECK(rx.searching);
+  CHECK(rx.survey_due);
+  CHECK_EQ(rx.stats.searches, 1);
+  channel_survey_t survey;
+  busy_start_channel(&survey);
+  channel_hop_rx_rank(&rx, &survey);
+  CHECK(!rx.survey_due);
+  CHECK_EQ(rx.channels[sizeof(hop_set) - 1], START_CHANNEL);
+
+  int64_t now = ms(CHANNEL_HOP_SEARCH_AFTER_MS);
+  CHECK_EQ(channel_hop_rx_poll(&rx, now, NULL), 80);
+  CHECK_EQ(channel_hop_rx_poll(&rx, now + ms(CHANNEL_HOP_DWELL_MS) - 1, NULL), 80);
+  now += ms(CHANNEL_HOP_DWELL_MS);
+  CHECK_EQ(channel_hop_rx_poll(&rx, now, NULL), 74);
+
+  // A frame ends the search
+  radio_message_t message = {0};
+  channel_hop_rx_on_message(&rx, &message, now + 1000);
+  CHECK(!rx.searching);
+  CHECK_EQ(channel_hop_rx_poll(&rx, now + ms(CHANNEL_HOP_DWELL_MS), NULL), 74);
+}
+
+// One controller frame: prepare, then its outcome
+static uint8_t send(channel_hop_tx_t *tx, const channel_survey_t *survey, bool acked, int64_t now_us,
+                    radio_message_t *message) {
+  memset(message, 0, sizeof(*message));
+  uint8_t channel = channel_hop_tx_prepare(tx, message, now_us);
+  channel_hop_tx_on_frame(tx, acked, survey, now_us);
+  return channel;
+}
+
+static void test_controller_waits_for_a_clean_channel(void) {
+  channel_survey_t survey;
+  channel_survey_reset(&survey);
+  channel_hop_tx_t tx;
+  channel_hop_tx_init(&tx, hop_set, sizeof(hop_set), START_CHANNEL, 0);
+  radio_message_t message;
+
+  // Heavy loss but nothing cleaner in the survey: stays
+  int64_t now = 0;
+  for (int i = 0; i < CHANNEL_HOP_WINDOW_FRAMES; i++, now += FRAME_US) {
+    send(&tx, &survey, false, now, &message);
+  }
+  CHECK_EQ(tx.stats.loss_percent, 100);
+  CHECK(!tx.announcing);
+
+  // Loss under the threshold, spread out: no move either
+  busy_start_channel(&survey);
+  channel_hop_tx_init(&tx, hop_set, sizeof(hop_set), START_CHANNEL, 0);
+  for (int i = 0; i < CHANNEL_HOP_WINDOW_FRAMES; i++, now += FRAME_US) {
+    send(&tx, &survey, i % 5 != 0, now, &message);
+  }
+  CHECK(!tx.announcing);
+}
+
+static void test_controller_announces_until_acked(void) {
+  channel_survey_t survey;
+  busy_start_channel(&survey);
+  channel_hop_tx_t tx;
+  channel_hop_tx_init(&tx, hop_set, sizeof(hop_set), START_CHANNEL, 0);
+  radio_message_t message;
+
+  int64_t now = 0;
+  for (int i = 0; i < CHANNEL_HOP_MIN_FRAMES; i++, now += FRAME_US) {
+    send(&tx, &survey, true, now, &message);
+  }
+
+  // A burst of losses announces at once, the clearest channel out of Wi-Fi reach
+  for (int i = 0; i < CHANNEL_HOP_BURST_FRAMES; i++, now += FRAME_US) {
+    CHECK(!tx.announcing);
+    send(&tx, &survey, false, now, &message);
+  }
+  CHECK(tx.announcing);
+  CHECK_EQ(tx.hop_channel, 50);
+
+  // Unheard, every frame restates the full delay
+  for (int i = 0; i < 5; i++, now += FRAME_US) {
+    CHECK_EQ(send(&tx, &survey, false, now, &message), START_CHANNEL);
+    CHECK(message.fields & RADIO_FIELD(RADIO_RECORD_HOP));
+    CHECK_EQ(message.hop_channel, 50);
+    CHECK_EQ(message.hop_delay_ms, CHANNEL_HOP_ANNOUNCE_MS);
+  }
+
+  // The clock ACKs one: the move time is fixed and counted down
+  int64_t acked_at = now;
+  send(&tx, &survey, true, now, &message);
+  CHECK(tx.confirmed);
+  now += FRAME_US;
+  send(&tx, &survey, false, now, &message);
+  CHECK_EQ(message.hop_delay_ms, CHANNEL_HOP_ANNOUNCE_MS - FRAME_US / 1000);
+
+  while (now < acked_at + ms(CHANNEL_HOP_ANNOUNCE_MS) - FRAME_US) {
+    now += FRAME_US;
+    CHECK_EQ(send(&tx, &survey, false, now, &message), START_CHANNEL);
+  }
+  now += FRAME_US;
+  CHECK_EQ(send(&tx, &survey, true, now, &message), 50);
+  CHECK(!(message.fields & RADIO_FIELD(RADIO_RECORD_HOP)));
+  CHECK(!tx.announcing);
+  CHECK_EQ(tx.stats.hops, 1);
+  CHECK_EQ(tx.stats.unconfirmed, 0);
+
+  // Held off after a move, whatever the loss
+  for (int i = 0; i < CHANNEL_HOP_WINDOW_FRAMES; i++) {
+    now += FRAME_US;
+    send(&tx, &survey, false, now, &message);
+  }
+  CHECK(now < ms(CHANNEL_HOP_HOLDOFF_MS) + acked_at);
+  CHECK(!tx.announcing);
+}
+
+static void test_controller_moves_when_clock_searches(void) {
+  channel_survey_t survey;
+  busy_start_channel(&survey);
+  channel_hop_tx_t tx;
+  channel_hop_tx_init(&tx, hop_set, sizeof(hop_set), START_CHANNEL, 0);
+  radio_message_t message;
+
+  int64_t now = 0;
+  for (int i = 0; i < CHANNEL_HOP_MIN_FRAMES; i++, now += FRAME_US) {
+    send(&tx, &survey, true, now, &message);
+  }
+  int64_t last_ack = now - FRAME_US;
+
+  // Nothing ACKed for the clock's search silence: it is searching, move at once
+  while (now - last_ack < ms(CHANNEL_HOP_SEARCH_AFTER_MS)) {
+    CHECK_EQ(send(&tx, &survey, false, now, &message), START_CHANNEL);
+    now += FRAME_US;
+  }
+  CHECK(tx.announcing);
+  CHECK_EQ(send(&tx, &survey, false, now, &message), 50);
+  CHECK_EQ(tx.stats.hops, 1);
+  CHECK_EQ(tx.stats.unconfirmed, 1);
+}
+
+int main(void) {
+  RUN_TEST(test_survey);
+  RUN_TEST(test_clock_follows_announcement);
+  RUN_TEST(test_clock_searches_after_silence);
+  RUN_TEST(test_controller_waits_for_a_clean_channel);
+  RUN_TEST(test_controller_announces_until_acked);
+  RUN_TEST(test_controller_moves_when_clock_searches);
+  return TEST_RESULT();
+}
@@ -0,0 +1,157 @@
+// clock_engine.h: local countdown between packets
+
+#include "../../include/clock_engine.h"
+#include "test.h"
+#include <stdlib.h>
+
+#define MS 1000LL
+
+// Controller clock counting down from start_ms at rate (controller ms per
+// local ms), started at local time zero_us
+typedef struct {
+  int32_t start_ms;
+  int64_t zero_us;
+  double rate;
+} controller_t;
+
+static int32_t controller_remaining_ms(const controller_t *controller, int64_t now_us) {
+  double remaining = controller->start_ms - (now_us - controller->zero_us) / 1000.0 * controller->rate;
+  return remaining > 0 ? (int32_t)remaining : 0;
+}
+
+static uint16_t controller_seconds(const controller_t *controller, int64_t now_us) {
+  return (uint16_t)((controller_remaining_ms(controller, now_us) + 999) / 1000);
+}
+
+// Packets every period_us from from_us to to_us
+static void send(clock_engine_t *engine, const controller_t *controller, clock_run_state_t run_state,
+                 int64_t from_us, int64_t to_us, int64_t period_us) {
+  for (int64_t now_us = from_us; now_us < to_us; now_us += period_us) {
+    clock_engine_on_packet(engine, controller_seconds(controller, now_us), run_state, now_us);
+  }
+}
+
+static void test_blank_and_stopped(void) {
+  clock_engine_t engine;
+  clock_engine_init(&engine);
+  CHECK_EQ(clock_engine_seconds(&engine, 0), CLOCK_ENGINE_BLANK);
+  CHECK_EQ(clock_engine_us_to_next_flip(&engine, 0), -1);
+
+  clock_engine_on_packet(&engine, 24, CLOCK_RUN_STOPPED, 0);
+  CHECK_EQ(clock_engine_seconds(&engine, 5000 * MS), 24);
+  CHECK_EQ(clock_engine_us_to_next_flip(&engine, 0), -1);
+
+  clock_engine_on_packet(&engine, CLOCK_ENGINE_BLANK, CLOCK_RUN_STOPPED, 100 * MS);
+  CHECK_EQ(clock_engine_seconds(&engine, 200 * MS), CLOCK_ENGINE_BLANK);
+}
+
+static void test_free_runs_between_packets(void) {
+  clock_engine_t engine;
+  clock_engine_init(&engine);
+  clock_engine_on_packet(&engine, 30, CLOCK_RUN_RUNNING, 0);
+  CHECK_EQ(clock_engine_seconds(&engine, 0), 30);
+  CHECK_EQ(clock_engine_us_to_next_flip(&engine, 0), 1000 * MS);
+  CHECK_EQ(clock_engine_seconds(&engine, 999 * MS), 30);
+  CHECK_EQ(clock_engine_seconds(&engine, 1001 * MS), 29);
+  CHECK_EQ(clock_engine_seconds(&engine, 10500 * MS), 20);
+  CHECK_EQ(clock_engine_seconds(&engine, 40000 * MS), 0);
+  CHECK_EQ(clock_engine_us_to_next_flip(&engine, 40000 * MS), -1);
+}
+
+static void test_boundaries_lock_the_phase(void) {
+  // The controller's second flips 350 ms after ours would
+  controller_t controller = {30000, -650 * MS, 1.0};
+  clock_engine_t engine;
+  clock_engine_init(&engine);
+  send(&engine, &controller, CLOCK_RUN_RUNNING, 0, 3000 * MS, 100 * MS);
+  CHECK(engine.stats.boundaries >= 2);
+
+  // Packets lost from here: the local countdown keeps within a packet
+  // period of the controller's flips
+  int mismatches = 0;
+  for (int64_t now_us = 3000 * MS; now_us < 8000 * MS; now_us += 10 * MS) {
+    int32_t into_second_ms = controller_remaining_ms(&controller, now_us) % 1000;
+    bool near_flip = into_second_ms < 150 || into_second_ms > 850;
+    if (!near_flip && clock_engine_seconds(&engine, now_us) != controller_seconds(&controller, now_us))
+      mismatches++;
+  }
+  CHECK_EQ(mismatches, 0);
+}
+
+static void test_drift_estimate(void) {
+  controller_t controller = {90000, 0, 1.01};
+  clock_engine_t engine;
+  clock_engine_init(&engine);
+  send(&engine, &controller, CLOCK_RUN_RUNNING, 0, 30000 * MS, 100 * MS);
+  // Flip times are only known to a packet period: 100 ms over about 29 s
+  CHECK(engine.rate > 1.005f && engine.rate < 1.015f);
+
+  // Beyond the limit the estimate is clamped
+  controller_t fast = {90000, 0, 1.1};
+  clock_engine_init(&engine);
+  send(&engine, &fast, CLOCK_RUN_RUNNING, 0, 30000 * MS, 100 * MS);
+  CHECK(engine.rate <= 1.0f + CLOCK_ENGINE_RATE_LIMIT + 1e-6f);
+}
+
+static void test_legacy_start_and_stop_inferred(void) {
+  controller_t controller = {20000, 0, 1.0};
+  clock_engine_t engine;
+  clock_engine_init(&engine);
+
+  // Legacy packets carry no run state: the first decrement starts the countdown
+  clock_engine_on_packet(&engine, 20, CLOCK_RUN_UNKNOWN, 0);
+  CHECK(!engine.running);
+  send(&engine, &controller, CLOCK_RUN_UNKNOWN, 100 * MS, 3000 * MS, 100 * MS);
+  CHECK(engine.running);
+
+  // The value stops changing: held once well past the expected flip
+  uint16_t stopped_at = controller_seconds(&controller, 3000 * MS);
+  for (int64_t now_us = 3000 * MS; now_us < 6000 * MS; now_us += 100 * MS) {
+    clock_engine_on_packet(&engine, stopped_at, CLOCK_RUN_UNKNOWN, now_us);
+  }
+  CHECK(!engine.running);
+  CHECK_EQ(clock_engine_seconds(&engine, 10000 * MS), stopped_at);
+}
+
+static void test_reset_jumps_at_once(void) {
+  controller_t controller = {6000, 0, 1.0};
+  clock_engine_t engine;
+  clock_engine_init(&engine);
+  send(&engine, &controller, CLOCK_RUN_RUNNING, 0, 3000 * MS, 100 * MS);
+  uint32_t snaps = engine.stats.snaps;
+
+  clock_engine_on_packet(&engine, 24, CLOCK_RUN_RUNNING, 3000 * MS);
+  CHECK_EQ(engine.stats.snaps, snaps + 1);
+  CHECK_EQ(clock_engine_seconds(&engine, 3000 * MS), 24);
+  CHECK_EQ(clock_engine_seconds(&engine, 4500 * MS), 23);
+
+  // Stop command: held immediately
+  clock_engine_on_packet(&engine, 23, CLOCK_RUN_STOPPED, 4600 * MS);
+  CHECK(!engine.running);
+  CHECK_EQ(clock_engine_seconds(&engine, 9000 * MS), 23);
+}
+
+static void test_small_errors_are_slewed(void) {
+  clock_engine_t engine;
+  clock_engine_init(&engine);
+  clock_engine_on_packet(&engine, 30, CLOCK_RUN_RUNNING, 0);
+  // The controller flips to 29 only 400 ms later than we did: corrected over
+  // CLOCK_ENGINE_SLEW_MS, not at once
+  clock_engine_on_packet(&engine, 30, CLOCK_RUN_RUNNING, 1300 * MS);
+  clock_engine_on_packet(&engine, 29, CLOCK_RUN_RUNNING, 1400 * MS);
+  CHECK_EQ(engine.stats.snaps, 0);
+  CHECK(engine.stats.corrections >= 1);
+  CHECK_EQ(clock_engine_seconds(&engine, 1400 * MS + CLOCK_ENGINE_SLEW_MS * MS), 29);
+  CHECK(labs((long)engine.stats.last_error_ms) < CLOCK_ENGINE_SNAP_MS);
+}
+
+int main(void) {
+  RUN_TEST(test_blank_and_stopped);
+  RUN_TEST(test_free_runs_between_packets);
+  RUN_TEST(test_boundaries_lock_the_phase);
+  RUN_TEST(test_drift_estimate);
+  RUN_TEST(test_legacy_start_and_stop_inferred);
+  RUN_TEST(test_reset_jumps_at_once);
+  RUN_TEST(test_small_errors_are_slewed);
+  return TEST_RESULT();
+}
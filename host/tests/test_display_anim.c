@@ -0,0 +1,179 @@
+// display_anim.h: transitions, effects and incremental redraws
+
+#include "../../include/display_anim.h"
+#include "test.h"
+
+#define SEGMENT_A_MASK (1ULL << SEGMENT_A)
+
+static const uint8_t lit_rgb[3] = {200, 0, 0};
+static const uint8_t off_rgb[3] = {0, 0, 0};
+
+static compiled_layout_t compiled;
+static uint8_t pixels[LEDS_PER_DIGIT * 3];
+
+// One digit in the built-in wiring, segment A (LEDs 0-14) optionally reversed
+static void setup(anim_engine_t *anim, bool a_reversed) {
+  static const uint8_t outputs[] = {0};
+  static const uint16_t bases[] = {0};
+  display_layout_t layout;
+  display_layout_default(&layout, 1, outputs, bases);
+  layout.digits[0].segments[SEGMENT_A].reversed = a_reversed;
+  const layout_output_t chain = {0, LEDS_PER_DIGIT};
+  CHECK_STR(display_layout_compile(&layout, &chain, 1, &compiled), NULL);
+
+  memset(pixels, 0, sizeof(pixels));
+  anim_init(anim, &compiled);
+  anim_set_colors(anim, lit_rgb, off_rgb);
+  anim_sync(anim, 0);
+}
+
+static int red(int led) {
+  return pixels[led * 3];
+}
+
+static void test_cut_redraws_only_changes(void) {
+  anim_engine_t anim;
+  setup(&anim, false);
+  CHECK(!anim_enabled(&anim));
+
+  int32_t sum[3] = {0};
+  anim_set_mask(&anim, SEGMENT_A_MASK, 0);
+  CHECK(anim_render(&anim, pixels, 0, sum));
+  CHECK_EQ(red(0), 200);
+  CHECK_EQ(red(LEDS_PER_SEGMENT_HORIZONTAL - 1), 200);
+  CHECK_EQ(red(LEDS_PER_SEGMENT_HORIZONTAL), 0);
+  CHECK_EQ(sum[0], LEDS_PER_SEGMENT_HORIZONTAL * 200);
+  CHECK(anim_settled(&anim));
+
+  // Nothing changed: nothing written
+  sum[0] = 0;
+  CHECK(!anim_render(&anim, pixels, 1000, sum));
+  CHECK_EQ(sum[0], 0);
+
+  anim_set_mask(&anim, 0, 2000);
+  CHECK(anim_render(&anim, pixels, 2000, sum));
+  CHECK_EQ(red(0), 0);
+  CHECK_EQ(sum[0], -LEDS_PER_SEGMENT_HORIZONTAL * 200);
+}
+
+static void test_sync_and_colors(void) {
+  anim_engine_t anim;
+  setup(&anim, false);
+
+  // Drawn by someone else: setting the same mask draws nothing
+  anim_sync(&anim, SEGMENT_A_MASK);
+  anim_set_mask(&anim, SEGMENT_A_MASK, 0);
+  CHECK(!anim_render(&anim, pixels, 0, NULL));
+  CHECK_EQ(red(0), 0);
+
+  // A color change redraws every element
+  const uint8_t dimmer[3] = {100, 0, 0};
+  anim_set_colors(&anim, dimmer, off_rgb);
+  CHECK(anim_render(&anim, pixels, 0, NULL));
+  CHECK_EQ(red(0), 100);
+}
+
+static void test_crossfade_and_reversal(void) {
+  anim_engine_t anim;
+  setup(&anim, false);
+  anim_set_transition(&anim, ANIM_TRANSITION_CROSSFADE, 1000);
+  CHECK(anim_enabled(&anim));
+
+  anim_set_mask(&anim, SEGMENT_A_MASK, 0);
+  CHECK_EQ(anim.moving_count, 1);
+  anim_render(&anim, pixels, 500, NULL);
+  CHECK_EQ(red(0), 100);
+
+  // Reversed halfway: fades out from the level reached
+  anim_set_mask(&anim, 0, 500);
+  CHECK_EQ(anim.moving_count, 1);
+  anim_render(&anim, pixels, 1000, NULL);
+  CHECK_EQ(red(0), 50);
+  anim_render(&anim, pixels, 1500, NULL);
+  CHECK_EQ(red(0), 0);
+  CHECK(anim_settled(&anim));
+}
+
+static void test_wipe_follows_drawing_direction(void) {
+  anim_engine_t anim;
+  for (int reversed = 0; reversed < 2; reversed++) {
+    setup(&anim, reversed);
+    anim_set_transition(&anim, ANIM_TRANSITION_WIPE, 1000);
+    anim_set_mask(&anim, SEGMENT_A_MASK, 0);
+    anim_render(&anim, pixels, 500, NULL);
+
+    // Half of the 15 LEDs (rounded) lit at full level, from the start of the
+    // run - or from its far end when the data runs against the drawing direction
+    int lit = 0;
+    for (int led = 0; led < LEDS_PER_SEGMENT_HORIZONTAL; led++) {
+      CHECK(red(led) == 0 || red(led) == 200);
+      lit += red(led) == 200;
+    }
+    CHECK_EQ(lit, 8);
+    CHECK_EQ(red(0), reversed ? 0 : 200);
+    CHECK_EQ(red(LEDS_PER_SEGMENT_HORIZONTAL - 1), reversed ? 200 : 0);
+  }
+}
+
+static void test_effects(void) {
+  anim_engine_t anim;
+  setup(&anim, false);
+  anim_set_mask(&anim, SEGMENT_A_MASK, 0);
+
+  anim_set_effect(&anim, ANIM_EFFECT_FLASH, 1000, 0);
+  CHECK(!anim_settled(&anim));
+  anim_render(&anim, pixels, 200, NULL);
+  CHECK_EQ(red(0), 200);
+  anim_render(&anim, pixels, 700, NULL);
+  CHECK_EQ(red(0), 0);
+  anim_render(&anim, pixels, 1200, NULL);
+  CHECK_EQ(red(0), 200);
+
+  // Pulse: full at the start of the period, down to the floor halfway
+  anim_set_effect(&anim, ANIM_EFFECT_PULSE, 1000, 0);
+  anim_render(&anim, pixels, 0, NULL);
+  CHECK_EQ(red(0), 200);
+  anim_render(&anim, pixels, 250, NULL);
+  CHECK_EQ(red(0), 125);
+  anim_render(&anim, pixels, 500, NULL);
+  CHECK_EQ(red(0), 200 * ANIM_PULSE_FLOOR / ANIM_LEVEL_FULL);
+
+  // Dark elements stay dark under an effect
+  CHECK_EQ(red(LEDS_PER_SEGMENT_HORIZONTAL), 0);
+}
+
+static void test_effect_on_dark_settles(void) {
+  anim_engine_t anim;
+  setup(&anim, false);
+  anim_set_transition(&anim, ANIM_TRANSITION_CROSSFADE, 1000);
+  anim_set_effect(&anim, ANIM_EFFECT_PULSE, 1000, 0);
+  CHECK(anim_settled(&anim));
+
+  anim_set_mask(&anim, SEGMENT_A_MASK, 0);
+  anim_render(&anim, pixels, 1000, NULL);
+  CHECK(!anim_settled(&anim));
+
+  // Fading out still moves; once dark the effect has nothing left to change
+  anim_set_mask(&anim, 0, 2000);
+  anim_render(&anim, pixels, 2500, NULL);
+  CHECK(!anim_settled(&anim));
+  anim_render(&anim, pixels, 3000, NULL);
+  CHECK(anim_settled(&anim));
+  CHECK_EQ(red(0), 0);
+  CHECK(!anim_render(&anim, pixels, 3250, NULL));
+
+  anim_sync(&anim, SEGMENT_A_MASK);
+  CHECK(!anim_settled(&anim));
+  anim_sync(&anim, 0);
+  CHECK(anim_settled(&anim));
+}
+
+int main(void) {
+  RUN_TEST(test_cut_redraws_only_changes);
+  RUN_TEST(test_sync_and_colors);
+  RUN_TEST(test_crossfade_and_reversal);
+  RUN_TEST(test_wipe_follows_drawing_direction);
+  RUN_TEST(test_effects);
+  RUN_TEST(test_effect_on_dark_settles);
+  return TEST_RESULT();
+}
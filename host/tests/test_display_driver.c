@@ -0,0 +1,223 @@
+// display_driver.h: frame submission, dirty tracking, keepalive and idle,
+// against the mock LED transports
+
+#include "../../include/display_driver.h"
+#include "led_transport_linux.h"
+#include "platform_linux.h"
+#include "test.h"
+
+#define START_US 1000000
+
+static PlayClockDisplay display;
+
+static led_transport_t *transport(void) {
+  return display.outputs[0].transport;
+}
+
+// Fresh display with its first (dark, whole chain) frame sent
+static void begin(led_transport_kind_t kind) {
+  platform_linux_set_manual_clock(START_US);
+  led_transport_linux_set_auto_complete(false);
+  CHECK(display_begin_with_transport(&display, kind));
+  display_set_transition(&display, ANIM_TRANSITION_CUT, 0);
+  display_set_effect(&display, ANIM_EFFECT_NONE, 0);
+  display_update(&display);
+  CHECK(led_transport_linux_complete(transport()));
+}
+
+// Whether a segment's first LED carries the lit color in the last completed frame
+static bool segment_on_wire(int digit, int segment) {
+  const uint8_t *wire;
+  size_t size = led_transport_linux_frame(transport(), &wire);
+  uint16_t led = display.layout.segments[digit][segment].start;
+  CHECK((size_t)led * 3 + 3 <= size);
+  return wire[led * 3] != 0; // RGB order, the lit color has red
+}
+
+// Every segment of the completed frame matches the digit values
+static void check_digits_on_wire(const uint8_t *digits) {
+  for (int digit = 0; digit < display.layout.digit_count; digit++) {
+    uint8_t pattern = render_digit_pattern(digits[digit]);
+    for (int segment = 0; segment < SEGMENTS_PER_DIGIT; segment++) {
+      CHECK_EQ(segment_on_wire(digit, segment), (pattern >> segment) & 1);
+    }
+  }
+}
+
+static void test_first_frame_covers_chain(void) {
+  begin(LED_TRANSPORT_RMT);
+  const uint8_t *wire;
+  CHECK_EQ(led_transport_linux_frame(transport(), &wire), display.outputs[0].strip_leds * 3);
+  CHECK_EQ(led_transport_linux_submits(transport()), 1);
+
+  // After that only the layout span goes out
+  display_set_time(&display, 42);
+  display_update(&display);
+  CHECK(led_transport_linux_complete(transport()));
+  CHECK_EQ(led_transport_linux_frame(transport(), &wire), display.active_led_count * 3);
+}
+
+static void test_dirty_tracking(void) {
+  begin(LED_TRANSPORT_RMT);
+
+  // Nothing drawn: no frame
+  display_update(&display);
+  CHECK_EQ(led_transport_linux_submits(transport()), 1);
+
+  // Glyph frames are assembled from the symbol cache
+  display_set_time(&display, 42);
+  display_update(&display);
+  CHECK_EQ(led_transport_linux_submits(transport()), 2);
+  CHECK_EQ(led_transport_linux_span_submits(transport()), 1);
+  CHECK(led_transport_linux_complete(transport()));
+  check_digits_on_wire(display.current_digits);
+
+  // Same value again touches no LED
+  display_set_time(&display, 42);
+  display_update(&display);
+  CHECK_EQ(led_transport_linux_submits(transport()), 2);
+  CHECK(!led_transport_linux_complete(transport()));
+}
+
+static void test_spans_match_byte_encoder(void) {
+  const uint8_t *wire;
+  static uint8_t from_spans[LED_COUNT * 3];
+
+  begin(LED_TRANSPORT_RMT);
+  display_set_time(&display, 58);
+  display_update(&display);
+  CHECK(led_transport_linux_complete(transport()));
+  CHECK_EQ(led_transport_linux_span_submits(transport()), 1);
+  size_t size = led_transport_linux_frame(transport(), &wire);
+  memcpy(from_spans, wire, size);
+
+  // The SPI backend can't take symbols: same frame through the byte path
+  begin(LED_TRANSPORT_SPI_DMA);
+  CHECK(transport()->submit_spans == NULL);
+  display_set_time(&display, 58);
+  display_update(&display);
+  CHECK(led_transport_linux_complete(transport()));
+  CHECK_EQ(led_transport_linux_frame(transport(), &wire), size);
+  CHECK(memcmp(from_spans, wire, size) == 0);
+}
+
+static void test_frame_on_wire_untouched(void) {
+  begin(LED_TRANSPORT_RMT_DMA);
+  display_set_time(&display, 42);
+  display_update(&display);
+  uint8_t sent[DISPLAY_MAX_DIGITS];
+  memcpy(sent, display.current_digits, sizeof(sent));
+
+  // Drawn into the back buffer while the frame is on the wire; held until it is done
+  display_set_time(&display, 88);
+  display_update(&display);
+  CHECK_EQ(led_transport_linux_submits(transport()), 2);
+  CHECK(led_transport_linux_complete(transport()));
+  check_digits_on_wire(sent);
+
+  display_update(&display);
+  CHECK_EQ(led_transport_linux_submits(transport()), 3);
+  CHECK(led_transport_linux_complete(transport()));
+  check_digits_on_wire(display.current_digits);
+}
+
+static void test_keepalive(void) {
+  begin(LED_TRANSPORT_RMT);
+  display_set_time(&display, 7);
+  display_update(&display);
+  CHECK(led_transport_linux_complete(transport()));
+  CHECK_EQ(led_transport_linux_submits(transport()), 2);
+
+  platform_linux_advance_us(999000);
+  display_update(&display);
+  CHECK_EQ(led_transport_linux_submits(transport()), 2);
+
+  // An unchanged frame is resent once a second
+  platform_linux_advance_us(1000);
+  display_update(&display);
+  CHECK_EQ(led_transport_linux_submits(transport()), 3);
+  CHECK(led_transport_linux_complete(transport()));
+  check_digits_on_wire(display.current_digits);
+}
+
+static void test_dark_strip_idles(void) {
+  begin(LED_TRANSPORT_RMT);
+  CHECK(display_is_idle(&display));
+
+  display_set_time(&display, 3);
+  CHECK(!display_is_idle(&display));
+  display_update(&display);
+  CHECK(!display_is_idle(&display));
+  CHECK(led_transport_linux_complete(transport()));
+  CHECK(!display_is_idle(&display));
+
+  // Once the dark frame is done nothing is sent, not even keepalives
+  display_set_blank(&display);
+  display_update(&display);
+  CHECK(!display_is_idle(&display));
+  CHECK(led_transport_linux_complete(transport()));
+  CHECK(display_is_idle(&display));
+  uint32_t submits = led_transport_linux_submits(transport());
+  platform_linux_advance_us(5000000);
+  display_update(&display);
+  CHECK_EQ(led_transport_linux_submits(transport()), submits);
+}
+
+// Lost link: digits pulse, then blank - the dark frame must still let the display idle
+static void test_blank_under_effect_idles(void) {
+  begin(LED_TRANSPORT_RMT);
+  display_set_transition(&display, ANIM_TRANSITION_CROSSFADE, 100);
+  display_set_time(&display, 12);
+  display_set_effect(&display, ANIM_EFFECT_PULSE, 1000);
+
+  display_set_blank(&display);
+  for (int frame = 0; frame < 10 && !display_is_idle(&display); frame++) {
+    platform_linux_advance_us(20000);
+    display_animate(&display);
+    display_update(&display);
+    led_transport_linux_complete(transport());
+  }
+  CHECK(display_is_idle(&display));
+  CHECK(!display_animate(&display));
+
+  const uint8_t *wire;
+  size_t size = led_transport_linux_frame(transport(), &wire);
+  size_t lit = 0;
+  for (size_t i = 0; i < size; i++) {
+    lit += wire[i] != 0;
+  }
+  CHECK_EQ(lit, 0);
+}
+
+static void test_stored_layout(void) {
+  platform_linux_clear_storage();
+  begin(LED_TRANSPORT_RMT);
+  uint16_t built_in_base = display.layout_source.digits[1].base;
+
+  display_layout_t layout;
+  const uint8_t outputs[] = {0, 0};
+  const uint16_t bases[] = {0, 300};
+  display_layout_default(&layout, 2, outputs, bases);
+  CHECK(display_store_layout(&display, &layout));
+
+  // Applies on the next start
+  begin(LED_TRANSPORT_RMT);
+  CHECK_EQ(display.layout_source.digits[1].base, 300);
+  CHECK_EQ(display.layout.segments[1][0].start, 300 + layout.digits[1].segments[0].start);
+
+  CHECK(display_store_layout(&display, NULL));
+  begin(LED_TRANSPORT_RMT);
+  CHECK_EQ(display.layout_source.digits[1].base, built_in_base);
+}
+
+int main(void) {
+  RUN_TEST(test_first_frame_covers_chain);
+  RUN_TEST(test_dirty_tracking);
+  RUN_TEST(test_spans_match_byte_encoder);
+  RUN_TEST(test_frame_on_wire_untouched);
+  RUN_TEST(test_keepalive);
+  RUN_TEST(test_dark_strip_idles);
+  RUN_TEST(test_blank_under_effect_idles);
+  RUN_TEST(test_stored_layout);
+  return TEST_RESULT();
+}
@@ -0,0 +1,142 @@
+// display_layout.h: layout validation and glyph span compilation
+
+#include "../../include/display_layout.h"
+#include "test.h"
+#include <string.h>
+
+static const uint8_t outputs_same[] = {0, 0};
+static const uint16_t bases_packed[] = {0, LEDS_PER_DIGIT};
+
+static void two_digit_layout(display_layout_t *layout) {
+  display_layout_default(layout, 2, outputs_same, bases_packed);
+}
+
+static void test_default_layout_compiles(void) {
+  display_layout_t layout;
+  two_digit_layout(&layout);
+  const layout_output_t chain = {0, 2 * LEDS_PER_DIGIT};
+  compiled_layout_t compiled;
+  CHECK_STR(display_layout_compile(&layout, &chain, 1, &compiled), NULL);
+  CHECK_EQ(compiled.digit_count, 2);
+  CHECK_EQ(compiled.led_end, 2 * LEDS_PER_DIGIT);
+  CHECK_EQ(compiled.output_active[0], 2 * LEDS_PER_DIGIT);
+
+  // 8 lights every segment, back to back: one span per digit
+  size_t count;
+  const segment_range_t *spans = layout_glyph_spans(&compiled, 1, 8, &count);
+  CHECK_EQ(count, 1);
+  CHECK_EQ(spans[0].start, LEDS_PER_DIGIT);
+  CHECK_EQ(spans[0].count, LEDS_PER_DIGIT);
+
+  // 1 is B and C, adjacent in the built-in wiring, merged
+  spans = layout_glyph_spans(&compiled, 0, 1, &count);
+  CHECK_EQ(count, 1);
+  CHECK_EQ(spans[0].start, LEDS_PER_SEGMENT_HORIZONTAL);
+  CHECK_EQ(spans[0].count, 2 * LEDS_PER_SEGMENT_VERTICAL);
+
+  layout_glyph_spans(&compiled, 0, RENDER_DIGIT_BLANK, &count);
+  CHECK_EQ(count, 0);
+}
+
+static void test_chain_offsets_and_reversed(void) {
+  // Second digit on its own chain, starting at framebuffer LED 400
+  const uint8_t outputs[] = {0, 1};
+  const uint16_t bases[] = {0, 0};
+  display_layout_t layout;
+  display_layout_default(&layout, 2, outputs, bases);
+  layout.digits[1].segments[SEGMENT_G].reversed = 1;
+  layout.indicator_count = 1;
+  layout.indicators[0] = (layout_indicator_t){1, LEDS_PER_DIGIT, 4};
+  const layout_output_t chains[] = {{0, 400}, {400, 200}};
+  compiled_layout_t compiled;
+  CHECK_STR(display_layout_compile(&layout, chains, 2, &compiled), NULL);
+  CHECK_EQ(compiled.segments[1][SEGMENT_A].start, 400);
+  CHECK_EQ(compiled.indicators[0].start, 400 + LEDS_PER_DIGIT);
+  CHECK_EQ(compiled.output_active[0], LEDS_PER_DIGIT);
+  CHECK_EQ(compiled.output_active[1], LEDS_PER_DIGIT + 4);
+  CHECK_EQ(compiled.led_end, 400 + LEDS_PER_DIGIT + 4);
+  CHECK(layout_element_reversed(&compiled, SEGMENTS_PER_DIGIT + SEGMENT_G));
+  CHECK(!layout_element_reversed(&compiled, SEGMENT_G));
+  CHECK_EQ(layout_element_range(&compiled, LAYOUT_INDICATOR_BIT(0)).count, 4);
+}
+
+static void test_validation_errors(void) {
+  const layout_output_t chain = {0, 2 * LEDS_PER_DIGIT};
+  const layout_output_t chains[LAYOUT_MAX_OUTPUTS + 1] = {{0, 2 * LEDS_PER_DIGIT}};
+  compiled_layout_t compiled;
+  display_layout_t layout;
+
+  two_digit_layout(&layout);
+  layout.version = LAYOUT_VERSION + 1;
+  CHECK_STR(display_layout_compile(&layout, &chain, 1, &compiled), "unsupported layout version");
+
+  two_digit_layout(&layout);
+  layout.digit_count = 0;
+  CHECK_STR(display_layout_compile(&layout, &chain, 1, &compiled), "bad digit count");
+  layout.digit_count = LAYOUT_MAX_DIGITS + 1;
+  CHECK_STR(display_layout_compile(&layout, &chain, 1, &compiled), "bad digit count");
+
+  two_digit_layout(&layout);
+  layout.indicator_count = LAYOUT_MAX_INDICATORS + 1;
+  CHECK_STR(display_layout_compile(&layout, &chain, 1, &compiled), "bad indicator count");
+
+  two_digit_layout(&layout);
+  CHECK_STR(display_layout_compile(&layout, chains, LAYOUT_MAX_OUTPUTS + 1, &compiled), "too many outputs");
+
+  two_digit_layout(&layout);
+  layout.digits[1].output = 1;
+  CHECK_STR(display_layout_compile(&layout, &chain, 1, &compiled), "digit on a missing output");
+
+  two_digit_layout(&layout);
+  layout.digits[1].segments[SEGMENT_G].count++;
+  CHECK_STR(display_layout_compile(&layout, &chain, 1, &compiled), "segment runs past the end of its chain");
+
+  two_digit_layout(&layout);
+  layout.indicator_count = 1;
+  layout.indicators[0] = (layout_indicator_t){1, 0, 2};
+  CHECK_STR(display_layout_compile(&layout, &chain, 1, &compiled), "indicator on a missing output");
+  layout.indicators[0] = (layout_indicator_t){0, 2 * LEDS_PER_DIGIT - 1, 2};
+  CHECK_STR(display_layout_compile(&layout, &chain, 1, &compiled), "indicator runs past the end of its chain");
+}
+
+#define EDIT(layout, ...) \
+  display_layout_edit((layout), sizeof((const char *[]){__VA_ARGS__}) / sizeof(const char *), \
+                      (const char *const[]){__VA_ARGS__})
+
+static void test_console_edits(void) {
+  display_layout_t layout;
+  two_digit_layout(&layout);
+  CHECK_STR(EDIT(&layout, "digits", "1"), NULL);
+  CHECK_EQ(layout.digit_count, 1);
+  CHECK_STR(EDIT(&layout, "digit", "0", "1", "40"), NULL);
+  CHECK_EQ(layout.digits[0].output, 1);
+  CHECK_EQ(layout.digits[0].base, 40);
+  CHECK_STR(EDIT(&layout, "segment", "0", "g", "90", "12", "r"), NULL);
+  CHECK_EQ(layout.digits[0].segments[SEGMENT_G].start, 90);
+  CHECK_EQ(layout.digits[0].segments[SEGMENT_G].count, 12);
+  CHECK_EQ(layout.digits[0].segments[SEGMENT_G].reversed, 1);
+  CHECK_STR(EDIT(&layout, "indicator", "1", "0", "200", "2"), NULL);
+  CHECK_EQ(layout.indicator_count, 2);
+  CHECK_EQ(layout.indicators[1].start, 200);
+
+  // Rejected edits leave the layout as it was
+  display_layout_t before = layout;
+  CHECK(EDIT(&layout, "digits", "0") != NULL);
+  CHECK(EDIT(&layout, "digits", "7") != NULL);
+  CHECK(EDIT(&layout, "digit", "0", "1") != NULL);
+  CHECK(EDIT(&layout, "digit", "0", "1", "4x") != NULL);
+  CHECK(EDIT(&layout, "segment", "0", "h", "0", "1") != NULL);
+  CHECK(EDIT(&layout, "segment", "0", "a", "0", "1", "x") != NULL);
+  CHECK(EDIT(&layout, "segment", "0", "a", "-1", "1") != NULL);
+  CHECK(EDIT(&layout, "indicator", "9", "0", "0", "1") != NULL);
+  CHECK_STR(EDIT(&layout, "pixel", "0"), "unknown edit (digits, digit, segment, indicator)");
+  CHECK(memcmp(&before, &layout, sizeof(layout)) == 0);
+}
+
+int main(void) {
+  RUN_TEST(test_default_layout_compiles);
+  RUN_TEST(test_chain_offsets_and_reversed);
+  RUN_TEST(test_validation_errors);
+  RUN_TEST(test_console_edits);
+  return TEST_RESULT();
+}
@@ -0,0 +1,110 @@
+// display_render.h: value formatting and framebuffer fills
+
+#include "../../include/display_render.h"
+#include "test.h"
+
+#define B RENDER_DIGIT_BLANK
+
+static void check_digits(const uint8_t *digits, const uint8_t *expected, int count, int line) {
+  for (int i = 0; i < count; i++) {
+    if (digits[i] != expected[i]) {
+      test_failures++;
+      fprintf(stderr, "%s:%d: digit %d is %d, expected %d\n", __FILE__, line, i, digits[i], expected[i]);
+    }
+  }
+}
+
+#define CHECK_DIGITS(digits, ...)                                                            \
+  do {                                                                                       \
+    const uint8_t expected[] = {__VA_ARGS__};                                                \
+    test_checks++;                                                                           \
+    check_digits(digits, expected, sizeof(expected), __LINE__);                              \
+  } while (0)
+
+static void test_format_plain(void) {
+  uint8_t digits[4];
+  CHECK(!render_format_value(RENDER_FORMAT_PLAIN, 7, false, digits, 2));
+  CHECK_DIGITS(digits, 0, 7);
+  render_format_value(RENDER_FORMAT_PLAIN, 7, true, digits, 2);
+  CHECK_DIGITS(digits, B, 7);
+  render_format_value(RENDER_FORMAT_PLAIN, 0, true, digits, 2);
+  CHECK_DIGITS(digits, B, 0);
+  render_format_value(RENDER_FORMAT_PLAIN, 123, false, digits, 2);
+  CHECK_DIGITS(digits, 9, 9);
+  render_format_value(RENDER_FORMAT_PLAIN, 305, true, digits, 4);
+  CHECK_DIGITS(digits, B, 3, 0, 5);
+  CHECK(!render_format_value(RENDER_FORMAT_PLAIN, 5, false, digits, 0));
+}
+
+static void test_format_mmss(void) {
+  uint8_t digits[4];
+  CHECK(render_format_value(RENDER_FORMAT_MMSS, 125, false, digits, 4));
+  CHECK_DIGITS(digits, 0, 2, 0, 5);
+  render_format_value(RENDER_FORMAT_MMSS, 125, true, digits, 4);
+  CHECK_DIGITS(digits, B, 2, 0, 5);
+  render_format_value(RENDER_FORMAT_MMSS, 5, true, digits, 4);
+  CHECK_DIGITS(digits, B, 0, 0, 5); // The last minutes digit stays
+  render_format_value(RENDER_FORMAT_MMSS, 6000, false, digits, 4);
+  CHECK_DIGITS(digits, 9, 9, 5, 9);
+  CHECK(render_format_value(RENDER_FORMAT_MMSS, 61, false, digits, 3));
+  CHECK_DIGITS(digits, 1, 0, 1);
+  render_format_value(RENDER_FORMAT_MMSS, 600, false, digits, 3);
+  CHECK_DIGITS(digits, 9, 5, 9);
+
+  // Two digits can't hold MM:SS - plain seconds, no separator
+  CHECK(!render_format_value(RENDER_FORMAT_MMSS, 45, false, digits, 2));
+  CHECK_DIGITS(digits, 4, 5);
+}
+
+static void test_fill_spans_sum_delta(void) {
+  uint8_t pixels[10 * 3];
+  memset(pixels, 0, sizeof(pixels));
+  const segment_range_t spans[] = {{0, 2}, {5, 3}};
+  const uint8_t color[3] = {10, 20, 30};
+  const uint8_t dim[3] = {5, 20, 0};
+
+  int32_t delta[3] = {0, 0, 0};
+  CHECK(render_fill_spans(pixels, spans, 2, color, delta));
+  CHECK_EQ(delta[0], 5 * 10);
+  CHECK_EQ(delta[1], 5 * 20);
+  CHECK_EQ(delta[2], 5 * 30);
+  CHECK_EQ(pixels[5 * 3 + 2], 30);
+  CHECK_EQ(pixels[3 * 3], 0); // Between the spans
+
+  // Same color again: nothing changes
+  memset(delta, 0, sizeof(delta));
+  CHECK(!render_fill_spans(pixels, spans, 2, color, delta));
+  CHECK_EQ(delta[0], 0);
+  CHECK_EQ(delta[1], 0);
+  CHECK_EQ(delta[2], 0);
+
+  // Deltas are signed and accumulate
+  CHECK(render_fill_spans(pixels, spans, 1, dim, delta));
+  CHECK(render_fill_spans(pixels, &spans[1], 1, dim, delta));
+  CHECK_EQ(delta[0], 5 * (5 - 10));
+  CHECK_EQ(delta[1], 0);
+  CHECK_EQ(delta[2], 5 * -30);
+
+  // NULL delta is allowed
+  CHECK(render_fill_spans(pixels, spans, 2, color, NULL));
+}
+
+static void test_fill_clips(void) {
+  uint8_t pixels[4 * 3];
+  memset(pixels, 0, sizeof(pixels));
+  const uint8_t white[3] = {255, 255, 255};
+  int32_t delta[3] = {0, 0, 0};
+  CHECK(render_fill(pixels, 4, 2, 10, white, delta));
+  CHECK_EQ(delta[0], 2 * 255);
+  CHECK_EQ(pixels[1 * 3], 0);
+  CHECK_EQ(pixels[3 * 3], 255);
+  CHECK(!render_fill(pixels, 4, 4, 1, white, delta));
+}
+
+int main(void) {
+  RUN_TEST(test_format_plain);
+  RUN_TEST(test_format_mmss);
+  RUN_TEST(test_fill_spans_sum_delta);
+  RUN_TEST(test_fill_clips);
+  return TEST_RESULT();
+}
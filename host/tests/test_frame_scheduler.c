@@ -0,0 +1,99 @@
+// frame_scheduler.h: grid-aligned deadlines, missed frames and overruns
+
+#include "../../include/frame_scheduler.h"
+#include "test.h"
+
+#define START_US 1000000
+#define RATE_HZ 50
+#define PERIOD_US (1000000 / RATE_HZ)
+
+static void test_grid_alignment(void) {
+  frame_scheduler_t scheduler;
+  frame_scheduler_init(&scheduler, RATE_HZ, START_US);
+  CHECK_EQ(scheduler.period_us, PERIOD_US);
+  CHECK_EQ(scheduler.budget_us, PERIOD_US * FRAME_SCHEDULER_BUDGET_PERCENT / 100);
+  CHECK_EQ(frame_scheduler_time_to_deadline(&scheduler, START_US), PERIOD_US);
+
+  // An early wakeup is a pass without a frame
+  CHECK(frame_scheduler_begin(&scheduler, START_US + 5000));
+  frame_scheduler_end(&scheduler, START_US + 6000);
+  CHECK_EQ(scheduler.stats.frames, 0);
+
+  // Deadlines stay on start + n * period however late a pass begins
+  int64_t now = START_US + PERIOD_US + 3000;
+  CHECK(frame_scheduler_begin(&scheduler, now));
+  frame_scheduler_end(&scheduler, now + 1000);
+  CHECK_EQ(scheduler.stats.frames, 1);
+  CHECK_EQ(scheduler.deadline_us, START_US + 2 * PERIOD_US);
+  CHECK_EQ(frame_scheduler_time_to_deadline(&scheduler, now), PERIOD_US - 3000);
+  CHECK_EQ(frame_scheduler_time_to_deadline(&scheduler, START_US + 3 * PERIOD_US), 0);
+  CHECK_EQ(scheduler.stats.missed, 0);
+  CHECK_EQ(scheduler.stats.work_us, 1000);
+}
+
+static void test_missed_deadlines(void) {
+  frame_scheduler_t scheduler;
+  frame_scheduler_init(&scheduler, RATE_HZ, START_US);
+
+  // Two and a half periods late: two deadlines dropped, one frame, back on the grid
+  int64_t now = START_US + PERIOD_US + 2 * PERIOD_US + PERIOD_US / 2;
+  CHECK(frame_scheduler_begin(&scheduler, now));
+  CHECK_EQ(scheduler.stats.frames, 1);
+  CHECK_EQ(scheduler.stats.missed, 2);
+  CHECK_EQ(scheduler.deadline_us, START_US + 4 * PERIOD_US);
+}
+
+static void test_overrun_skips_one_render(void) {
+  frame_scheduler_t scheduler;
+  frame_scheduler_init(&scheduler, RATE_HZ, START_US);
+
+  int64_t now = START_US + PERIOD_US;
+  CHECK(frame_scheduler_begin(&scheduler, now));
+  frame_scheduler_end(&scheduler, now + scheduler.budget_us + 1);
+  CHECK_EQ(scheduler.stats.overruns, 1);
+  CHECK_EQ(scheduler.stats.work_us_max, scheduler.budget_us + 1);
+
+  // Next pass handles input only, the one after renders again
+  now += PERIOD_US;
+  CHECK(!frame_scheduler_begin(&scheduler, now));
+  frame_scheduler_end(&scheduler, now + 100);
+  CHECK_EQ(scheduler.stats.skipped, 1);
+  now += PERIOD_US;
+  CHECK(frame_scheduler_begin(&scheduler, now));
+  frame_scheduler_end(&scheduler, now + 100);
+  CHECK_EQ(scheduler.stats.skipped, 1);
+  CHECK_EQ(scheduler.stats.work_us_max, scheduler.budget_us + 1);
+
+  // Exactly the budget is no overrun
+  now += PERIOD_US;
+  frame_scheduler_begin(&scheduler, now);
+  frame_scheduler_end(&scheduler, now + scheduler.budget_us);
+  CHECK_EQ(scheduler.stats.overruns, 1);
+}
+
+static void test_resync(void) {
+  frame_scheduler_t scheduler;
+  frame_scheduler_init(&scheduler, RATE_HZ, START_US);
+
+  // A pass that blocked for seconds (a self-test) overran
+  int64_t now = START_US + PERIOD_US;
+  frame_scheduler_begin(&scheduler, now);
+  now += 3000000;
+  frame_scheduler_end(&scheduler, now);
+
+  // The grid restarts there: nothing counted missed, no skipped render
+  frame_scheduler_resync(&scheduler, now);
+  CHECK_EQ(frame_scheduler_time_to_deadline(&scheduler, now), PERIOD_US);
+  CHECK(frame_scheduler_begin(&scheduler, now + PERIOD_US));
+  CHECK_EQ(scheduler.stats.missed, 0);
+  CHECK_EQ(scheduler.stats.skipped, 0);
+  CHECK_EQ(scheduler.stats.frames, 2);
+}
+
+int main(void) {
+  RUN_TEST(test_grid_alignment);
+  RUN_TEST(test_missed_deadlines);
+  RUN_TEST(test_overrun_skips_one_render);
+  RUN_TEST(test_resync);
+  return TEST_RESULT();
+}
@@ -0,0 +1,148 @@
+// latency_trace.h: stage histograms, p99 and trace expiry
+
+#include "../../include/latency_trace.h"
+#include "platform_linux.h"
+#include "test.h"
+
+#define MARKER_PIN 5
+#define NOW_US 10000000
+
+// One packet whose PARSE stage comes latency_us after its arrival
+static void trace_parse(uint8_t sequence, uint32_t latency_us) {
+  latency_trace_begin(sequence, NOW_US - latency_us);
+  latency_trace_mark(LATENCY_STAGE_PARSE);
+}
+
+static uint32_t parse_p99(void) {
+  latency_stage_stats_t stats;
+  latency_trace_get_stats(LATENCY_STAGE_PARSE, &stats);
+  return stats.p99_us;
+}
+
+// p99 of 99 samples at latency_us and one far above: the bucket's upper edge
+static uint32_t bucket_edge(uint32_t latency_us) {
+  latency_trace_reset_stats();
+  for (int i = 0; i < 99; i++) {
+    trace_parse((uint8_t)i, latency_us);
+  }
+  trace_parse(99, 100000);
+  return parse_p99();
+}
+
+static void test_bucket_edges(void) {
+  latency_trace_init(LATENCY_TRACE_MARKER_NONE);
+  platform_linux_set_manual_clock(NOW_US);
+
+  // Exact below 16 us, then 8 buckets per power of two: 16-31 us in steps of 2
+  CHECK_EQ(bucket_edge(15), 15);
+  CHECK_EQ(bucket_edge(16), 17);
+  CHECK_EQ(bucket_edge(17), 17);
+  CHECK_EQ(bucket_edge(18), 19);
+  CHECK_EQ(bucket_edge(30), 31);
+  CHECK_EQ(bucket_edge(31), 31);
+  CHECK_EQ(bucket_edge(32), 35);
+  CHECK_EQ(bucket_edge(20000), 20479);
+
+  // Top of the range: clamped to the largest latency seen
+  latency_trace_reset_stats();
+  trace_parse(0, LATENCY_TRACE_TIMEOUT_US);
+  latency_stage_stats_t stats;
+  latency_trace_get_stats(LATENCY_STAGE_PARSE, &stats);
+  CHECK_EQ(stats.count, 1);
+  CHECK_EQ(stats.max_us, LATENCY_TRACE_TIMEOUT_US);
+  CHECK_EQ(stats.p99_us, LATENCY_TRACE_TIMEOUT_US);
+}
+
+static void test_p99_rank(void) {
+  latency_trace_init(LATENCY_TRACE_MARKER_NONE);
+  platform_linux_set_manual_clock(NOW_US);
+
+  // 100 samples: the 99th decides, one outlier doesn't move p99 but two do
+  for (int i = 0; i < 99; i++) {
+    trace_parse((uint8_t)i, 20);
+  }
+  trace_parse(99, 5000);
+  CHECK_EQ(parse_p99(), 21);
+
+  latency_trace_reset_stats();
+  for (int i = 0; i < 98; i++) {
+    trace_parse((uint8_t)i, 20);
+  }
+  trace_parse(98, 5000);
+  trace_parse(99, 5000);
+  CHECK_EQ(parse_p99(), 5000);
+
+  latency_stage_stats_t stats;
+  latency_trace_get_stats(LATENCY_STAGE_PARSE, &stats);
+  CHECK_EQ(stats.count, 100);
+  CHECK_EQ(stats.min_us, 20);
+  CHECK_EQ(stats.avg_us, (98 * 20 + 2 * 5000) / 100);
+}
+
+static void test_stages_in_order(void) {
+  latency_trace_init(MARKER_PIN);
+  platform_linux_set_manual_clock(NOW_US);
+
+  latency_trace_begin(7, NOW_US);
+  CHECK_EQ(platform_gpio_get(MARKER_PIN), 1);
+
+  // Out of order and repeated marks don't count
+  platform_linux_advance_us(100);
+  latency_trace_mark(LATENCY_STAGE_RENDER);
+  latency_trace_mark(LATENCY_STAGE_PARSE);
+  platform_linux_advance_us(100);
+  latency_trace_mark(LATENCY_STAGE_PARSE);
+  latency_trace_mark(LATENCY_STAGE_RENDER);
+  latency_trace_mark(LATENCY_STAGE_SUBMIT);
+  latency_trace_mark(LATENCY_STAGE_DONE);
+  CHECK_EQ(platform_gpio_get(MARKER_PIN), 0);
+
+  latency_stage_stats_t stats;
+  latency_trace_get_stats(LATENCY_STAGE_PARSE, &stats);
+  CHECK_EQ(stats.count, 1);
+  CHECK_EQ(stats.max_us, 100);
+  latency_trace_get_stats(LATENCY_STAGE_DONE, &stats);
+  CHECK_EQ(stats.max_us, 200);
+
+  latency_event_t events[8];
+  CHECK_EQ(latency_trace_read_events(events, 8), 5);
+  CHECK_EQ(events[0].stage, LATENCY_STAGE_RX);
+  CHECK_EQ(events[4].stage, LATENCY_STAGE_DONE);
+  CHECK_EQ(events[4].sequence, 7);
+}
+
+static void test_trace_expires(void) {
+  latency_trace_init(MARKER_PIN);
+  platform_linux_set_manual_clock(NOW_US);
+
+  // The frame never made it out: the trace is dropped on the first late mark
+  latency_trace_begin(3, NOW_US);
+  latency_trace_mark(LATENCY_STAGE_PARSE);
+  platform_linux_advance_us(LATENCY_TRACE_TIMEOUT_US + 1);
+  latency_trace_mark(LATENCY_STAGE_RENDER);
+  CHECK_EQ(platform_gpio_get(MARKER_PIN), 0);
+  latency_trace_mark(LATENCY_STAGE_SUBMIT);
+  latency_trace_mark(LATENCY_STAGE_DONE);
+
+  latency_stage_stats_t stats;
+  latency_trace_get_stats(LATENCY_STAGE_RENDER, &stats);
+  CHECK_EQ(stats.count, 0);
+  latency_trace_get_stats(LATENCY_STAGE_DONE, &stats);
+  CHECK_EQ(stats.count, 0);
+
+  // latency_trace_end() closes a trace whose packet changed nothing
+  latency_trace_begin(4, platform_micros());
+  latency_trace_end();
+  CHECK_EQ(platform_gpio_get(MARKER_PIN), 0);
+  latency_trace_mark(LATENCY_STAGE_PARSE);
+  latency_trace_get_stats(LATENCY_STAGE_PARSE, &stats);
+  CHECK_EQ(stats.count, 1);
+}
+
+int main(void) {
+  RUN_TEST(test_bucket_edges);
+  RUN_TEST(test_p99_rank);
+  RUN_TEST(test_stages_in_order);
+  RUN_TEST(test_trace_expires);
+  return TEST_RESULT();
+}
@@ -0,0 +1,141 @@
+// link_quality.h: loss window, adaptive timeout, jitter and link status
+
+#include "../../include/link_quality.h"
+#include "test.h"
+
+// Sequence tracker counters as the radio task would pass them
+typedef struct {
+  link_quality_t link;
+  radio_sequence_stats_t counters;
+  int64_t now_us;
+} feed_t;
+
+static void feed_init(feed_t *feed) {
+  memset(feed, 0, sizeof(*feed));
+  link_quality_init(&feed->link);
+  feed->now_us = 1000000;
+}
+
+// One batch after interval_ms: lost frames skipped, then one accepted
+static void batch(feed_t *feed, uint32_t interval_ms, uint32_t lost) {
+  feed->now_us += (int64_t)interval_ms * 1000;
+  feed->counters.accepted++;
+  feed->counters.lost += lost;
+  link_quality_on_batch(&feed->link, &feed->counters, feed->now_us);
+}
+
+static void test_loss_window(void) {
+  feed_t feed;
+  feed_init(&feed);
+  CHECK_EQ(link_quality_loss_percent(&feed.link), 0);
+
+  for (int i = 0; i < 10; i++) {
+    batch(&feed, 200, 0);
+    batch(&feed, 400, 1);
+  }
+  CHECK_EQ(feed.link.stats.frames, 30);
+  CHECK_EQ(feed.link.stats.lost, 10);
+  CHECK_EQ(link_quality_loss_percent(&feed.link), 33);
+
+  // Loss ages out of the window
+  for (int i = 0; i < LINK_QUALITY_WINDOW_FRAMES; i++) {
+    batch(&feed, 200, 0);
+  }
+  CHECK_EQ(link_quality_loss_percent(&feed.link), 0);
+  CHECK_EQ(feed.link.stats.lost, 10);
+
+  // Duplicates are the controller resending after a lost ACK
+  feed.counters.duplicates += 3;
+  link_quality_on_batch(&feed.link, &feed.counters, feed.now_us);
+  CHECK_EQ(feed.link.stats.retransmits, 3);
+}
+
+static void test_adaptive_timeout(void) {
+  feed_t feed;
+  feed_init(&feed);
+
+  // Until the packet rate is known, the upper bound applies
+  for (int i = 0; i < LINK_QUALITY_MIN_INTERVALS; i++) {
+    CHECK_EQ(link_quality_timeout_ms(&feed.link), LINK_QUALITY_MAX_TIMEOUT_MS);
+    batch(&feed, 200, 0);
+  }
+  batch(&feed, 200, 0);
+  link_summary_t summary;
+  link_quality_summarize(&feed.link, &summary);
+  CHECK_EQ(summary.interval_ms, 200);
+  CHECK_EQ(summary.timeout_ms, 200 * LINK_QUALITY_MISSED_INTERVALS);
+  CHECK_EQ(summary.loss_percent, 0);
+
+  // A lost frame spans two intervals, not one long one
+  batch(&feed, 400, 1);
+  CHECK_EQ(link_quality_timeout_ms(&feed.link), 200 * LINK_QUALITY_MISSED_INTERVALS);
+
+  // A silence that loses the link says nothing about the rate
+  batch(&feed, LINK_QUALITY_MAX_TIMEOUT_MS + 1, 0);
+  CHECK_EQ(feed.link.interval_us, 200000);
+
+  // Fast senders are held to the lower bound
+  feed_init(&feed);
+  for (int i = 0; i <= LINK_QUALITY_MIN_INTERVALS; i++) {
+    batch(&feed, 20, 0);
+  }
+  CHECK_EQ(link_quality_timeout_ms(&feed.link), LINK_QUALITY_MIN_TIMEOUT_MS);
+}
+
+static void test_jitter(void) {
+  feed_t feed;
+  feed_init(&feed);
+
+  // Steady arrivals: the first batch has nothing to compare to, the second sets the interval
+  for (int i = 0; i < 10; i++) {
+    batch(&feed, 200, 0);
+  }
+  CHECK_EQ(feed.link.stats.jitter_bins[0], 8);
+  CHECK_EQ(feed.link.jitter_us, 0);
+
+  // 30 ms early and late: the 20-50 ms bin, and a longer timeout
+  uint32_t steady_timeout = link_quality_timeout_ms(&feed.link);
+  for (int i = 0; i < 20; i++) {
+    batch(&feed, i % 2 ? 230 : 170, 0);
+  }
+  CHECK_EQ(feed.link.stats.jitter_bins[5], 20);
+  CHECK(feed.link.jitter_us > 0);
+  CHECK(link_quality_timeout_ms(&feed.link) > steady_timeout);
+
+  char line[96];
+  link_quality_format_jitter(&feed.link.stats, line, sizeof(line));
+  CHECK_STR(line, "<1:8 <2:0 <5:0 <10:0 <20:0 <50:20 <100:0 >=100:0");
+
+  // Truncated, still terminated
+  link_quality_format_jitter(&feed.link.stats, line, 10);
+  CHECK_STR(line, "<1:8 <2:0");
+}
+
+static void test_status(void) {
+  link_summary_t summary = {200, 800, 0};
+  CHECK_EQ(link_quality_status(&summary, 0), LINK_STATUS_GOOD);
+  CHECK_EQ(link_quality_ms_to_change(&summary, 0), 401);
+  CHECK_EQ(link_quality_status(&summary, 400), LINK_STATUS_GOOD);
+  CHECK_EQ(link_quality_status(&summary, 401), LINK_STATUS_DEGRADED);
+  CHECK_EQ(link_quality_ms_to_change(&summary, 401), 400);
+  CHECK_EQ(link_quality_status(&summary, 800), LINK_STATUS_DEGRADED);
+  CHECK_EQ(link_quality_status(&summary, 801), LINK_STATUS_LOST);
+  CHECK_EQ(link_quality_ms_to_change(&summary, 801), UINT32_MAX);
+
+  // High loss degrades a link that is still heard
+  summary.loss_percent = LINK_QUALITY_DEGRADED_LOSS_PERCENT;
+  CHECK_EQ(link_quality_status(&summary, 0), LINK_STATUS_DEGRADED);
+  CHECK_EQ(link_quality_ms_to_change(&summary, 0), 801);
+
+  CHECK_STR(link_status_name(LINK_STATUS_LOST), "lost");
+  CHECK_STR(link_status_name(LINK_STATUS_DEGRADED), "degraded");
+  CHECK_STR(link_status_name(LINK_STATUS_GOOD), "good");
+}
+
+int main(void) {
+  RUN_TEST(test_loss_window);
+  RUN_TEST(test_adaptive_timeout);
+  RUN_TEST(test_jitter);
+  RUN_TEST(test_status);
+  return TEST_RESULT();
+}
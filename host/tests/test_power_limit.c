@@ -0,0 +1,73 @@
+// power_limit.h: current estimate, immediate cut and gradual release
+
+#include "../../include/power_limit.h"
+#include "test.h"
+
+// 20 mA per channel at full duty, 50 mA with the strip dark, 1 A budget
+#define CHANNEL_UA 20000
+#define IDLE_MA 50
+#define BUDGET_MA 1000
+#define RELEASE_STEP 32
+
+// Channel sum of this many channels at full duty
+#define FULL_CHANNELS(count) ((count) * 255)
+
+static void test_draw_estimate(void) {
+  power_limit_t power;
+  power_limit_init(&power, BUDGET_MA, CHANNEL_UA, IDLE_MA, RELEASE_STEP);
+  CHECK_EQ(power_limit_draw_ma(&power, 0, POWER_LIMIT_FULL), IDLE_MA);
+  CHECK_EQ(power_limit_draw_ma(&power, FULL_CHANNELS(10), POWER_LIMIT_FULL), IDLE_MA + 200);
+  CHECK_EQ(power_limit_draw_ma(&power, FULL_CHANNELS(10), POWER_LIMIT_FULL / 2), IDLE_MA + 100);
+}
+
+static void test_within_budget(void) {
+  power_limit_t power;
+  power_limit_init(&power, BUDGET_MA, CHANNEL_UA, IDLE_MA, RELEASE_STEP);
+  CHECK_EQ(power_limit_update(&power, FULL_CHANNELS(10)), POWER_LIMIT_FULL);
+  CHECK_EQ(power.stats.requested_ma, IDLE_MA + 200);
+  CHECK_EQ(power.stats.estimate_ma, IDLE_MA + 200);
+  CHECK_EQ(power.stats.limited_frames, 0);
+}
+
+static void test_cut_at_once_release_gradually(void) {
+  power_limit_t power;
+  power_limit_init(&power, BUDGET_MA, CHANNEL_UA, IDLE_MA, RELEASE_STEP);
+
+  // 2 A requested: scaled into the budget on the first frame
+  uint16_t limit = power_limit_update(&power, FULL_CHANNELS(100));
+  CHECK(limit < POWER_LIMIT_FULL);
+  CHECK_EQ(power.stats.requested_ma, IDLE_MA + 2000);
+  CHECK(power.stats.estimate_ma <= BUDGET_MA);
+  CHECK(power.stats.estimate_ma > BUDGET_MA - 10);
+  CHECK_EQ(power.stats.peak_ma, power.stats.estimate_ma);
+  CHECK_EQ(power.stats.limited_frames, 1);
+
+  // Back within budget: recovers one step per frame, never overshooting full
+  uint32_t peak = power.stats.peak_ma;
+  uint16_t previous = limit;
+  int frames = 0;
+  while (power_limit_update(&power, FULL_CHANNELS(10)) < POWER_LIMIT_FULL) {
+    CHECK_EQ(power.limit, previous + RELEASE_STEP);
+    previous = power.limit;
+    frames++;
+  }
+  CHECK_EQ(frames, (POWER_LIMIT_FULL - limit - 1) / RELEASE_STEP);
+  CHECK_EQ(power.stats.limited_frames, 1 + frames);
+  CHECK_EQ(power.stats.peak_ma, peak);
+}
+
+static void test_budget_below_idle(void) {
+  power_limit_t power;
+  power_limit_init(&power, IDLE_MA / 2, CHANNEL_UA, IDLE_MA, RELEASE_STEP);
+  CHECK_EQ(power_limit_update(&power, FULL_CHANNELS(1)), 0);
+  CHECK_EQ(power.stats.estimate_ma, IDLE_MA);
+  CHECK_EQ(power_limit_update(&power, 0), RELEASE_STEP);
+}
+
+int main(void) {
+  RUN_TEST(test_draw_estimate);
+  RUN_TEST(test_within_budget);
+  RUN_TEST(test_cut_at_once_release_gradually);
+  RUN_TEST(test_budget_below_idle);
+  return TEST_RESULT();
+}
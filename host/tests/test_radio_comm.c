@@ -0,0 +1,123 @@
+// radio_comm.h: draining the RX FIFO and the IRQ wakeup, against the emulated nRF24
+
+#include "../../include/radio_comm.h"
+#include "platform_linux.h"
+#include "radio_common.h"
+#include "test.h"
+
+#define CE_PIN 5
+#define CSN_PIN 4
+#define IRQ_PIN 22
+#define START_US 1000000
+
+static RadioComm radio;
+
+// v1 frame with the play clock at seconds
+static void receive(uint8_t sequence, uint16_t seconds) {
+  uint16_t tenths = seconds * 10;
+  const uint8_t frame[] = {0xC1, sequence, 0x01, 0x03, tenths >> 8, tenths & 0xFF, 0x00};
+  CHECK(radio_common_linux_receive(frame, sizeof(frame)));
+}
+
+static void start(SystemState *state) {
+  platform_linux_set_manual_clock(0);
+  memset(state, 0, sizeof(*state));
+  CHECK(radio_begin(&radio, CE_PIN, CSN_PIN));
+  radio_start_listening(&radio);
+  platform_linux_set_manual_clock(START_US);
+}
+
+static void test_nothing_pending(void) {
+  SystemState state;
+  start(&state);
+
+  // One status read, no FIFO access
+  uint32_t transactions = radio_common_linux_transactions();
+  CHECK(!radio_receive_message(&radio, &state));
+  CHECK_EQ(radio_common_linux_transactions() - transactions, 1);
+}
+
+static void test_drain_applies_newest(void) {
+  SystemState state;
+  start(&state);
+
+  // Out of order, and a fourth one the full FIFO drops
+  receive(2, 9);
+  receive(3, 8);
+  receive(1, 10);
+  const uint8_t lost[] = {0xC1, 4, 0x01, 0x03, 0x00, 0x46, 0x00};
+  CHECK(!radio_common_linux_receive(lost, sizeof(lost)));
+
+  CHECK(radio_receive_message(&radio, &state));
+  CHECK_EQ(radio_common_linux_rx_pending(), 0);
+  CHECK_EQ(nrf24_get_status(&radio) & NRF24_STATUS_RX_DR, 0);
+  CHECK_EQ(state.sequence, 3);
+  CHECK_EQ(state.seconds, 8);
+  CHECK_EQ(state.rx_time_us, START_US);
+
+  // Ordered by sequence before applying, so all three count
+  radio_sequence_stats_t stats;
+  radio_get_sequence_stats(&stats);
+  CHECK_EQ(stats.received, 3);
+  CHECK_EQ(stats.accepted, 3);
+  CHECK_EQ(stats.reorders, 1);
+}
+
+static void test_stale_and_malformed(void) {
+  SystemState state;
+  start(&state);
+  receive(5, 20);
+  CHECK(radio_receive_message(&radio, &state));
+
+  // A repeat keeps the link alive but changes nothing
+  platform_linux_advance_us(100000);
+  receive(5, 19);
+  CHECK(!radio_receive_message(&radio, &state));
+  CHECK_EQ(state.seconds, 20);
+  CHECK_EQ(state.last_status_time, (START_US + 100000) / 1000);
+  radio_sequence_stats_t stats;
+  radio_get_sequence_stats(&stats);
+  CHECK_EQ(stats.duplicates, 1);
+
+  // Malformed payloads are dropped from the batch
+  const uint8_t garbage[] = {0xC1, 6, 0x01, 0x05};
+  CHECK(radio_common_linux_receive(garbage, sizeof(garbage)));
+  receive(7, 18);
+  CHECK(radio_receive_message(&radio, &state));
+  CHECK_EQ(radio_common_linux_rx_pending(), 0);
+  CHECK_EQ(state.seconds, 18);
+}
+
+static void test_irq_wakeup(void) {
+  SystemState state;
+  start(&state);
+  CHECK(radio_enable_irq(&radio, IRQ_PIN));
+  radio_common_linux_set_irq_pin(IRQ_PIN);
+
+  // Nothing arrives: the wait times out
+  CHECK(!radio_wait_for_message(&radio, &state, 100));
+  CHECK_EQ(platform_micros(), START_US + 100000);
+
+  // The falling edge stamps the arrival; the line goes high once RX_DR is cleared
+  int64_t arrival_us = platform_micros();
+  receive(1, 30);
+  CHECK_EQ(platform_gpio_get(IRQ_PIN), 0);
+  platform_linux_advance_us(2000);
+  CHECK(radio_wait_for_message(&radio, &state, 100));
+  CHECK_EQ(state.seconds, 30);
+  CHECK_EQ(state.rx_time_us, arrival_us);
+  CHECK_EQ(platform_gpio_get(IRQ_PIN), 1);
+
+  // Arrived while nobody was waiting: the next wait returns at once
+  receive(2, 29);
+  CHECK(radio_wait_for_message(&radio, &state, 100));
+  CHECK_EQ(state.seconds, 29);
+}
+
+int main(void) {
+  RUN_TEST(test_nothing_pending);
+  RUN_TEST(test_drain_applies_newest);
+  RUN_TEST(test_stale_and_malformed);
+  RUN_TEST(test_irq_wakeup);
+  return TEST_RESULT();
+}
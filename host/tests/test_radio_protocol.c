@@ -0,0 +1,223 @@
+// radio_protocol.h: frame parsing and encoding, sequence tracking
+
+#include "../../include/radio_protocol.h"
+#include "test.h"
+
+static radio_message_t with_sequence(uint8_t sequence) {
+  radio_message_t message;
+  memset(&message, 0, sizeof(message));
+  message.sequence = sequence;
+  return message;
+}
+
+// Accept one message on its own; returns radio_sequence_process()'s result
+static int feed(radio_sequence_t *tracker, uint8_t sequence) {
+  radio_message_t message = with_sequence(sequence);
+  return radio_sequence_process(tracker, &message, 1);
+}
+
+static void test_parse_v1_records(void) {
+  // Play clock 30.0 s running, color FFA500 (the README example)
+  const uint8_t frame[] = {0xC1, 0x07, 0x01, 0x03, 0x01, 0x2C, 0x01, 0x04, 0x03, 0xFF, 0xA5, 0x00};
+  radio_message_t message;
+  CHECK(radio_protocol_parse(frame, sizeof(frame), &message));
+  CHECK_EQ(message.version, 1);
+  CHECK_EQ(message.sequence, 7);
+  CHECK_EQ(message.fields, RADIO_FIELD(RADIO_RECORD_PLAY_CLOCK) | RADIO_FIELD(RADIO_RECORD_COLOR));
+  CHECK_EQ(message.play_clock.tenths, 300);
+  CHECK_EQ(message.play_clock.flags, RADIO_CLOCK_RUNNING);
+  CHECK_EQ(message.seconds, 30);
+  CHECK_EQ(message.r, 0xFF);
+  CHECK_EQ(message.g, 0xA5);
+  CHECK_EQ(message.b, 0x00);
+}
+
+static void test_parse_started_second_and_blank(void) {
+  const uint8_t running[] = {0xC1, 0x01, 0x01, 0x03, 0x00, 0x5B, 0x01}; // 9.1 s
+  const uint8_t blank[] = {0xC1, 0x02, 0x01, 0x03, 0x00, 0x00, RADIO_CLOCK_BLANK};
+  radio_message_t message;
+  CHECK(radio_protocol_parse(running, sizeof(running), &message));
+  CHECK_EQ(message.seconds, 10);
+  CHECK(radio_protocol_parse(blank, sizeof(blank), &message));
+  CHECK_EQ(message.seconds, RADIO_PROTOCOL_BLANK_SECONDS);
+}
+
+static void test_parse_skips_unknown_records(void) {
+  // Unknown 0x30 record, color, pad, then garbage after the pad
+  const uint8_t frame[] = {0xC1, 0x01, 0x30, 0x02, 0xAA, 0xBB, 0x04, 0x03, 0x01, 0x02, 0x03, 0x00, 0x04, 0xFF};
+  radio_message_t message;
+  CHECK(radio_protocol_parse(frame, sizeof(frame), &message));
+  CHECK_EQ(message.fields, RADIO_FIELD(RADIO_RECORD_COLOR));
+  CHECK_EQ(message.r, 1);
+  CHECK_EQ(message.g, 2);
+  CHECK_EQ(message.b, 3);
+  CHECK_EQ(message.seconds, RADIO_PROTOCOL_BLANK_SECONDS); // No play clock record
+
+  // A known record longer than today's layout keeps its known prefix
+  const uint8_t longer[] = {0xC1, 0x01, 0x05, 0x02, 0x04, 0x99};
+  CHECK(radio_protocol_parse(longer, sizeof(longer), &message));
+  CHECK_EQ(message.period, 4);
+}
+
+static void test_parse_legacy(void) {
+  const uint8_t frame[] = {0x00, 0x1E, 0x10, 0x20, 0x30, 0x05};
+  radio_message_t message;
+  CHECK(radio_protocol_parse(frame, sizeof(frame), &message));
+  CHECK_EQ(message.version, 0);
+  CHECK_EQ(message.sequence, 5);
+  CHECK_EQ(message.seconds, 30);
+  CHECK_EQ(message.play_clock.tenths, 300);
+  CHECK_EQ(message.r, 0x10);
+  CHECK_EQ(message.g, 0x20);
+  CHECK_EQ(message.b, 0x30);
+  CHECK_EQ(message.fields, RADIO_FIELD(RADIO_RECORD_PLAY_CLOCK) | RADIO_FIELD(RADIO_RECORD_COLOR));
+
+  const uint8_t blank[] = {0x00, RADIO_PROTOCOL_BLANK_SECONDS, 0, 0, 0, 6};
+  CHECK(radio_protocol_parse(blank, sizeof(blank), &message));
+  CHECK_EQ(message.seconds, RADIO_PROTOCOL_BLANK_SECONDS);
+  CHECK_EQ(message.play_clock.flags, RADIO_CLOCK_BLANK);
+}
+
+static void test_parse_rejects_truncated(void) {
+  radio_message_t message;
+  const uint8_t legacy_short[] = {0x00, 0x1E, 0x10, 0x20, 0x30};
+  const uint8_t header_only[] = {0xC1};
+  const uint8_t record_header_cut[] = {0xC1, 0x01, 0x04};
+  const uint8_t record_value_cut[] = {0xC1, 0x01, 0x04, 0x03, 0x01, 0x02};
+  const uint8_t known_record_short[] = {0xC1, 0x01, 0x04, 0x02, 0x01, 0x02};
+  const uint8_t other_version[] = {0xC2, 0x01, 0x04, 0x03, 0x01, 0x02, 0x03};
+  CHECK(!radio_protocol_parse(legacy_short, sizeof(legacy_short), &message));
+  CHECK(!radio_protocol_parse(header_only, sizeof(header_only), &message));
+  CHECK(!radio_protocol_parse(record_header_cut, sizeof(record_header_cut), &message));
+  CHECK(!radio_protocol_parse(record_value_cut, sizeof(record_value_cut), &message));
+  CHECK(!radio_protocol_parse(known_record_short, sizeof(known_record_short), &message));
+  CHECK(!radio_protocol_parse(other_version, sizeof(other_version), &message));
+  CHECK(!radio_protocol_parse(header_only, 0, &message));
+
+  // An empty v1 frame is valid - nothing changes
+  const uint8_t empty[] = {0xC1, 0x09};
+  CHECK(radio_protocol_parse(empty, sizeof(empty), &message));
+  CHECK_EQ(message.fields, 0);
+}
+
+static void test_encode_round_trip(void) {
+  radio_message_t message = with_sequence(200);
+  message.fields = RADIO_FIELD(RADIO_RECORD_PLAY_CLOCK) | RADIO_FIELD(RADIO_RECORD_SHOT_CLOCK) |
+                   RADIO_FIELD(RADIO_RECORD_COLOR) | RADIO_FIELD(RADIO_RECORD_PERIOD) |
+                   RADIO_FIELD(RADIO_RECORD_COMMAND) | RADIO_FIELD(RADIO_RECORD_HOP);
+  message.play_clock = (radio_clock_t){250, RADIO_CLOCK_RUNNING};
+  message.shot_clock = (radio_clock_t){0, RADIO_CLOCK_BLANK};
+  message.r = 1;
+  message.g = 2;
+  message.b = 3;
+  message.period = 4;
+  message.command_clock = RADIO_RECORD_GAME_CLOCK;
+  message.command = RADIO_COMMAND_RESET;
+  message.hop_channel = 80;
+  message.hop_delay_ms = 600;
+
+  uint8_t frame[RADIO_PROTOCOL_MAX_FRAME];
+  size_t length = radio_protocol_encode(&message, frame, sizeof(frame));
+  CHECK_EQ(length, RADIO_PROTOCOL_HEADER_SIZE + 2 * 5 + 5 + 3 + 4 + 4);
+
+  radio_message_t parsed;
+  CHECK(radio_protocol_parse(frame, length, &parsed));
+  CHECK_EQ(parsed.sequence, 200);
+  CHECK_EQ(parsed.fields, message.fields);
+  CHECK_EQ(parsed.play_clock.tenths, 250);
+  CHECK_EQ(parsed.shot_clock.flags, RADIO_CLOCK_BLANK);
+  CHECK_EQ(parsed.seconds, 25);
+  CHECK_EQ(parsed.b, 3);
+  CHECK_EQ(parsed.period, 4);
+  CHECK_EQ(parsed.command_clock, RADIO_RECORD_GAME_CLOCK);
+  CHECK_EQ(parsed.command, RADIO_COMMAND_RESET);
+  CHECK_EQ(parsed.hop_channel, 80);
+  CHECK_EQ(parsed.hop_delay_ms, 600);
+
+  // All three clocks as well no longer fit one payload
+  message.fields |= RADIO_FIELD(RADIO_RECORD_GAME_CLOCK);
+  CHECK_EQ(radio_protocol_encode(&message, frame, sizeof(frame)), 0);
+
+  // Too small for the records, or for the header
+  CHECK_EQ(radio_protocol_encode(&message, frame, 10), 0);
+  CHECK_EQ(radio_protocol_encode(&message, frame, 1), 0);
+}
+
+static void test_sequence_wraparound(void) {
+  radio_sequence_t tracker;
+  radio_sequence_reset(&tracker);
+  CHECK_EQ(feed(&tracker, 254), 0);
+  CHECK_EQ(feed(&tracker, 255), 0);
+  CHECK_EQ(feed(&tracker, 0), 0);
+  CHECK_EQ(feed(&tracker, 1), 0);
+  CHECK_EQ(tracker.stats.gaps, 0);
+  CHECK_EQ(feed(&tracker, 3), 0);
+  CHECK_EQ(tracker.stats.gaps, 1);
+  CHECK_EQ(tracker.stats.lost, 1);
+  CHECK_EQ(tracker.stats.accepted, 5);
+
+  // A batch across the wrap is ordered by serial number arithmetic
+  radio_sequence_reset(&tracker);
+  feed(&tracker, 253);
+  radio_message_t batch[] = {with_sequence(0), with_sequence(254), with_sequence(255)};
+  CHECK_EQ(radio_sequence_process(&tracker, batch, 3), 0);
+  CHECK_EQ(tracker.last_sequence, 0);
+  CHECK_EQ(tracker.stats.reorders, 2);
+  CHECK_EQ(tracker.stats.gaps, 0);
+}
+
+static void test_sequence_duplicates_and_stale(void) {
+  radio_sequence_t tracker;
+  radio_sequence_reset(&tracker);
+  feed(&tracker, 10);
+  CHECK_EQ(feed(&tracker, 10), -1);
+  CHECK_EQ(tracker.stats.duplicates, 1);
+  CHECK_EQ(feed(&tracker, 9), -1); // Late, not a restart
+  CHECK_EQ(tracker.stats.reorders, 1);
+  CHECK_EQ(tracker.last_sequence, 10);
+
+  // Duplicate within a batch: the newest copy wins once
+  radio_message_t batch[] = {with_sequence(12), with_sequence(11), with_sequence(12)};
+  CHECK_EQ(radio_sequence_process(&tracker, batch, 3) >= 0, 1);
+  CHECK_EQ(tracker.last_sequence, 12);
+  CHECK_EQ(tracker.stats.duplicates, 2);
+  CHECK_EQ(tracker.stats.accepted, 3);
+}
+
+static void test_sequence_resync(void) {
+  radio_sequence_t tracker;
+  radio_sequence_reset(&tracker);
+  feed(&tracker, 100);
+  // A restarted transmitter counts from 0: stale until enough of them in a row
+  for (int i = 0; i < RADIO_SEQUENCE_RESYNC_FRAMES - 1; i++) {
+    CHECK_EQ(feed(&tracker, (uint8_t)i), -1);
+  }
+  CHECK_EQ(tracker.stats.resyncs, 0);
+  CHECK_EQ(feed(&tracker, RADIO_SEQUENCE_RESYNC_FRAMES - 1), 0);
+  CHECK_EQ(tracker.stats.resyncs, 1);
+  CHECK_EQ(tracker.last_sequence, RADIO_SEQUENCE_RESYNC_FRAMES - 1);
+  CHECK_EQ(feed(&tracker, RADIO_SEQUENCE_RESYNC_FRAMES), 0);
+
+  // A newer frame in between resets the run
+  feed(&tracker, 50);
+  feed(&tracker, 1);
+  feed(&tracker, 51);
+  for (int i = 0; i < RADIO_SEQUENCE_RESYNC_FRAMES - 1; i++) {
+    feed(&tracker, (uint8_t)(2 + i));
+  }
+  CHECK_EQ(tracker.stats.resyncs, 1);
+  CHECK_EQ(tracker.last_sequence, 51);
+}
+
+int main(void) {
+  RUN_TEST(test_parse_v1_records);
+  RUN_TEST(test_parse_started_second_and_blank);
+  RUN_TEST(test_parse_skips_unknown_records);
+  RUN_TEST(test_parse_legacy);
+  RUN_TEST(test_parse_rejects_truncated);
+  RUN_TEST(test_encode_round_trip);
+  RUN_TEST(test_sequence_wraparound);
+  RUN_TEST(test_sequence_duplicates_and_stale);
+  RUN_TEST(test_sequence_resync);
+  return TEST_RESULT();
+}
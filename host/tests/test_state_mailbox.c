@@ -0,0 +1,106 @@
+// state_mailbox.h: triple buffer between the radio and render tasks
+
+#include "../../include/state_mailbox.h"
+#include "test.h"
+#include <pthread.h>
+
+static SystemState state_with(uint16_t seconds) {
+  SystemState state;
+  memset(&state, 0, sizeof(state));
+  state.seconds = seconds;
+  state.sequence = (uint8_t)seconds;
+  return state;
+}
+
+static void test_take_order(void) {
+  state_mailbox_t mailbox;
+  SystemState initial = state_with(0);
+  state_mailbox_init(&mailbox, &initial);
+
+  // Nothing published yet
+  SystemState taken = state_with(999);
+  CHECK(!state_mailbox_take(&mailbox, &taken));
+  CHECK_EQ(taken.seconds, 999);
+
+  SystemState published = state_with(10);
+  state_mailbox_publish(&mailbox, &published);
+  CHECK(state_mailbox_take(&mailbox, &taken));
+  CHECK_EQ(taken.seconds, 10);
+
+  // Taken once only
+  CHECK(!state_mailbox_take(&mailbox, &taken));
+
+  published = state_with(11);
+  state_mailbox_publish(&mailbox, &published);
+  CHECK(state_mailbox_take(&mailbox, &taken));
+  CHECK_EQ(taken.seconds, 11);
+}
+
+static void test_newest_wins(void) {
+  state_mailbox_t mailbox;
+  SystemState initial = state_with(0);
+  state_mailbox_init(&mailbox, &initial);
+
+  // Intermediate states are skipped; slots recycle without the consumer
+  for (uint16_t seconds = 1; seconds <= 7; seconds++) {
+    SystemState published = state_with(seconds);
+    state_mailbox_publish(&mailbox, &published);
+  }
+  SystemState taken;
+  CHECK(state_mailbox_take(&mailbox, &taken));
+  CHECK_EQ(taken.seconds, 7);
+  CHECK(!state_mailbox_take(&mailbox, &taken));
+
+  // The slot the consumer holds is never overwritten by later publishes
+  SystemState published = state_with(8);
+  state_mailbox_publish(&mailbox, &published);
+  published = state_with(9);
+  state_mailbox_publish(&mailbox, &published);
+  CHECK_EQ(taken.seconds, 7);
+  CHECK(state_mailbox_take(&mailbox, &taken));
+  CHECK_EQ(taken.seconds, 9);
+}
+
+#define THREAD_PUBLISHES 200000
+
+static void *producer(void *arg) {
+  state_mailbox_t *mailbox = arg;
+  for (uint32_t i = 1; i <= THREAD_PUBLISHES; i++) {
+    SystemState published = state_with((uint16_t)i);
+    published.last_status_time = i; // Must always match seconds in a taken copy
+    state_mailbox_publish(mailbox, &published);
+  }
+  return NULL;
+}
+
+static void test_concurrent_publish(void) {
+  state_mailbox_t mailbox;
+  SystemState initial = state_with(0);
+  state_mailbox_init(&mailbox, &initial);
+
+  pthread_t thread;
+  CHECK(pthread_create(&thread, NULL, producer, &mailbox) == 0);
+
+  // Every state taken is complete and newer than the previous one
+  uint32_t last = 0, torn = 0, backwards = 0;
+  while (last < THREAD_PUBLISHES) {
+    SystemState taken;
+    if (!state_mailbox_take(&mailbox, &taken))
+      continue;
+    if ((uint16_t)taken.last_status_time != taken.seconds)
+      torn++;
+    if (taken.last_status_time <= last)
+      backwards++;
+    last = taken.last_status_time;
+  }
+  pthread_join(thread, NULL);
+  CHECK_EQ(torn, 0);
+  CHECK_EQ(backwards, 0);
+}
+
+int main(void) {
+  RUN_TEST(test_take_order);
+  RUN_TEST(test_newest_wins);
+  RUN_TEST(test_concurrent_publish);
+  return TEST_RESULT();
+}
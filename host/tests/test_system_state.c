@@ -0,0 +1,80 @@
+// system_state.h: applying decoded messages
+
+#include "../../include/system_state.h"
+#include "test.h"
+
+static radio_message_t parse(const uint8_t *frame, size_t length) {
+  radio_message_t message;
+  CHECK(radio_protocol_parse(frame, length, &message));
+  return message;
+}
+
+static void test_missing_fields_keep_their_value(void) {
+  SystemState state;
+  memset(&state, 0, sizeof(state));
+  const uint8_t full[] = {0xC1, 0x01, 0x01, 0x03, 0x01, 0x2C, 0x01, 0x04, 0x03, 0xFF, 0xA5, 0x00, 0x05, 0x01, 0x02};
+  radio_message_t message = parse(full, sizeof(full));
+  system_state_apply(&state, &message);
+  CHECK_EQ(state.seconds, 30);
+  CHECK_EQ(state.g, 0xA5);
+  CHECK_EQ(state.period, 2);
+  CHECK_EQ(state.protocol_version, 1);
+
+  // Play clock only: color and period stay, fields accumulate
+  const uint8_t clock_only[] = {0xC1, 0x02, 0x01, 0x03, 0x00, 0x64, 0x01, 0x02, 0x03, 0x00, 0x32, 0x00};
+  message = parse(clock_only, sizeof(clock_only));
+  system_state_apply(&state, &message);
+  CHECK_EQ(state.seconds, 10);
+  CHECK_EQ(state.sequence, 2);
+  CHECK_EQ(state.r, 0xFF);
+  CHECK_EQ(state.period, 2);
+  CHECK_EQ(state.game_clock.tenths, 50);
+  CHECK_EQ(state.fields, RADIO_FIELD(RADIO_RECORD_PLAY_CLOCK) | RADIO_FIELD(RADIO_RECORD_COLOR) |
+                             RADIO_FIELD(RADIO_RECORD_PERIOD) | RADIO_FIELD(RADIO_RECORD_GAME_CLOCK));
+
+  // A legacy frame after v1 ones
+  const uint8_t legacy[] = {0x00, 0x09, 0x01, 0x02, 0x03, 0x03};
+  message = parse(legacy, sizeof(legacy));
+  system_state_apply(&state, &message);
+  CHECK_EQ(state.protocol_version, 0);
+  CHECK_EQ(state.seconds, 9);
+  CHECK_EQ(state.b, 3);
+}
+
+static void test_commands_override_run_flag(void) {
+  SystemState state;
+  memset(&state, 0, sizeof(state));
+
+  // Stop for the play clock while its record says running
+  const uint8_t stop[] = {0xC1, 0x01, 0x01, 0x03, 0x00, 0x64, RADIO_CLOCK_RUNNING,
+                          0x06, 0x02, RADIO_RECORD_PLAY_CLOCK, RADIO_COMMAND_STOP};
+  radio_message_t message = parse(stop, sizeof(stop));
+  system_state_apply(&state, &message);
+  CHECK_EQ(state.play_clock.flags & RADIO_CLOCK_RUNNING, 0);
+  CHECK_EQ(state.command, RADIO_COMMAND_STOP);
+  CHECK_EQ(state.command_clock, RADIO_RECORD_PLAY_CLOCK);
+
+  // Run for the shot clock keeps the play clock as it is
+  const uint8_t run[] = {0xC1, 0x02, 0x06, 0x02, RADIO_RECORD_SHOT_CLOCK, RADIO_COMMAND_RUN};
+  message = parse(run, sizeof(run));
+  system_state_apply(&state, &message);
+  CHECK(state.shot_clock.flags & RADIO_CLOCK_RUNNING);
+  CHECK_EQ(state.play_clock.flags & RADIO_CLOCK_RUNNING, 0);
+
+  // A command lasts one message; unknown clock records are ignored
+  const uint8_t none[] = {0xC1, 0x03};
+  message = parse(none, sizeof(none));
+  system_state_apply(&state, &message);
+  CHECK_EQ(state.command, RADIO_COMMAND_NONE);
+  const uint8_t bad_clock[] = {0xC1, 0x04, 0x06, 0x02, RADIO_RECORD_COLOR, RADIO_COMMAND_RUN};
+  message = parse(bad_clock, sizeof(bad_clock));
+  system_state_apply(&state, &message);
+  CHECK_EQ(state.command, RADIO_COMMAND_RUN);
+  CHECK_EQ(state.r, 0);
+}
+
+int main(void) {
+  RUN_TEST(test_missing_fields_keep_their_value);
+  RUN_TEST(test_commands_override_run_flag);
+  return TEST_RESULT();
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "driver/gpio.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Application event queue. Everything the render task reacts to besides its
+// frame deadlines arrives here: new radio state and debounced button events.
+// The button is interrupt driven: an edge masks the pin and starts a debounce
+// timer (esp_timer), whose callback reads the settled level, posts the event
+// and unmasks the pin. A second timer posts the long press while it is held,
+// so neither depends on how often the render task runs.
+
+#define APP_EVENT_QUEUE_LENGTH 16
+#define APP_EVENT_DEBOUNCE_MS 50
+#define APP_EVENT_LONG_PRESS_MS 2000
+
+typedef enum {
+  APP_EVENT_STATE,       // New SystemState in the mailbox (radio task)
+  APP_EVENT_BUTTON_DOWN, // Debounced press
+  APP_EVENT_BUTTON_LONG, // Held for APP_EVENT_LONG_PRESS_MS, once per press
+  APP_EVENT_BUTTON_UP,   // Debounced release; long_press if BUTTON_LONG came first
+} app_event_type_t;
+
+typedef struct {
+  uint8_t type;    // app_event_type_t
+  bool long_press; // BUTTON_UP only
+  uint32_t time_ms; // platform_millis() when it happened
+} app_event_t;
+
+// Queue, and the button on an active-low input (GPIO_NUM_NC for none)
+bool app_events_init(gpio_num_t button_pin);
+
+// Never blocks; false if the queue is full and the event was dropped. A state
+// event already waiting in the queue stands for a new one.
+bool app_events_post(app_event_type_t type);
+
+// Next event, waiting up to timeout_ms (0 polls, UINT32_MAX waits forever)
+bool app_events_wait(app_event_t *event, uint32_t timeout_ms);
+
+// Debounced button state
+bool app_events_button_held(void);
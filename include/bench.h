@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "display_render.h"
+
+// Micro-benchmarks of the render and transmit paths: framebuffer fills, digit
+// drawing, animation frames, wire map builds, the WS2815 bit encoder and radio
+// payload parsing, swept over strip lengths and digit counts. Timed with
+// platform_cycles(), so the same suite runs on target and on the host. Results
+// are CSV lines; a stored set of them is the baseline a new run is checked
+// against. Platform-independent, builds on the host as well.
+
+#define BENCH_NAME_LEN 24
+#define BENCH_MAX_LEDS 1800
+#define BENCH_MAX_RESULTS 48
+#define BENCH_TOLERANCE_PCT 25 // Default slowdown over the baseline that counts as a regression
+#define BENCH_CSV_HEADER "bench,leds,digits,iterations,ns_per_op"
+
+typedef struct {
+  char name[BENCH_NAME_LEN];
+  uint16_t leds;       // Strip length of the case, 0 if it doesn't depend on one
+  uint8_t digits;      // Digit count of the case, 0 if it doesn't depend on one
+  uint32_t iterations; // Per timed batch
+  uint32_t ns_per_op;  // Fastest batch
+} bench_result_t;
+
+// WS2815 bit encoder under test: size bytes (whole pixels) through the wire map
+// into 8 RMT symbol words per byte. The firmware passes its RMT symbol
+// encoder, the host a mock of it.
+typedef void (*bench_encode_fn)(const uint8_t *data, size_t size, const wire_map_t *map, uint32_t *symbols);
+
+// Run every case; returns the number of results written
+size_t bench_run_all(bench_encode_fn encode, bench_result_t *results, size_t max_results);
+
+// One CSV line without the newline, and back; parsing fails on the header and
+// on anything that isn't a result line (e.g. other log output)
+void bench_format(const bench_result_t *result, char *line, size_t size);
+bool bench_parse(const char *line, bench_result_t *result);
+
+// Baseline entry for the same case (name, leds and digits), NULL if there is none
+const bench_result_t *bench_find(const bench_result_t *baseline, size_t count, const bench_result_t *result);
+
+// True if result is more than tolerance_pct slower than baseline
+bool bench_regressed(const bench_result_t *result, const bench_result_t *baseline, uint32_t tolerance_pct);
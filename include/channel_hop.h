@@ -0,0 +1,132 @@
+#pragma once
+
+#include "radio_protocol.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// RF channel survey and coordinated channel hopping. Platform-independent:
+// the nRF24 access lives in radio_comm.c, times are platform_micros() values.
+//
+// Survey: repeated sweeps of the nRF24 received power detector (RPD, set when
+// a channel carries more than -64 dBm) give a moving average of how often each
+// channel is busy, so interference that comes and goes ages out.
+//
+// Hopping: controller and clock share a hop set. The controller tracks its
+// frame loss from missing ACKs; when it rises, it picks the cleanest channel
+// of the set from its survey and announces it in RADIO_RECORD_HOP. Until a
+// frame carrying the announcement is ACKed, every frame restates the full
+// delay, so on a channel losing most frames the announcement runs as long as
+// it takes to reach the clock; the ACK fixes the move time, and later frames
+// count the delay down to it. If no frame at all is ACKed for the clock's
+// search silence, the clock is searching already and the controller moves at
+// once. The clock follows any announcement it hears. A clock that missed them
+// all stops hearing the controller, and after a short silence searches the
+// set, cleanest channels by its own survey first, until frames arrive again.
+
+#define CHANNEL_SURVEY_CHANNELS 126 // nRF24 RF_CH 0..125, 2400 + n MHz
+#define CHANNEL_SURVEY_WEIGHT 4     // A reading moves the average 1/4 of the way
+#define CHANNEL_HOP_MAX_SET 16
+
+#define CHANNEL_HOP_WINDOW_FRAMES 32  // Controller loss window, the bits of channel_hop_tx_t.history
+#define CHANNEL_HOP_MIN_FRAMES 16     // Frames in the window before loss counts
+#define CHANNEL_HOP_LOSS_PERCENT 25   // Loss that moves the link
+#define CHANNEL_HOP_BURST_FRAMES 4    // Consecutive losses that move the link at once, while the clock still listens
+#define CHANNEL_HOP_MIN_GAIN 20       // Survey score a move must gain (loss may be the clock, not the channel)
+#define CHANNEL_HOP_MIN_SPACING 22    // Preferred distance of a move, MHz - a Wi-Fi channel's width
+#define CHANNEL_HOP_ANNOUNCE_MS 600   // Move delay after the clock ACKed the announcement
+#define CHANNEL_HOP_HOLDOFF_MS 5000   // No further move this soon after one
+#define CHANNEL_HOP_SEARCH_AFTER_MS 1500 // Clock silence before it searches
+#define CHANNEL_HOP_DWELL_MS 350      // Search time per channel, a few controller frames
+
+typedef struct {
+  uint16_t busy[CHANNEL_SURVEY_CHANNELS]; // Moving average of RPD set, UINT16_MAX = always
+  bool sampled[CHANNEL_SURVEY_CHANNELS];
+  uint32_t sweeps;
+} channel_survey_t;
+
+void channel_survey_reset(channel_survey_t *survey);
+
+// One RPD reading
+void channel_survey_add(channel_survey_t *survey, uint8_t channel, bool busy);
+
+// Share of readings with RPD set, 0..100 (0 when never sampled)
+uint8_t channel_survey_occupancy(const channel_survey_t *survey, uint8_t channel);
+
+// Lower is cleaner: twice the channel's occupancy plus each neighbour's, as a
+// 1-2 MHz wide signal spills over
+uint16_t channel_survey_score(const channel_survey_t *survey, uint8_t channel);
+
+// Cleanest channel of a set other than exclude (ties keep set order)
+uint8_t channel_survey_best(const channel_survey_t *survey, const uint8_t *channels, uint8_t count,
+                            uint8_t exclude);
+
+// Occupancy as one character per channel ('.' clear, '1'..'9' tens of percent),
+// NUL-terminated; map needs CHANNEL_SURVEY_CHANNELS + 1 bytes
+void channel_survey_format(const channel_survey_t *survey, char *map);
+
+typedef struct {
+  uint32_t hops;          // Channel changes that followed an announcement
+  uint32_t announcements; // Frames carrying one (clock: heard, controller: sent)
+  uint32_t searches;      // Clock: silences that started a search
+  uint32_t search_steps;  // Clock: channels tried while searching
+  uint32_t loss_percent;  // Controller: loss over the window at the last frame
+  uint32_t unconfirmed;   // Controller: moves made with no announcement ACKed (clock searching)
+} channel_hop_stats_t;
+
+// Clock side
+typedef struct {
+  uint8_t channels[CHANNEL_HOP_MAX_SET]; // Search order
+  uint8_t count;
+  uint8_t channel;         // Tuned channel
+  bool hop_pending;
+  uint8_t hop_channel;
+  int64_t hop_at_us;
+  int64_t last_rx_us;      // Last frame heard
+  bool searching;
+  bool survey_due;         // A search started - rank the set if a survey can be run
+  uint8_t search_index;
+  int64_t dwell_end_us;
+  channel_hop_stats_t stats;
+} channel_hop_rx_t;
+
+void channel_hop_rx_init(channel_hop_rx_t *rx, const uint8_t *channels, uint8_t count, uint8_t channel,
+                         int64_t now_us);
+
+// A frame arrived on the tuned channel; follows its announcement, if any
+void channel_hop_rx_on_message(channel_hop_rx_t *rx, const radio_message_t *message, int64_t rx_us);
+
+// Channel to be tuned to at now_us: a due announced move, or the next search
+// step after a silence. *next_us is when the answer may change next.
+uint8_t channel_hop_rx_poll(channel_hop_rx_t *rx, int64_t now_us, int64_t *next_us);
+
+// Search cleanest channels first; clears survey_due
+void channel_hop_rx_rank(channel_hop_rx_t *rx, const channel_survey_t *survey);
+
+// Controller side
+typedef struct {
+  uint8_t channels[CHANNEL_HOP_MAX_SET];
+  uint8_t count;
+  uint8_t channel;       // Channel frames are sent on
+  uint32_t history;      // Bit per frame, 1 = lost, newest in bit 0
+  uint8_t history_frames;
+  bool announcing;
+  bool confirmed;        // A frame carrying the announcement was ACKed, hop_at_us is fixed
+  uint8_t hop_channel;
+  int64_t hop_at_us;
+  int64_t last_ack_us;
+  int64_t holdoff_until_us;
+  channel_hop_stats_t stats;
+} channel_hop_tx_t;
+
+void channel_hop_tx_init(channel_hop_tx_t *tx, const uint8_t *channels, uint8_t count, uint8_t channel,
+                         int64_t now_us);
+
+// Outcome of a sent frame. When loss over the window passes
+// CHANNEL_HOP_LOSS_PERCENT (or CHANNEL_HOP_BURST_FRAMES in a row are lost) and the survey has a clearly cleaner channel, it is
+// announced; an ACKed announcing frame confirms the move.
+void channel_hop_tx_on_frame(channel_hop_tx_t *tx, bool acked, const channel_survey_t *survey, int64_t now_us);
+
+// Moves once the confirmed delay is over (or the clock is searching), then adds
+// the announcement (if one is running) to the next frame. Returns the channel
+// to send it on.
+uint8_t channel_hop_tx_prepare(channel_hop_tx_t *tx, radio_message_t *message, int64_t now_us);
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Local time engine: free-runs the shown clock's countdown between radio packets.
+// Platform-independent, builds on the host as well.
+//
+// The controller only sends whole seconds. A packet whose value is one below
+// the previous one marks a second boundary; those boundaries set the phase of
+// the local countdown and, over several seconds, the controller's clock rate.
+// Every other packet only bounds the countdown from above. Packets that carry
+// the controller's run state start and stop the countdown directly; without
+// it, a countdown that runs clearly past the value still being sent means the
+// clock was stopped.
+// Corrections are slewed in over CLOCK_ENGINE_SLEW_MS instead of jumping, except for real
+// jumps (clock reset/set) which are taken immediately.
+
+#define CLOCK_ENGINE_BLANK UINT16_MAX      // seconds value that blanks the display
+#define CLOCK_ENGINE_SLEW_MS 250           // Window for absorbing a phase correction
+#define CLOCK_ENGINE_SNAP_MS 1500          // Larger errors are applied at once
+#define CLOCK_ENGINE_STOP_GRACE_MS 300     // Same value this long past the expected flip = clock stopped
+#define CLOCK_ENGINE_RATE_MIN_SPAN_MS 5000 // Boundary span needed for a drift estimate
+#define CLOCK_ENGINE_RATE_SPAN_FACTOR 100  // ... and at least this many times the flip time uncertainty
+#define CLOCK_ENGINE_RATE_LIMIT 0.02f      // Largest accepted drift (+/- 2%)
+
+typedef enum {
+  CLOCK_RUN_UNKNOWN, // Legacy packets - inferred from the values
+  CLOCK_RUN_STOPPED,
+  CLOCK_RUN_RUNNING,
+} clock_run_state_t;
+
+typedef struct {
+  uint32_t packets;
+  uint32_t boundaries;  // Second flips observed in packets
+  uint32_t corrections; // Phase corrections slewed in
+  uint32_t snaps;       // Jumps taken at once
+  int32_t last_error_ms; // Local countdown minus packet at the last boundary
+} clock_engine_stats_t;
+
+typedef struct {
+  bool valid;    // At least one packet received
+  bool running;  // Counting down locally
+  bool blank;
+  uint16_t packet_seconds;
+
+  // Countdown model: remaining_ms(t) = anchor_ms - rate * (t - anchor_us) / 1000 + slew(t)
+  int64_t anchor_us;
+  int32_t anchor_ms;
+  float rate; // Controller ms per local ms
+
+  // Pending phase correction, applied linearly from slew_start_us
+  int32_t slew_ms;
+  int64_t slew_start_us;
+
+  // Drift estimate: first boundary of the current run. The flip happened
+  // somewhere in the packet gap before it; rate_base_us is the middle.
+  bool have_rate_base;
+  int64_t rate_base_us;
+  int64_t rate_base_gap_us;
+  uint16_t rate_base_seconds;
+
+  clock_engine_stats_t stats;
+} clock_engine_t;
+
+void clock_engine_init(clock_engine_t *engine);
+
+// Feed a received (new) message; now_us is its arrival time
+void clock_engine_on_packet(clock_engine_t *engine, uint16_t seconds, clock_run_state_t run_state, int64_t now_us);
+
+// Seconds to display at now_us, CLOCK_ENGINE_BLANK when blanked
+uint16_t clock_engine_seconds(const clock_engine_t *engine, int64_t now_us);
+
+// Microseconds until the displayed value next changes on its own, -1 if it won't
+int64_t clock_engine_us_to_next_flip(const clock_engine_t *engine, int64_t now_us);
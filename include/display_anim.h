@@ -0,0 +1,80 @@
+#pragma once
+
+#include "display_layout.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Segment transitions and effects for digit changes. Each layout element
+// (segment or indicator) carries its own transition, started only when its
+// lit state changes, so a frame redraws just the elements that are moving.
+// Levels and timing are fixed point: 0..ANIM_LEVEL_FULL, progress in the same
+// scale. Platform-independent, builds on the host as well.
+
+#define ANIM_LEVEL_FULL 256
+#define ANIM_PULSE_FLOOR 64 // Lowest pulse level, so a pulsing digit never goes dark
+
+typedef enum {
+  ANIM_TRANSITION_CUT,       // Switch at once
+  ANIM_TRANSITION_CROSSFADE, // Fade changing segments in and out
+  ANIM_TRANSITION_WIPE,      // Grow / shrink changing segments along their run
+} anim_transition_t;
+
+typedef enum {
+  ANIM_EFFECT_NONE,
+  ANIM_EFFECT_FLASH, // Lit elements on for half the period, off for the other half
+  ANIM_EFFECT_PULSE, // Lit elements ramp between ANIM_PULSE_FLOOR and full
+} anim_effect_t;
+
+typedef struct {
+  bool target;      // Lit once the transition ends
+  uint16_t from;    // Transition level when it started
+  int64_t start_us; // Transition start
+  bool moving;
+  uint32_t drawn;   // What the framebuffer shows (draw key), ANIM_NOT_DRAWN if unknown
+} anim_element_t;
+
+#define ANIM_NOT_DRAWN UINT32_MAX
+
+typedef struct {
+  const compiled_layout_t *layout;
+  anim_transition_t transition;
+  uint32_t transition_us;
+  anim_effect_t effect;
+  uint32_t effect_period_us;
+  int64_t effect_start_us;
+  uint8_t lit_rgb[3];
+  uint8_t off_rgb[3];
+  uint8_t moving_count;
+  uint8_t lit_count; // Fitted elements whose target is lit
+  anim_element_t elements[LAYOUT_ELEMENTS];
+} anim_engine_t;
+
+// All elements dark and not drawn
+void anim_init(anim_engine_t *anim, const compiled_layout_t *layout);
+
+void anim_set_transition(anim_engine_t *anim, anim_transition_t transition, uint32_t duration_us);
+void anim_set_effect(anim_engine_t *anim, anim_effect_t effect, uint32_t period_us, int64_t now_us);
+
+// Wire colors for lit and dark LEDs; a change redraws every element
+void anim_set_colors(anim_engine_t *anim, const uint8_t lit[3], const uint8_t off[3]);
+
+// The framebuffer already shows mask at full level (drawn by someone else)
+void anim_sync(anim_engine_t *anim, uint64_t mask);
+
+// New lit elements; those whose state changes start a transition from where they are
+void anim_set_mask(anim_engine_t *anim, uint64_t mask, int64_t now_us);
+
+// Draw the frame at now_us into an RGB framebuffer - only elements whose look
+// changed are written. Returns true if any byte changed; sum_delta as render_fill().
+bool anim_render(anim_engine_t *anim, uint8_t *pixels, int64_t now_us, int32_t *sum_delta);
+
+// True when transitions or an effect are configured, i.e. updates need frames
+static inline bool anim_enabled(const anim_engine_t *anim) {
+  return anim->transition != ANIM_TRANSITION_CUT || anim->effect != ANIM_EFFECT_NONE;
+}
+
+// Nothing moving, and no effect or nothing lit for it to act on: the
+// framebuffer shows the plain glyph and stays that way
+static inline bool anim_settled(const anim_engine_t *anim) {
+  return anim->moving_count == 0 && (anim->effect == ANIM_EFFECT_NONE || anim->lit_count == 0);
+}
@@ -1,39 +1,69 @@
 #pragma once
 
+#include "display_anim.h"
+#include "display_layout.h"
+#include "display_render.h"
+#include "led_transport.h"
+#include "power_limit.h"
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
 // Forward declarations
 typedef struct led_strip_s led_strip_t;
-struct rmt_channel_t;
-typedef struct rmt_channel_t *rmt_channel_handle_t;
-struct rmt_encoder_t;
-typedef struct rmt_encoder_t *rmt_encoder_handle_t;
 
 // WS2815 LED strip configuration for Play Clock
-#define LED_COUNT 900 // Approximate total LEDs for 2 digits
+#define LED_COUNT 900 // Framebuffer capacity (all chains); the layout decides how many are used
 #define LED_STRIP_PIN GPIO_NUM_13 // Data pin for WS2815 LED strip
 
-// 7-segment display configuration for Play Clock (2 digits)
-#define PLAY_CLOCK_DIGITS 2
-#define SEGMENTS_PER_DIGIT 7
+// Default output backend (see led_transport.h); display_begin_with_transport() picks one at init
+#define DISPLAY_TRANSPORT LED_TRANSPORT_RMT
 
-// Play Clock dimensions: 2 × 100 cm digits
-// LED segments: ~30 LEDs tall per vertical, ~15 LEDs horizontal
-#define LEDS_PER_SEGMENT_VERTICAL 30
-#define LEDS_PER_SEGMENT_HORIZONTAL 15
+// Output chains: each digit can hang off its own GPIO/RMT channel. All chains
+// start together (RMT sync manager), so frame time is bounded by the longest one.
+// Example, one chain per digit on GPIO 13 and 14:
+//   DISPLAY_OUTPUT_COUNT 2, DISPLAY_OUTPUT_PINS {GPIO_NUM_13, GPIO_NUM_14},
+//   DISPLAY_OUTPUT_STRIP_LEDS {450, 450}, DISPLAY_DIGIT_OUTPUTS {0, 1}, DISPLAY_DIGIT_BASES {0, 0}
+#define DISPLAY_MAX_OUTPUTS LAYOUT_MAX_OUTPUTS
+#define DISPLAY_OUTPUT_COUNT 1
+#define DISPLAY_OUTPUT_PINS {LED_STRIP_PIN}   // Data pin per output
+#define DISPLAY_OUTPUT_STRIP_LEDS {LED_COUNT} // Physical LEDs per chain, total <= LED_COUNT
 
-// Segment indices for 7-segment display
-typedef enum {
-  SEGMENT_A = 0, // Top horizontal
-  SEGMENT_B = 1, // Upper right vertical
-  SEGMENT_C = 2, // Lower right vertical
-  SEGMENT_D = 3, // Bottom horizontal
-  SEGMENT_E = 4, // Lower left vertical
-  SEGMENT_F = 5, // Upper left vertical
-  SEGMENT_G = 6  // Middle horizontal
-} segment_t;
+// Built-in layout (display_layout_default()), used unless one is stored in NVS
+#define DISPLAY_DIGIT_COUNT 2
+#define DISPLAY_DIGIT_OUTPUTS {0, 0}     // Output chain carrying each digit
+#define DISPLAY_DIGIT_BASES {0, 165}     // First LED of each digit on its chain
+#define DISPLAY_SEPARATOR_LEDS {0, 0, 0} // Colon: output, first LED, count (0 = none)
+
+// How display_set_time() shows a value (display_set_format() at runtime)
+#define DISPLAY_TIME_FORMAT RENDER_FORMAT_PLAIN
+#define DISPLAY_SUPPRESS_ZEROS 0 // 1 shows " 5" instead of "05"
+
+// Example, MM:SS game clock with a 16 LED colon after the minutes:
+//   DISPLAY_DIGIT_COUNT 4, DISPLAY_DIGIT_OUTPUTS {0, 0, 0, 0}, DISPLAY_DIGIT_BASES {0, 165, 346, 511},
+//   DISPLAY_SEPARATOR_LEDS {0, 330, 16}, DISPLAY_TIME_FORMAT RENDER_FORMAT_MMSS, DISPLAY_SUPPRESS_ZEROS 1
+
+// Digit change transition (display_set_transition() at runtime); ANIM_TRANSITION_CUT switches at once
+#define DISPLAY_TRANSITION ANIM_TRANSITION_CROSSFADE
+#define DISPLAY_TRANSITION_MS 120
+
+// Supply budget for the strips. A WS2815 LED draws about 5 mA per channel at
+// full duty plus a small idle current; frames estimated above the budget are
+// dimmed in proportion at once and brought back up gradually.
+#define DISPLAY_POWER_BUDGET_MA 5500   // 6 A supply, with headroom
+#define DISPLAY_POWER_CHANNEL_UA 5000  // One channel at full duty
+#define DISPLAY_POWER_IDLE_UA 1000     // Per LED, dark
+#define DISPLAY_POWER_RELEASE_STEP 4   // Limit recovery per frame (of POWER_LIMIT_FULL)
+
+// Channel order on the wire. The WS2815 datasheet gives GRB, but strips vary;
+// RGB is what this firmware has always sent.
+#define DISPLAY_COLOR_ORDER COLOR_ORDER_RGB
+
+// Assemble glyph frames from pre-encoded RMT symbol runs instead of bit-encoding led_buffer
+#define DISPLAY_SYMBOL_CACHE 1
+
+// Digits the driver can hold; the layout sets how many are fitted
+#define DISPLAY_MAX_DIGITS LAYOUT_MAX_DIGITS
 
 // Display modes
 typedef enum {
@@ -43,35 +73,45 @@ typedef enum {
   DISPLAY_MODE_ERROR
 } display_mode_t;
 
-// Color structure
+// One LED chain on its own data pin; owns a contiguous slice of the framebuffer
 typedef struct {
-  uint8_t r, g, b;
-} color_t;
+  gpio_num_t gpio_num;
+  uint16_t first_led;   // Framebuffer index of the chain's first LED
+  uint16_t strip_leds;  // Physical LEDs on the chain
+  uint16_t active_leds; // LEDs used by the layout on this chain
+  uint16_t tx_leds;     // LEDs sent per frame (whole chain until it has been blanked once)
+  led_transport_t *transport;
+} display_output_t;
 
-// Segment LED ranges for 2-digit play clock
-typedef struct {
-  uint16_t start;
-  uint16_t count;
-} segment_range_t;
-
-// Play clock display structure - displays seconds (SS) only
+// Seven-segment clock/score display - any digit count and separator the layout describes
 typedef struct {
   bool initialized;
   display_mode_t current_mode;
   uint32_t last_update_time;
+  uint32_t last_transmit_time;
+
+  // Highest framebuffer LED index (exclusive) used by the segment layout
+  uint16_t active_led_count;
+
+  // Pipeline timing: time spent in display_update() and wire time of the last frame
+  uint32_t submit_us;
+  volatile uint32_t frame_us;
 
   // LED strip handle
   led_strip_t *led_strip;
   
-  // RMT handles for WS2815 communication
-  rmt_channel_handle_t rmt_channel;
-  rmt_encoder_handle_t rmt_encoder;
+  // Output chains for WS2815 communication
+  display_output_t outputs[DISPLAY_MAX_OUTPUTS];
+  uint8_t output_count;
   
   // Brightness control (0-255)
   uint8_t brightness;
+  display_calibration_t calibration;
 
-  // Segment LED ranges for 2-digit play clock
-  segment_range_t segments[PLAY_CLOCK_DIGITS][SEGMENTS_PER_DIGIT];
+  // Segment, indicator and glyph spans in framebuffer positions, and the
+  // layout they were compiled from (stored or built-in)
+  compiled_layout_t layout;
+  display_layout_t layout_source;
 
   // Color definitions
   color_t color_off;
@@ -79,22 +119,54 @@ typedef struct {
   color_t color_warning;
   color_t color_error;
   
+  // Value formatting for display_set_time()
+  render_format_t format;
+  bool suppress_zeros;
+
   // Current display state
-  uint8_t current_digits[PLAY_CLOCK_DIGITS];
+  uint8_t current_digits[DISPLAY_MAX_DIGITS]; // RENDER_DIGIT_BLANK when dark
+  uint64_t segment_mask; // Lit segments, bit (digit * SEGMENTS_PER_DIGIT + segment), then indicators
+  uint8_t lit_rgb[3];    // Framebuffer color of the lit segments
 } PlayClockDisplay;
 
 // Function declarations
 bool display_begin(PlayClockDisplay *display);
-void display_set_time(PlayClockDisplay *display, uint16_t seconds);
+bool display_begin_with_transport(PlayClockDisplay *display, led_transport_kind_t transport_kind);
+void display_set_time(PlayClockDisplay *display, uint32_t value);
+void display_set_digits(PlayClockDisplay *display, const uint8_t *digits, bool separator);
+void display_set_blank(PlayClockDisplay *display);
+void display_set_format(PlayClockDisplay *display, render_format_t format, bool suppress_zeros);
+void display_set_transition(PlayClockDisplay *display, anim_transition_t transition, uint32_t duration_ms);
+void display_set_effect(PlayClockDisplay *display, anim_effect_t effect, uint32_t period_ms);
+
+// Draw the next animation frame into the framebuffer (sent by display_update()).
+// Returns true while transitions or an effect are running.
+bool display_animate(PlayClockDisplay *display);
 void display_set_color(PlayClockDisplay *display, uint8_t r, uint8_t g, uint8_t b);
 void display_set_run_mode(PlayClockDisplay *display);
 void display_set_stop_mode(PlayClockDisplay *display);
 void display_set_reset_mode(PlayClockDisplay *display);
 void display_show_error(PlayClockDisplay *display);
 void display_update(PlayClockDisplay *display);
+void display_flush(PlayClockDisplay *display);
+// True while the strip shows a dark frame and nothing new is drawn or animating:
+// display_update() sends nothing then, not even keepalives
+bool display_is_idle(PlayClockDisplay *display);
+void display_get_transport_stats(PlayClockDisplay *display, led_transport_stats_t *stats);
+void display_get_power_stats(PlayClockDisplay *display, power_limit_stats_t *stats);
 void display_clear(PlayClockDisplay *display);
 void display_set_brightness(PlayClockDisplay *display, uint8_t brightness);
+void display_set_calibration(PlayClockDisplay *display, const display_calibration_t *calibration);
 void display_set_segment(PlayClockDisplay *display, uint8_t digit, segment_t segment, bool enable);
+void display_set_indicator(PlayClockDisplay *display, uint8_t indicator, bool enable);
+
+// Store a layout in NVS for the next boot (NULL returns to the built-in one).
+// The layout is validated against the output chains first. Installers edit and
+// store it from the serial console (layout_console.h).
+bool display_store_layout(PlayClockDisplay *display, const display_layout_t *layout);
+// Validate a layout against the output chains without storing it; NULL if it
+// is fine, otherwise what is wrong
+const char *display_check_layout(PlayClockDisplay *display, const display_layout_t *layout);
 void display_test_pattern(PlayClockDisplay *display);
 bool display_connection_test(PlayClockDisplay *display);
 void display_set_all_white(PlayClockDisplay *display);
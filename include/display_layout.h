@@ -0,0 +1,122 @@
+#pragma once
+
+#include "display_render.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Physical LED layout as data. A display_layout_t describes the wiring: where
+// each digit starts on which output chain, where each segment runs relative to
+// its digit, and extra indicators (colon, dots). It is compiled once at boot
+// into absolute framebuffer spans, with the spans of every glyph sorted and
+// merged, so drawing a digit is a walk over a few precomputed spans.
+// Platform-independent, builds on the host as well.
+
+#define LAYOUT_VERSION 1
+#define LAYOUT_MAX_DIGITS 6
+#define LAYOUT_MAX_INDICATORS 4
+#define LAYOUT_MAX_OUTPUTS 4
+#define LAYOUT_GLYPHS 10 // Digit values 0-9
+#define LAYOUT_SEPARATOR 0 // Indicator lit as the MM:SS colon
+
+// Elements are numbered like segment mask bits: digit * SEGMENTS_PER_DIGIT +
+// segment, then the indicators after the segments of every possible digit
+#define LAYOUT_INDICATOR_BIT(indicator) (LAYOUT_MAX_DIGITS * SEGMENTS_PER_DIGIT + (indicator))
+#define LAYOUT_ELEMENTS LAYOUT_INDICATOR_BIT(LAYOUT_MAX_INDICATORS)
+
+typedef struct {
+  uint16_t start;   // LED offset from the digit base
+  uint16_t count;   // 0 = segment not fitted
+  uint8_t reversed; // Data runs against the drawing direction (right to left / bottom up)
+} layout_segment_t;
+
+typedef struct {
+  uint8_t output; // Output chain
+  uint16_t base;  // First LED of the digit on its chain
+  layout_segment_t segments[SEGMENTS_PER_DIGIT];
+} layout_digit_t;
+
+typedef struct {
+  uint8_t output;
+  uint16_t start; // LED offset on the chain
+  uint16_t count;
+} layout_indicator_t;
+
+// Stored as a blob (NVS) - bump LAYOUT_VERSION when changing it
+typedef struct {
+  uint16_t version;
+  uint8_t digit_count;
+  uint8_t indicator_count;
+  layout_digit_t digits[LAYOUT_MAX_DIGITS];
+  layout_indicator_t indicators[LAYOUT_MAX_INDICATORS];
+} display_layout_t;
+
+// Output chain geometry the layout is compiled against
+typedef struct {
+  uint16_t first_led; // Framebuffer index of the chain's first LED
+  uint16_t led_count; // Physical LEDs on the chain
+} layout_output_t;
+
+typedef struct {
+  uint16_t first; // Index into compiled_layout_t.spans
+  uint8_t count;
+} layout_glyph_t;
+
+// Compiled layout - absolute framebuffer positions, all within their chains
+typedef struct {
+  uint8_t digit_count;
+  uint8_t indicator_count;
+  segment_range_t segments[LAYOUT_MAX_DIGITS][SEGMENTS_PER_DIGIT];
+  uint8_t reversed[LAYOUT_MAX_DIGITS]; // Bit per segment
+  uint8_t digit_output[LAYOUT_MAX_DIGITS];
+  segment_range_t indicators[LAYOUT_MAX_INDICATORS];
+  layout_glyph_t glyphs[LAYOUT_MAX_DIGITS][LAYOUT_GLYPHS];
+  segment_range_t spans[LAYOUT_MAX_DIGITS * LAYOUT_GLYPHS * SEGMENTS_PER_DIGIT];
+  uint16_t span_count;
+  uint16_t output_active[LAYOUT_MAX_OUTPUTS]; // LEDs used from the start of each chain
+  uint16_t led_end;                           // Highest framebuffer LED used + 1
+} compiled_layout_t;
+
+// Built-in wiring: segments A-G back to back from each digit's base
+// (LEDS_PER_DIGIT LEDs per digit), no indicators
+void display_layout_default(display_layout_t *layout, int digit_count, const uint8_t *outputs, const uint16_t *bases);
+
+// Apply one text edit to a layout, as typed at the console (layout_console.h):
+//   digits <count>
+//   digit <digit> <output> <base>
+//   segment <digit> <a-g> <start> <count> [r]   (count 0 = not fitted, r = reversed)
+//   indicator <indicator> <output> <start> <count>
+// Returns NULL on success, otherwise what is wrong; the layout is left as it
+// was then. Values are only range checked here - display_layout_compile()
+// checks them against the chains.
+const char *display_layout_edit(display_layout_t *layout, int argc, const char *const *argv);
+
+// Validate and compile a layout. Returns NULL on success, otherwise what is wrong.
+const char *display_layout_compile(const display_layout_t *layout, const layout_output_t *outputs, int output_count,
+                                   compiled_layout_t *compiled);
+
+// Framebuffer range of an element; empty if it isn't fitted
+static inline segment_range_t layout_element_range(const compiled_layout_t *compiled, int element) {
+  if (element >= LAYOUT_INDICATOR_BIT(0))
+    return compiled->indicators[element - LAYOUT_INDICATOR_BIT(0)];
+  return compiled->segments[element / SEGMENTS_PER_DIGIT][element % SEGMENTS_PER_DIGIT];
+}
+
+// True if the element's data runs against its drawing direction
+static inline bool layout_element_reversed(const compiled_layout_t *compiled, int element) {
+  if (element >= LAYOUT_INDICATOR_BIT(0))
+    return false;
+  return (compiled->reversed[element / SEGMENTS_PER_DIGIT] >> (element % SEGMENTS_PER_DIGIT)) & 1;
+}
+
+// Spans lit by a digit value on one digit; none for values above 9
+static inline const segment_range_t *layout_glyph_spans(const compiled_layout_t *compiled, int digit, uint8_t value,
+                                                        size_t *count) {
+  if (value >= LAYOUT_GLYPHS) {
+    *count = 0;
+    return NULL;
+  }
+  const layout_glyph_t *glyph = &compiled->glyphs[digit][value];
+  *count = glyph->count;
+  return &compiled->spans[glyph->first];
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Platform-independent rendering: segment layout, digit glyphs, color pipeline
+// and framebuffer writes. No ESP-IDF dependencies, builds on the host as well.
+
+#define SEGMENTS_PER_DIGIT 7
+
+// Play Clock dimensions: 2 × 100 cm digits
+// LED segments: ~30 LEDs tall per vertical, ~15 LEDs horizontal
+#define LEDS_PER_SEGMENT_VERTICAL 30
+#define LEDS_PER_SEGMENT_HORIZONTAL 15
+
+// LEDs per digit in the built-in wiring, segments A-G back to back (display_layout.h)
+#define LEDS_PER_DIGIT (3 * LEDS_PER_SEGMENT_HORIZONTAL + 4 * LEDS_PER_SEGMENT_VERTICAL)
+
+// Segment indices for 7-segment display
+typedef enum {
+  SEGMENT_A = 0, // Top horizontal
+  SEGMENT_B = 1, // Upper right vertical
+  SEGMENT_C = 2, // Lower right vertical
+  SEGMENT_D = 3, // Bottom horizontal
+  SEGMENT_E = 4, // Lower left vertical
+  SEGMENT_F = 5, // Upper left vertical
+  SEGMENT_G = 6  // Middle horizontal
+} segment_t;
+
+// How a value is spread over the digits
+typedef enum {
+  RENDER_FORMAT_PLAIN, // Right-aligned number: play/shot clock seconds, score
+  RENDER_FORMAT_MMSS,  // Minutes and seconds, seconds on the last two digits, separator lit
+} render_format_t;
+
+#define RENDER_DIGIT_BLANK 0xFF // Digit value with no segments lit
+
+// Color structure
+typedef struct {
+  uint8_t r, g, b;
+} color_t;
+
+// Color pipeline calibration. Output per channel:
+//   white_balance * (value / 255)^color_gamma * (brightness / 255)^brightness_gamma
+// A brightness gamma above 1 makes the brightness setting perceptually even, so
+// the dim night settings don't jump in visible steps.
+typedef struct {
+  float color_gamma;
+  float brightness_gamma;
+  uint8_t white_balance[3]; // R, G, B channel scale (255 = unchanged)
+} display_calibration_t;
+
+#define DISPLAY_DEFAULT_COLOR_GAMMA 1.0f      // Received RGB values are shown as-is at full brightness
+#define DISPLAY_DEFAULT_BRIGHTNESS_GAMMA 2.2f
+
+// A run of consecutive LEDs in the framebuffer
+typedef struct {
+  uint16_t start;
+  uint16_t count;
+} segment_range_t;
+
+// Per-channel tables combining brightness, gamma and white balance for one
+// brightness level
+typedef struct {
+  uint8_t table[3][256];
+  uint8_t brightness;
+  display_calibration_t calibration;
+} color_lut_t;
+
+// 7-segment pattern for a digit value (bit n = segment n), blank above 9
+uint8_t render_digit_pattern(uint8_t value);
+
+// Segment mask (bit digit * 7 + segment) for the given digit values
+uint64_t render_segment_mask(const uint8_t *digits, int digit_count);
+
+// Split a value into digit values, most significant first. MM:SS rolls seconds
+// over into minutes (needs 3+ digits, otherwise plain). A value too large for
+// the digits shows the largest one that fits (99, 9:59). With suppress_zeros,
+// leading zeros are RENDER_DIGIT_BLANK - never the last digit, nor the last
+// minutes digit. Returns true if the separator (colon) is lit.
+bool render_format_value(render_format_t format, uint32_t value, bool suppress_zeros, uint8_t *digits, int digit_count);
+
+// Channel order a strip expects on the wire
+typedef enum {
+  COLOR_ORDER_RGB,
+  COLOR_ORDER_GRB,
+  COLOR_ORDER_BRG,
+  COLOR_ORDER_RBG,
+  COLOR_ORDER_GBR,
+  COLOR_ORDER_BGR,
+} color_order_t;
+
+#define WIRE_MAP_SCALE_FULL 256 // wire_map_build() scale that leaves the tables as they are
+
+// Framebuffer (logical RGB) to wire bytes, applied by the transports while they
+// encode a frame: the color pipeline tables, an overall scale and the strip's
+// channel order. Brightness changes and dimming only rebuild the map.
+typedef struct {
+  uint8_t table[3][256]; // Per wire slot, indexed by the framebuffer value
+  uint8_t source[3];     // Framebuffer channel (0 = R, 1 = G, 2 = B) sent in each wire slot
+} wire_map_t;
+
+// Rebuild the tables - only needed when brightness or calibration changes
+void color_lut_build(color_lut_t *lut, const display_calibration_t *calibration, uint8_t brightness);
+
+// Map for the pipeline tables at a scale (0..WIRE_MAP_SCALE_FULL) and channel order
+void wire_map_build(wire_map_t *map, const color_lut_t *lut, color_order_t order, uint16_t scale);
+
+// Wire bytes of one framebuffer pixel
+static inline void wire_map_pixel(const wire_map_t *map, const uint8_t *pixel, uint8_t wire[3]) {
+  wire[0] = map->table[0][pixel[map->source[0]]];
+  wire[1] = map->table[1][pixel[map->source[1]]];
+  wire[2] = map->table[2][pixel[map->source[2]]];
+}
+
+// Fill LEDs [start, start + count) of an RGB framebuffer, clipped to led_count.
+// Returns true if any byte changed. The change in the sum of each channel's
+// values is added to sum_delta[0..2] (may be NULL), so running totals of the
+// frame's drive level need no rescan.
+bool render_fill(uint8_t *pixels, uint16_t led_count, uint16_t start, uint16_t count, const uint8_t rgb[3],
+                 int32_t *sum_delta);
+
+// Fill pre-validated spans (compiled layout) - no clipping. Same return and sum_delta as render_fill().
+bool render_fill_spans(uint8_t *pixels, const segment_range_t *spans, size_t span_count, const uint8_t rgb[3],
+                       int32_t *sum_delta);
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Fixed-cadence frame scheduler for the render task. Frame deadlines sit on a
+// fixed grid (start + n * period) so the cadence doesn't drift with the work
+// done per frame. Platform-independent: times are platform_micros() values.
+//
+// Input handling runs on every pass. When a pass takes longer than the work
+// budget, rendering is skipped on the next pass so input keeps its cadence.
+
+#define FRAME_SCHEDULER_BUDGET_PERCENT 80 // Share of the period a pass may take
+
+typedef struct {
+  uint32_t frames;      // Deadlines reached
+  uint32_t missed;      // Deadlines passed without a frame (started a period or more late)
+  uint32_t overruns;    // Passes that took longer than the budget
+  uint32_t skipped;     // Passes that handled input only
+  uint32_t work_us;     // Last pass
+  uint32_t work_us_max;
+} frame_scheduler_stats_t;
+
+typedef struct {
+  uint32_t period_us;
+  uint32_t budget_us;
+  int64_t deadline_us;    // Next frame start
+  int64_t pass_start_us;
+  bool skip_render;       // Last pass overran
+  frame_scheduler_stats_t stats;
+} frame_scheduler_t;
+
+void frame_scheduler_init(frame_scheduler_t *scheduler, uint32_t rate_hz, int64_t now_us);
+
+// Restart the grid at now_us without counting missed deadlines (after blocking work)
+void frame_scheduler_resync(frame_scheduler_t *scheduler, int64_t now_us);
+
+// Microseconds until the next deadline, 0 when it has passed
+int64_t frame_scheduler_time_to_deadline(const frame_scheduler_t *scheduler, int64_t now_us);
+
+// Start a pass - on a deadline or an early wakeup. Advances the grid when a
+// deadline was reached. Returns false when rendering should be skipped.
+bool frame_scheduler_begin(frame_scheduler_t *scheduler, int64_t now_us);
+
+// End the pass started by frame_scheduler_begin()
+void frame_scheduler_end(frame_scheduler_t *scheduler, int64_t now_us);
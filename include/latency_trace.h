@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Packet-to-strip latency tracing. Each accepted packet opens a trace at its
+// radio arrival time; later stages are timestamped as the packet moves through
+// the radio task, the render task and the LED transport. Every stage event goes
+// into a fixed-size ring, and the time since arrival feeds a per-stage
+// histogram. Optionally a GPIO is held high from arrival until the frame is
+// off the wire, for scope measurements.
+//
+// One trace is open at a time - packets are far apart compared to a frame.
+// Each stage must be marked from a single context (task or ISR).
+
+typedef enum {
+  LATENCY_STAGE_RX,     // nRF24 IRQ edge, or the status poll that found data
+  LATENCY_STAGE_PARSE,  // Payload decoded and accepted by the radio task
+  LATENCY_STAGE_RENDER, // State applied by the render task
+  LATENCY_STAGE_SUBMIT, // Changed frame handed to the LED transport
+  LATENCY_STAGE_DONE,   // Frame completely on the strip (transport done ISR)
+  LATENCY_STAGE_COUNT
+} latency_stage_t;
+
+#define LATENCY_TRACE_RING_SIZE 128     // Events kept, oldest overwritten
+#define LATENCY_TRACE_TIMEOUT_US 200000 // Traces not done by then are dropped
+#define LATENCY_TRACE_MARKER_NONE -1
+
+typedef struct {
+  uint32_t time_us;    // platform_micros(), low 32 bits
+  uint32_t latency_us; // Since the RX event of the same trace
+  uint8_t stage;       // latency_stage_t
+  uint8_t sequence;    // Packet sequence number
+} latency_event_t;
+
+typedef struct {
+  uint32_t count;
+  uint32_t min_us;
+  uint32_t avg_us;
+  uint32_t p99_us; // Upper edge of the histogram bucket, within 12.5%
+  uint32_t max_us;
+} latency_stage_stats_t;
+
+// marker_pin: GPIO driven high from RX until DONE, LATENCY_TRACE_MARKER_NONE to disable
+void latency_trace_init(int marker_pin);
+
+// Open a trace for an accepted packet that arrived at rx_us (records the RX event)
+void latency_trace_begin(uint8_t sequence, int64_t rx_us);
+
+// Timestamp a stage of the open trace. Stages only count once and in order;
+// safe to call from ISRs.
+void latency_trace_mark(latency_stage_t stage);
+
+// Close the open trace early - its packet didn't change the display
+void latency_trace_end(void);
+
+// Time from RX to the given stage over all traces since init/reset
+void latency_trace_get_stats(latency_stage_t stage, latency_stage_stats_t *stats);
+void latency_trace_reset_stats(void);
+
+// Copy up to max of the newest events, oldest first. Returns the number copied.
+size_t latency_trace_read_events(latency_event_t *events, size_t max);
+
+const char *latency_stage_name(latency_stage_t stage);
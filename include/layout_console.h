@@ -0,0 +1,18 @@
+#pragma once
+
+#include "display_driver.h"
+#include <stdbool.h>
+
+// Serial console command for rewiring without recompiling. "layout" edits a
+// copy of the running layout (display_layout_edit() syntax), checks it
+// against the output chains and stores it in NVS for the next boot:
+//
+//   layout                          show the edited layout, as edit commands
+//   layout segment 1 g 150 15 r     any display_layout_edit() edit
+//   layout check                    validate against the output chains
+//   layout save                     store, applies on the next boot
+//   layout revert                   back to the running layout
+//   layout builtin                  drop the stored layout (built-in on next boot)
+
+// Start the console REPL on the default UART with the layout command
+bool layout_console_start(PlayClockDisplay *display);
@@ -7,6 +7,7 @@
 
 #include <stdint.h>
 #include "driver/rmt_encoder.h"
+#include "display_render.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -16,12 +17,25 @@ extern "C" {
  * @brief Type of led strip encoder configuration
  */
 typedef struct {
-    uint32_t resolution; /*!< Encoder resolution, in Hz */
+    uint32_t resolution;        /*!< Encoder resolution, in Hz */
+    const wire_map_t *wire_map; /*!< Pixel bytes to wire bytes (brightness, gamma, color order), read while
+                                     encoding - NULL sends the bytes as they are */
 } led_strip_encoder_config_t;
 
+/**
+ * @brief Run of pre-encoded RMT symbols, consumed by the LED span encoder
+ */
+typedef struct {
+    const rmt_symbol_word_t *symbols; /*!< Pre-encoded symbols, 8 per data byte */
+    size_t count;                     /*!< Number of symbols in the run */
+} led_symbol_span_t;
+
 /**
  * @brief Create RMT encoder for encoding LED strip pixels into RMT symbols
  *
+ * Pixel bytes are mapped through config->wire_map as they are encoded, so a
+ * map change (brightness, dimming) applies to the next frame without touching the pixels.
+ *
  * @param[in] config Encoder configuration
  * @param[out] ret_encoder Returned encoder handle
  * @return
@@ -31,6 +45,33 @@ typedef struct {
  */
 esp_err_t rmt_new_led_strip_encoder(const led_strip_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder);
 
+/**
+ * @brief Encode LED data bytes into WS2815 RMT symbols ahead of time
+ *
+ * @param[in] config Encoder configuration (resolution determines bit timing)
+ * @param[in] data Pixel bytes, mapped through config->wire_map when set (whole pixels then)
+ * @param[in] data_size Number of bytes in data
+ * @param[out] symbols Output buffer, must hold data_size * 8 symbols
+ * @return
+ *      - ESP_ERR_INVALID_ARG for any invalid arguments
+ *      - ESP_OK if encoding successfully
+ */
+esp_err_t led_strip_encode_symbols(const led_strip_encoder_config_t *config, const uint8_t *data, size_t data_size, rmt_symbol_word_t *symbols);
+
+/**
+ * @brief Create RMT encoder that transmits a list of pre-encoded symbol spans followed by the reset code
+ *
+ * The primary data passed to rmt_transmit() is an array of led_symbol_span_t, data size in bytes.
+ *
+ * @param[in] config Encoder configuration
+ * @param[out] ret_encoder Returned encoder handle
+ * @return
+ *      - ESP_ERR_INVALID_ARG for any invalid arguments
+ *      - ESP_ERR_NO_MEM out of memory when creating led span encoder
+ *      - ESP_OK if creating encoder successfully
+ */
+esp_err_t rmt_new_led_span_encoder(const led_strip_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder);
+
 #ifdef __cplusplus
 }
 #endif
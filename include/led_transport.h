@@ -0,0 +1,84 @@
+#pragma once
+
+#include "driver/gpio.h"
+#include "esp_err.h"
+#include "led_strip_encoder.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Output backends for the WS2815 data line
+typedef enum {
+  LED_TRANSPORT_RMT,     // RMT channel, ping-pong refill from the encoder ISR
+  LED_TRANSPORT_RMT_DMA, // RMT channel fed by DMA (large symbol buffer where DMA is unavailable)
+  LED_TRANSPORT_SPI_DMA  // SPI MOSI at 3.2 MHz, 4 SPI bits per WS2815 bit, single DMA transaction
+} led_transport_kind_t;
+
+// RMT resolution shared by the RMT backends and pre-encoded symbol caches
+#define LED_TRANSPORT_RMT_RESOLUTION_HZ 10000000 // 10MHz resolution, 1 tick = 0.1us
+
+// Called from ISR context once a frame (including the reset time) is off the wire
+typedef void (*led_transport_done_cb_t)(void *arg);
+
+typedef struct {
+  gpio_num_t gpio_num;             // Data pin
+  size_t max_leds;                 // Largest frame, sizes the DMA/symbol buffers
+  led_transport_done_cb_t on_done; // Frame completion callback (ISR context)
+  void *done_arg;
+  const wire_map_t *wire_map;      // Pixel bytes to wire bytes, read while a frame is sent (NULL: bytes as they are)
+} led_transport_config_t;
+
+// Per-frame measurements so the cheapest backend can be picked per board
+typedef struct {
+  uint32_t frames;       // Frames completed
+  uint32_t frame_us;     // Submit to done of the last frame
+  uint32_t frame_us_max; // Worst frame since init
+  uint32_t irq_count;    // Interrupts taken for the last frame (encoder refills + done)
+  uint32_t irq_us;       // CPU time spent in transport interrupt work for the last frame
+  uint32_t encode_us;    // Task-context CPU time to prepare and queue the last frame
+} led_transport_stats_t;
+
+typedef struct led_transport_s led_transport_t;
+
+// Transport interface - each backend embeds this as its first member
+struct led_transport_s {
+  const char *name;
+  led_transport_kind_t kind;
+
+  // Queue a frame of pixel bytes, mapped through the configured wire map (whole
+  // pixels then). Must not block; the data and the map must stay untouched
+  // until the done callback fires.
+  esp_err_t (*submit)(led_transport_t *transport, const uint8_t *pixels, size_t size);
+
+  // Queue a frame of pre-encoded RMT symbol spans. NULL when the backend
+  // can't transmit RMT symbols.
+  esp_err_t (*submit_spans)(led_transport_t *transport, const led_symbol_span_t *spans, size_t span_count);
+
+  // Drop queued and in-flight frames (optional)
+  void (*abort)(led_transport_t *transport);
+
+  void (*del)(led_transport_t *transport);
+
+  led_transport_done_cb_t on_done;
+  void *done_arg;
+  volatile led_transport_stats_t stats;
+};
+
+// Create a transport of the given kind
+esp_err_t led_transport_new(led_transport_kind_t kind, const led_transport_config_t *config, led_transport_t **ret_transport);
+
+// Backend constructors (led_transport_rmt.c, led_transport_spi.c)
+esp_err_t led_transport_new_rmt(const led_transport_config_t *config, bool with_dma, led_transport_t **ret_transport);
+esp_err_t led_transport_new_spi(const led_transport_config_t *config, led_transport_t **ret_transport);
+
+// Start the given transports' frames simultaneously: once each of them has a
+// frame submitted they go out on the same clock edge. RMT backends only.
+esp_err_t led_transport_sync_group(led_transport_t **transports, size_t count);
+esp_err_t led_transport_rmt_sync_group(led_transport_t **transports, size_t count);
+
+void led_transport_abort(led_transport_t *transport);
+
+const char *led_transport_kind_name(led_transport_kind_t kind);
+
+// Shared completion bookkeeping for backends - call from the done ISR
+void led_transport_frame_done(led_transport_t *transport, int64_t start_us, uint32_t irq_count, uint32_t irq_ns);
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "radio_protocol.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Rolling radio link quality. Fed after every drained RX batch with the
+// sequence tracker's counters, it keeps the loss over the recent frames (from
+// sequence gaps), retransmits (duplicates: the controller resends when our ACK
+// is lost), the controller's packet interval and how far arrivals stray from
+// it (RFC 3550 style mean deviation, plus a histogram). The link counts as lost
+// after a few missed intervals instead of a fixed time, and as degraded when
+// loss is high or the silence is half way there.
+// Platform-independent, builds on the host as well.
+
+#define LINK_QUALITY_WINDOW_FRAMES 64     // Loss window, the bits of link_quality_t.history
+#define LINK_QUALITY_INTERVAL_WEIGHT 8    // A sample moves the interval estimate 1/8 of the way
+#define LINK_QUALITY_JITTER_WEIGHT 16     // ... and the mean deviation 1/16, as in RFC 3550
+#define LINK_QUALITY_MIN_INTERVALS 8      // Interval samples before the timeout adapts
+#define LINK_QUALITY_MISSED_INTERVALS 4   // Silence that loses the link, in packet intervals (plus 4x jitter)
+#define LINK_QUALITY_MIN_TIMEOUT_MS 500   // Bounds of the adaptive timeout; the upper one also
+#define LINK_QUALITY_MAX_TIMEOUT_MS 10000 // applies until the packet rate is known
+#define LINK_QUALITY_DEGRADED_LOSS_PERCENT 10
+#define LINK_QUALITY_JITTER_BINS 8
+#define LINK_QUALITY_JITTER_EDGES_MS {1, 2, 5, 10, 20, 50, 100} // Upper edges, the last bin is open
+
+typedef enum {
+  LINK_STATUS_LOST,
+  LINK_STATUS_DEGRADED,
+  LINK_STATUS_GOOD,
+} link_status_t;
+
+// What the render side needs to judge the link, carried in SystemState
+typedef struct {
+  uint32_t interval_ms; // Controller packet interval, 0 until known
+  uint32_t timeout_ms;  // Silence after which the link is lost
+  uint8_t loss_percent; // Over the loss window
+} link_summary_t;
+
+typedef struct {
+  uint32_t frames;      // Sequence numbers accounted for (received or lost)
+  uint32_t lost;
+  uint32_t retransmits; // Duplicates of an accepted frame
+  uint32_t jitter_bins[LINK_QUALITY_JITTER_BINS]; // Arrival deviation from the expected time
+} link_quality_stats_t;
+
+typedef struct {
+  radio_sequence_stats_t last_counters; // Tracker counters at the previous batch
+  uint64_t history;       // Bit per frame, 1 = lost, newest in bit 0
+  uint8_t history_frames;
+  int64_t last_arrival_us; // Last batch with an accepted frame, 0 = none yet
+  uint32_t interval_us;    // Moving average of the per-frame arrival interval
+  uint32_t jitter_us;      // Mean deviation from the expected arrival
+  uint32_t interval_samples;
+  link_quality_stats_t stats;
+} link_quality_t;
+
+void link_quality_init(link_quality_t *link);
+
+// After a drained RX batch: counters are the sequence tracker's (cumulative,
+// since its reset), rx_us the batch arrival time
+void link_quality_on_batch(link_quality_t *link, const radio_sequence_stats_t *counters, int64_t rx_us);
+
+uint8_t link_quality_loss_percent(const link_quality_t *link);
+uint32_t link_quality_timeout_ms(const link_quality_t *link);
+void link_quality_summarize(const link_quality_t *link, link_summary_t *summary);
+
+// Status given the time since the last packet, and how much longer that
+// status holds without another packet (UINT32_MAX once lost)
+link_status_t link_quality_status(const link_summary_t *summary, uint32_t age_ms);
+uint32_t link_quality_ms_to_change(const link_summary_t *summary, uint32_t age_ms);
+const char *link_status_name(link_status_t status);
+
+// Jitter histogram as "<1:n <2:n ... >=100:n", for the log
+void link_quality_format_jitter(const link_quality_stats_t *stats, char *line, size_t size);
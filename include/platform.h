@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Thin platform layer used by the display and radio code. The ESP-IDF
+// implementation lives in main/platform_esp.c, the Linux mock in
+// host/platform_linux.c.
+//
+// The rest of the hardware is mocked on the host at its own interface: LED
+// output behind led_transport.h (host/led_transport_linux.c) and the nRF24
+// behind radio_common.h (host/radio_common_linux.c emulates the chip).
+
+// Code reachable from ISRs: kept in IRAM on target
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#define PLATFORM_ISR_ATTR IRAM_ATTR
+#else
+#define PLATFORM_ISR_ATTR
+#endif
+
+// Tick clock
+uint32_t platform_millis(void);
+int64_t platform_micros(void); // Safe to call from ISRs on target
+void platform_delay_ms(uint32_t ms);
+void platform_delay_us(uint32_t us); // Busy wait, for settling times well below a tick
+
+// Cycle counter for micro-benchmarks (CPU cycles on target, ns on the host).
+// Wraps - only differences over short intervals are meaningful. The rate is
+// the current one; on target it changes with the CPU clock, so only convert
+// cycles counted while the CPU_FREQ_MAX lock was held (power_idle.h).
+uint32_t platform_cycles(void);
+uint32_t platform_cycles_per_us(void);
+
+// Mutex (recursive locking is not supported)
+typedef struct platform_mutex_s *platform_mutex_t;
+
+platform_mutex_t platform_mutex_create(void);
+void platform_mutex_lock(platform_mutex_t mutex);
+void platform_mutex_unlock(platform_mutex_t mutex);
+
+// Binary signal from an ISR (or task) to one waiting task
+typedef struct platform_signal_s *platform_signal_t;
+
+platform_signal_t platform_signal_create(void);
+void platform_signal_give(platform_signal_t signal); // Safe to call from ISRs on target
+// False if timeout_ms passed without a give; a give is consumed by one take
+bool platform_signal_take(platform_signal_t signal, uint32_t timeout_ms);
+
+// Short critical section shared with ISRs (a spinlock on target). Not nestable;
+// keep it to a few loads and stores.
+void platform_critical_enter(void);
+void platform_critical_exit(void);
+
+// Memory that ISRs may read while the flash cache is off (internal RAM on
+// target); release it with free()
+void *platform_malloc_internal(size_t size);
+
+// Small persistent blobs by namespace and key (NVS on target). load sets *size
+// to the stored length; store with data NULL erases the key.
+bool platform_storage_load(const char *space, const char *key, void *data, size_t *size);
+bool platform_storage_store(const char *space, const char *key, const void *data, size_t size);
+
+// GPIO
+typedef enum {
+  PLATFORM_GPIO_OUTPUT,
+  PLATFORM_GPIO_INPUT_PULLUP
+} platform_gpio_mode_t;
+
+void platform_gpio_config(int pin, platform_gpio_mode_t mode);
+void platform_gpio_set(int pin, int level); // Safe to call from ISRs on target
+int platform_gpio_get(int pin);
+
+// Falling-edge interrupt on an input with pull-up; the handler runs in ISR context
+typedef void (*platform_isr_t)(void *arg);
+bool platform_gpio_irq(int pin, platform_isr_t handler, void *arg);
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// CPU frequency for an idle clock. The render task holds a CPU_FREQ_MAX power
+// management lock while the display is live and releases it once the strip is
+// dark and nothing is due (link lost or display blanked); the CPU then drops
+// to POWER_IDLE_MIN_CPU_MHZ between interrupts. Wakeups are the usual GPIO
+// interrupts (radio IRQ, button), served at the lower clock until the lock is
+// taken again, so wake latency is unchanged.
+// Needs CONFIG_PM_ENABLE; without it the CPU stays at full speed and only the
+// statistics are kept.
+
+#define POWER_IDLE_MIN_CPU_MHZ 80 // Lowest that keeps APB at 80 MHz (RMT, SPI and UART timing)
+
+typedef struct {
+  bool idle;
+  uint32_t entries; // Times the CPU was let go to idle
+  int64_t idle_us;  // Time spent idle, up to the last change
+} power_idle_stats_t;
+
+// Configure dynamic frequency scaling and take the lock (not idle)
+bool power_idle_init(void);
+
+// Release (idle) or take back the full CPU clock; repeated calls are cheap
+void power_idle_set(bool idle);
+
+void power_idle_get_stats(power_idle_stats_t *stats);
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Strip current estimate and brightness limiter. The draw of a frame follows
+// from the sum of its wire channel values (PWM duty), which the fill functions
+// keep up to date as segments change, so nothing rescans the framebuffer.
+// When the estimate exceeds the budget, the limit drops in proportion at once
+// (the driver folds it into the encoders' wire map); it is then released
+// gradually so the display doesn't pump.
+// Platform-independent, builds on the host as well.
+
+#define POWER_LIMIT_FULL 256 // No scaling, same as WIRE_MAP_SCALE_FULL
+
+typedef struct {
+  uint32_t requested_ma; // Draw of the frame as rendered
+  uint32_t estimate_ma;  // Draw after limiting
+  uint32_t peak_ma;      // Highest estimate_ma
+  uint32_t limited_frames;
+  uint16_t limit;        // Scale applied to the last frame
+} power_limit_stats_t;
+
+typedef struct {
+  uint32_t budget_ma;
+  uint32_t channel_ua;    // One channel at full duty
+  uint32_t idle_ma;       // The whole strip dark
+  uint16_t release_step;  // Limit recovery per frame
+  uint16_t limit;         // Applied scale, POWER_LIMIT_FULL when within budget
+  power_limit_stats_t stats;
+} power_limit_t;
+
+void power_limit_init(power_limit_t *power, uint32_t budget_ma, uint32_t channel_ua, uint32_t idle_ma,
+                      uint16_t release_step);
+
+// Estimated draw in mA of a frame with this channel value sum at the given limit
+uint32_t power_limit_draw_ma(const power_limit_t *power, uint32_t channel_sum, uint16_t limit);
+
+// Work out the limit for a frame about to be sent; returns it
+uint16_t power_limit_update(power_limit_t *power, uint32_t channel_sum);
@@ -1,31 +1,63 @@
 #pragma once
 
-#include "../../radio-common/include/radio_common.h"
+#include "channel_hop.h"
 #include "driver/gpio.h"
 #include "driver/spi_master.h"
+#include "radio_common.h"
+#include "radio_protocol.h"
+#include "system_state.h"
 #include <stdbool.h>
 #include <stdint.h>
 
-// System state structure
-typedef struct {
-  uint16_t seconds;
-  uint8_t r, g, b;  // RGB color values
-  uint8_t sequence;
-  uint32_t last_status_time;
-  bool link_alive;
-} SystemState;
-
 // Use RadioCommon from radio_common.h instead of RadioComm
 typedef RadioCommon RadioComm;
 
+// nRF24L01+ IRQ output (active low, held while RX_DR is set). GPIO_NUM_NC
+// falls back to polling every RADIO_POLL_INTERVAL_MS.
+#define RADIO_IRQ_PIN GPIO_NUM_22
+#define RADIO_POLL_INTERVAL_MS 50
+
+// Follow the controller's channel moves and search for it when it goes quiet
+// (channel_hop.h). The hop set must match the controller's: the gaps around
+// Wi-Fi channels 1, 6 and 11 and the top of the ISM band (RF_CH n = 2400 + n MHz).
+#define RADIO_CHANNEL_HOPPING 1
+#define RADIO_HOP_CHANNELS {76, 80, 74, 83, 50, 25}
+#define RADIO_SURVEY_SWEEPS 4 // RPD sweeps per survey, about 30 ms each
+
 // Function declarations
 bool radio_begin(RadioComm *radio, gpio_num_t ce, gpio_num_t csn);
+// Drain the RX FIFO and apply the newest message; false if nothing newer arrived
 bool radio_receive_message(RadioComm *radio, SystemState *state);
 void radio_start_listening(RadioComm *radio);
 void radio_stop_listening(RadioComm *radio);
 bool radio_is_data_available(RadioComm *radio);
 void radio_flush_rx(RadioComm *radio);
 
+// Route the IRQ line to a GPIO interrupt; radio_wait_for_message() then sleeps
+// until a payload is pending instead of polling the radio over SPI
+bool radio_enable_irq(RadioComm *radio, gpio_num_t irq_pin);
+// Block up to timeout_ms for the next message
+bool radio_wait_for_message(RadioComm *radio, SystemState *state, uint32_t timeout_ms);
+
+// Duplicate/reorder/gap counters since radio_start_listening()
+void radio_get_sequence_stats(radio_sequence_stats_t *stats);
+// Loss, packet interval, jitter and retransmits since radio_start_listening();
+// the summary also goes out with every state in SystemState.link
+void radio_get_link_quality(link_quality_t *quality);
+
+// Tuned RF channel, and a move to another one while listening
+uint8_t radio_get_channel(RadioComm *radio);
+void radio_set_channel(RadioComm *radio, uint8_t channel);
+
+// Sweep the received power detector of every channel into survey; listening
+// resumes on the tuned channel. Blocks for the sweeps.
+bool radio_survey(RadioComm *radio, channel_survey_t *survey, int sweeps);
+
+// Follow hop announcements from the controller, and search the hop set
+// (surveyed, cleanest first) after a silence. Call once listening.
+void radio_enable_hopping(RadioComm *radio, const uint8_t *channels, uint8_t count);
+void radio_get_hop_stats(channel_hop_stats_t *stats);
+
 // Use radio_common functions for low-level operations
 // uint8_t nrf24_read_register(RadioCommon* radio, uint8_t reg);
 // bool nrf24_write_register(RadioCommon* radio, uint8_t reg, uint8_t value);
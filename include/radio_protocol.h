@@ -0,0 +1,116 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Over-the-air payload from the scoreboard controller. Platform-independent,
+// builds on the host as well.
+//
+// Versioned frame, one nRF24 payload (up to 32 bytes):
+//   byte 0:   RADIO_PROTOCOL_MAGIC | version
+//   byte 1:   sequence number
+//   byte 2..: records, each [type][length][value], until the end of the frame
+//             or a RADIO_RECORD_PAD byte. Unknown types are skipped by their
+//             length, so newer controllers can add fields.
+// Multi-byte values are big endian. Fields missing from a frame keep their
+// last value on the receiver, but a frame is applied as a whole and only the
+// newest one in a burst is - controllers send every field they drive.
+//
+// Frames not starting with the magic are the legacy 6-byte layout:
+//   byte 0-1: seconds (255 = blank display)
+//   byte 2-4: R, G, B
+//   byte 5:   sequence number
+#define RADIO_PROTOCOL_MAGIC 0xC0     // High nibble of byte 0 (legacy: seconds >= 49152)
+#define RADIO_PROTOCOL_VERSION 1
+#define RADIO_PROTOCOL_HEADER_SIZE 2
+#define RADIO_PROTOCOL_MAX_FRAME 32
+#define RADIO_PROTOCOL_LEGACY_SIZE 6
+#define RADIO_PROTOCOL_BLANK_SECONDS 255 // seconds value that blanks the display
+
+// Record types
+#define RADIO_RECORD_PAD 0x00        // End of records
+#define RADIO_RECORD_PLAY_CLOCK 0x01 // radio_clock_t: tenths(2) flags(1)
+#define RADIO_RECORD_GAME_CLOCK 0x02 // radio_clock_t
+#define RADIO_RECORD_SHOT_CLOCK 0x03 // radio_clock_t
+#define RADIO_RECORD_COLOR 0x04      // R(1) G(1) B(1)
+#define RADIO_RECORD_PERIOD 0x05     // period(1)
+#define RADIO_RECORD_COMMAND 0x06    // clock record type(1) command(1)
+#define RADIO_RECORD_HOP 0x07        // RF channel(1) delay(1, 10 ms units): the controller moves there after the delay
+
+#define RADIO_HOP_DELAY_UNIT_MS 10
+
+// Bits in radio_message_t.fields, one per record type
+#define RADIO_FIELD(record) (1U << (record))
+
+// radio_clock_t.flags
+#define RADIO_CLOCK_RUNNING 0x01
+#define RADIO_CLOCK_BLANK 0x02
+
+typedef enum {
+  RADIO_COMMAND_NONE,
+  RADIO_COMMAND_RUN,
+  RADIO_COMMAND_STOP,
+  RADIO_COMMAND_RESET, // Clock was set to the value in its record - don't smooth
+} radio_command_t;
+
+typedef struct {
+  uint16_t tenths; // Time left in tenths of a second
+  uint8_t flags;   // RADIO_CLOCK_*
+} radio_clock_t;
+
+typedef struct {
+  uint8_t version;  // 0 for legacy frames
+  uint8_t sequence;
+  uint16_t fields;  // RADIO_FIELD() of every record present
+  uint16_t seconds; // Play clock as displayed, RADIO_PROTOCOL_BLANK_SECONDS when blank
+  uint8_t r, g, b;  // RGB color values
+  radio_clock_t play_clock;
+  radio_clock_t game_clock;
+  radio_clock_t shot_clock;
+  uint8_t period;
+  uint8_t command;       // radio_command_t
+  uint8_t command_clock; // Record type of the clock the command is for
+  uint8_t hop_channel;   // Announced channel change
+  uint16_t hop_delay_ms; // From this frame's arrival
+} radio_message_t;
+
+// Decode a received payload; false if it is malformed, too short or of an
+// unsupported version
+bool radio_protocol_parse(const uint8_t *payload, size_t length, radio_message_t *message);
+
+// Encode the fields set in message->fields as a versioned frame. Returns the
+// frame length, 0 if the buffer is too small.
+size_t radio_protocol_encode(const radio_message_t *message, uint8_t *payload, size_t size);
+
+// Sequence tracking. Sequence numbers are compared with 8-bit serial number
+// arithmetic, so 0 follows 255 and "newer" means at most 127 steps ahead.
+// Stale frames in a row beyond this count are taken as a transmitter restart.
+#define RADIO_SEQUENCE_RESYNC_FRAMES 8
+// Largest batch radio_sequence_process() orders (RX FIFO depth plus margin)
+#define RADIO_SEQUENCE_MAX_BATCH 8
+
+// Per-session receive counters
+typedef struct {
+  uint32_t received;   // Messages decoded
+  uint32_t accepted;   // Newer than the current state
+  uint32_t duplicates; // Same sequence as an accepted message
+  uint32_t reorders;   // Arrived after a newer message
+  uint32_t gaps;       // Breaks in the sequence
+  uint32_t lost;       // Sequence numbers skipped over by the gaps
+  uint32_t resyncs;    // Sequence restarted by the transmitter
+} radio_sequence_stats_t;
+
+typedef struct {
+  bool have_last;
+  uint8_t last_sequence;
+  uint8_t stale_run;
+  radio_sequence_stats_t stats;
+} radio_sequence_t;
+
+void radio_sequence_reset(radio_sequence_t *sequence);
+
+// Order a batch of messages (e.g. one drained RX FIFO) by sequence number and
+// run it through the tracker. Returns the index of the newest accepted
+// message, or -1 if the batch holds nothing newer than the current state.
+int radio_sequence_process(radio_sequence_t *sequence, const radio_message_t *messages, size_t count);
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "system_state.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Lock-free single-producer/single-consumer mailbox holding the latest
+// SystemState (triple buffer). The producer never waits for the consumer and
+// the consumer always gets the newest complete state; intermediate states
+// published between two reads are skipped.
+typedef struct {
+  SystemState slots[3];
+  atomic_uint_least8_t shared; // Slot handed between the two sides, STATE_MAILBOX_FRESH while unread
+  uint8_t write_slot;          // Owned by the producer
+  uint8_t read_slot;           // Owned by the consumer
+} state_mailbox_t;
+
+void state_mailbox_init(state_mailbox_t *mailbox, const SystemState *initial);
+
+// Producer side
+void state_mailbox_publish(state_mailbox_t *mailbox, const SystemState *state);
+
+// Consumer side - copies the newest state if one was published since the last call
+bool state_mailbox_take(state_mailbox_t *mailbox, SystemState *state);
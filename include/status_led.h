@@ -0,0 +1,25 @@
+#pragma once
+
+#include "driver/gpio.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Status LED blink patterns, stepped by an esp_timer so they keep their timing
+// whatever the render task is doing (or while it idles).
+
+typedef enum {
+  STATUS_LED_OFF,
+  STATUS_LED_ON,
+  STATUS_LED_LINK_GOOD,     // Slow blink, 1 s on / 1 s off
+  STATUS_LED_LINK_DEGRADED, // 300 ms on / off
+  STATUS_LED_LINK_LOST,     // 100 ms on / off
+  STATUS_LED_IDLE,          // 50 ms flash every 2 s
+  STATUS_LED_FAULT_DISPLAY, // 100 ms on / off, from setup before the radio is up
+  STATUS_LED_FAULT_RADIO,   // 250 ms on / off
+  STATUS_LED_PATTERN_COUNT
+} status_led_pattern_t;
+
+bool status_led_init(gpio_num_t pin);
+
+// Switch patterns, starting with the on phase; the same pattern again keeps its phase
+void status_led_set(status_led_pattern_t pattern);
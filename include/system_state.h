@@ -0,0 +1,29 @@
+#pragma once
+
+#include "link_quality.h"
+#include "radio_protocol.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// System state: what the radio task publishes to the render task.
+// Platform-independent, builds on the host as well.
+typedef struct {
+  uint16_t seconds; // Play clock as displayed, RADIO_PROTOCOL_BLANK_SECONDS when blank
+  uint8_t r, g, b;  // RGB color values
+  uint8_t sequence;
+  int64_t rx_time_us; // Arrival of the newest applied message (platform_micros)
+  uint8_t protocol_version; // Of the newest applied message, 0 = legacy
+  uint16_t fields;          // RADIO_FIELD() of every record received so far
+  radio_clock_t play_clock;
+  radio_clock_t game_clock;
+  radio_clock_t shot_clock;
+  uint8_t period;
+  uint8_t command;       // radio_command_t of the newest applied message
+  uint8_t command_clock;
+  uint32_t last_status_time; // platform_millis() of the last valid payload, duplicates included
+  link_summary_t link;       // Loss, packet interval and adaptive timeout at that payload
+} SystemState;
+
+// Copy the fields present in a decoded message; the rest keep their last
+// value. Run/stop commands override the run flag of the clock they name.
+void system_state_apply(SystemState *state, const radio_message_t *message);
@@ -0,0 +1,157 @@
+#include "../include/app_events.h"
+#include "../include/platform.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include <stdatomic.h>
+
+static const char *TAG = "APP_EVENTS";
+
+static QueueHandle_t queue = NULL;
+
+// At most one APP_EVENT_STATE is queued: the mailbox only holds the newest
+// state anyway, so a busy consumer doesn't fill the queue with them
+static atomic_bool state_queued = false;
+
+// Button: debounced level and long press, owned by the timer callbacks
+static gpio_num_t button_pin = GPIO_NUM_NC;
+static esp_timer_handle_t debounce_timer = NULL;
+static esp_timer_handle_t long_press_timer = NULL;
+static volatile bool button_held = false;
+static volatile bool long_press_sent = false;
+
+static bool post(const app_event_t *event) {
+  if (xQueueSend(queue, event, 0) != pdTRUE) {
+    ESP_LOGW(TAG, "Event queue full, dropping event %d", event->type);
+    return false;
+  }
+  return true;
+}
+
+bool app_events_post(app_event_type_t type) {
+  if (queue == NULL)
+    return false;
+  if (type == APP_EVENT_STATE && atomic_exchange(&state_queued, true))
+    return true;
+  app_event_t event = {.type = type, .long_press = false, .time_ms = platform_millis()};
+  if (!post(&event)) {
+    if (type == APP_EVENT_STATE)
+      atomic_store(&state_queued, false);
+    return false;
+  }
+  return true;
+}
+
+bool app_events_wait(app_event_t *event, uint32_t timeout_ms) {
+  TickType_t ticks = timeout_ms == UINT32_MAX ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+  if (queue == NULL) {
+    // Still a timed wait, so a caller's loop doesn't spin
+    vTaskDelay(ticks);
+    return false;
+  }
+  if (xQueueReceive(queue, event, ticks) != pdTRUE)
+    return false;
+  if (event->type == APP_EVENT_STATE)
+    atomic_store(&state_queued, false);
+  return true;
+}
+
+bool app_events_button_held(void) {
+  return button_held;
+}
+
+// First edge of a bounce: mask the pin until the level has settled
+static IRAM_ATTR void button_isr(void *arg) {
+  gpio_intr_disable(button_pin);
+  esp_timer_start_once(debounce_timer, APP_EVENT_DEBOUNCE_MS * 1000);
+}
+
+// Settled level (esp_timer task)
+static void debounce_done(void *arg) {
+  bool pressed = gpio_get_level(button_pin) == 0; // Active low
+  if (pressed != button_held) {
+    app_event_t event = {.long_press = false, .time_ms = platform_millis()};
+    button_held = pressed;
+    if (pressed) {
+      long_press_sent = false;
+      esp_timer_start_once(long_press_timer, APP_EVENT_LONG_PRESS_MS * 1000);
+      event.type = APP_EVENT_BUTTON_DOWN;
+    } else {
+      esp_timer_stop(long_press_timer);
+      event.type = APP_EVENT_BUTTON_UP;
+      event.long_press = long_press_sent;
+    }
+    post(&event);
+  }
+  gpio_intr_enable(button_pin);
+
+  // An edge while masked was missed - settle again
+  if ((gpio_get_level(button_pin) == 0) != button_held) {
+    gpio_intr_disable(button_pin);
+    esp_timer_start_once(debounce_timer, APP_EVENT_DEBOUNCE_MS * 1000);
+  }
+}
+
+static void long_press_done(void *arg) {
+  if (!button_held)
+    return;
+  long_press_sent = true;
+  app_event_t event = {.type = APP_EVENT_BUTTON_LONG, .long_press = true, .time_ms = platform_millis()};
+  post(&event);
+}
+
+static bool init_button(gpio_num_t pin) {
+  gpio_config_t button_config = {
+    .pin_bit_mask = 1ULL << pin,
+    .mode = GPIO_MODE_INPUT,
+    .pull_up_en = GPIO_PULLUP_ENABLE,
+    .pull_down_en = GPIO_PULLDOWN_DISABLE,
+    .intr_type = GPIO_INTR_ANYEDGE,
+  };
+  esp_err_t result = gpio_config(&button_config);
+  if (result != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to configure button pin %d: %s", pin, esp_err_to_name(result));
+    return false;
+  }
+
+  const esp_timer_create_args_t debounce_args = {.callback = debounce_done, .name = "button_debounce"};
+  const esp_timer_create_args_t long_press_args = {.callback = long_press_done, .name = "button_long"};
+  if (esp_timer_create(&debounce_args, &debounce_timer) != ESP_OK ||
+      esp_timer_create(&long_press_args, &long_press_timer) != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to create button timers");
+    return false;
+  }
+
+  // The service may already be installed by another driver
+  result = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+  if (result != ESP_OK && result != ESP_ERR_INVALID_STATE) {
+    ESP_LOGE(TAG, "Failed to install GPIO ISR service: %s", esp_err_to_name(result));
+    return false;
+  }
+
+  button_pin = pin;
+  button_held = gpio_get_level(pin) == 0;
+  result = gpio_isr_handler_add(pin, button_isr, NULL);
+  if (result != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to add button handler: %s", esp_err_to_name(result));
+    button_pin = GPIO_NUM_NC;
+    return false;
+  }
+  ESP_LOGI(TAG, "Button on GPIO %d, %d ms debounce, long press %d ms", pin, APP_EVENT_DEBOUNCE_MS,
+           APP_EVENT_LONG_PRESS_MS);
+  return true;
+}
+
+bool app_events_init(gpio_num_t pin) {
+  queue = xQueueCreate(APP_EVENT_QUEUE_LENGTH, sizeof(app_event_t));
+  if (queue == NULL) {
+    ESP_LOGE(TAG, "Failed to create event queue");
+    return false;
+  }
+  if (pin == GPIO_NUM_NC)
+    return true;
+  return init_button(pin);
+}
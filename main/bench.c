@@ -0,0 +1,242 @@
+#include "../include/bench.h"
+#include "../include/display_anim.h"
+#include "../include/display_layout.h"
+#include "../include/platform.h"
+#include "../include/radio_protocol.h"
+#include <stdio.h>
+#include <string.h>
+
+#define BENCH_BATCH_US 5000         // Batches are grown to at least this long
+#define BENCH_MAX_ITERATIONS 1000000
+#define BENCH_ROUNDS 7              // Timed batches per case; the fastest counts
+#define BENCH_ENCODE_CHUNK 48       // Bytes (whole pixels) per encoder call, as the RMT memory is refilled
+#define BENCH_YIELD_MS 10           // Between cases, so the idle task runs on target
+#define BENCH_FRAME_US 16667        // Animation frames at 60 Hz
+#define BENCH_TRANSITION_US 120000
+
+static const uint16_t strip_lengths[] = {150, 300, 450, 900, BENCH_MAX_LEDS};
+static const uint8_t digit_counts[] = {2, 4, 6};
+
+static const uint8_t lit_rgb[3] = {255, 165, 0};
+static const uint8_t off_rgb[3] = {0, 0, 0};
+
+static uint8_t pixels[BENCH_MAX_LEDS * 3];
+static uint32_t symbols[BENCH_ENCODE_CHUNK * 8];
+static compiled_layout_t layout;
+static anim_engine_t anim;
+static color_lut_t lut;
+static wire_map_t map;
+
+// Case under way
+static bench_encode_fn encoder;
+static uint16_t case_leds;
+static uint8_t case_digits[LAYOUT_MAX_DIGITS];
+static uint32_t case_range; // Values the digits can show
+static radio_message_t parsed;
+
+// Play clock 30.0 s running, RGB(255,165,0), sequence 7 - v1 and legacy
+static const uint8_t frame_v1[] = {0xC1, 0x07, 0x01, 0x03, 0x01, 0x2C, 0x01, 0x04, 0x03, 0xFF, 0xA5, 0x00};
+static const uint8_t frame_legacy[] = {0x00, 0x1E, 0xFF, 0xA5, 0x00, 0x07};
+
+// fill_all_leds(): every LED, changing color each time
+static void case_fill_all(uint32_t i) {
+  render_fill(pixels, case_leds, 0, case_leds, (i & 1) ? lit_rgb : off_rgb, NULL);
+}
+
+// display_clear(): the layout's LEDs to dark
+static void case_clear(uint32_t i) {
+  (void)i;
+  render_fill(pixels, layout.led_end, 0, layout.led_end, off_rgb, NULL);
+}
+
+// display_set_time() without transitions: format, then redraw the glyphs that changed
+static void case_set_time(uint32_t i) {
+  uint8_t digits[LAYOUT_MAX_DIGITS];
+  render_format_value(RENDER_FORMAT_PLAIN, i % case_range, false, digits, layout.digit_count);
+  for (int d = 0; d < layout.digit_count; d++) {
+    if (digits[d] == case_digits[d])
+      continue;
+    size_t count;
+    const segment_range_t *spans = layout_glyph_spans(&layout, d, case_digits[d], &count);
+    render_fill_spans(pixels, spans, count, off_rgb, NULL);
+    spans = layout_glyph_spans(&layout, d, digits[d], &count);
+    render_fill_spans(pixels, spans, count, lit_rgb, NULL);
+    case_digits[d] = digits[d];
+  }
+}
+
+// display_animate() during crossfades: a new value every 8 frames
+static void case_anim_frame(uint32_t i) {
+  int64_t now_us = (int64_t)i * BENCH_FRAME_US;
+  if (i % 8 == 0) {
+    uint8_t digits[LAYOUT_MAX_DIGITS];
+    render_format_value(RENDER_FORMAT_PLAIN, i / 8 % case_range, false, digits, layout.digit_count);
+    anim_set_mask(&anim, render_segment_mask(digits, layout.digit_count), now_us);
+  }
+  anim_render(&anim, pixels, now_us, NULL);
+}
+
+// Wire map rebuild for a brightness or power limit change
+static void case_wire_map(uint32_t i) {
+  wire_map_build(&map, &lut, COLOR_ORDER_GRB, 128 + (i & 127));
+}
+
+// Bit encoding of a whole strip through the wire map, a chunk at a time
+static void case_encode(uint32_t i) {
+  (void)i;
+  size_t size = case_leds * 3;
+  for (size_t offset = 0; offset < size; offset += BENCH_ENCODE_CHUNK) {
+    size_t chunk = size - offset < BENCH_ENCODE_CHUNK ? size - offset : BENCH_ENCODE_CHUNK;
+    encoder(&pixels[offset], chunk, &map, symbols);
+  }
+}
+
+static void case_parse_v1(uint32_t i) {
+  (void)i;
+  radio_protocol_parse(frame_v1, sizeof(frame_v1), &parsed);
+}
+
+static void case_parse_legacy(uint32_t i) {
+  (void)i;
+  radio_protocol_parse(frame_legacy, sizeof(frame_legacy), &parsed);
+}
+
+static uint32_t time_batch(void (*run)(uint32_t), uint32_t iterations) {
+  uint32_t start = platform_cycles();
+  for (uint32_t i = 0; i < iterations; i++) {
+    run(i);
+  }
+  return platform_cycles() - start;
+}
+
+typedef struct {
+  bench_result_t *results;
+  size_t count;
+  size_t max;
+} bench_run_t;
+
+static void run_case(bench_run_t *run, const char *name, void (*fn)(uint32_t), uint16_t leds, uint8_t digits) {
+  if (run->count >= run->max)
+    return;
+
+  // Grow the batch until timer resolution no longer matters
+  uint32_t per_us = platform_cycles_per_us();
+  uint32_t iterations = 1;
+  while (iterations < BENCH_MAX_ITERATIONS && time_batch(fn, iterations) < BENCH_BATCH_US * per_us) {
+    iterations *= 2;
+  }
+
+  uint32_t best = UINT32_MAX;
+  for (int round = 0; round < BENCH_ROUNDS; round++) {
+    uint32_t cycles = time_batch(fn, iterations);
+    if (cycles < best)
+      best = cycles;
+  }
+
+  bench_result_t *result = &run->results[run->count++];
+  memset(result, 0, sizeof(*result));
+  snprintf(result->name, sizeof(result->name), "%s", name);
+  result->leds = leds;
+  result->digits = digits;
+  result->iterations = iterations;
+  result->ns_per_op = (uint32_t)((uint64_t)best * 1000 / per_us / iterations);
+  platform_delay_ms(BENCH_YIELD_MS);
+}
+
+// Built-in wiring with digits back to back on one chain, framebuffer dark
+static bool setup_layout(uint8_t digit_count) {
+  uint8_t outputs[LAYOUT_MAX_DIGITS] = {0};
+  uint16_t bases[LAYOUT_MAX_DIGITS] = {0};
+  for (int d = 0; d < digit_count; d++) {
+    bases[d] = d * LEDS_PER_DIGIT;
+  }
+  display_layout_t source;
+  display_layout_default(&source, digit_count, outputs, bases);
+  layout_output_t output = {0, BENCH_MAX_LEDS};
+  if (display_layout_compile(&source, &output, 1, &layout) != NULL)
+    return false;
+
+  case_range = 1;
+  for (int d = 0; d < digit_count; d++) {
+    case_range *= 10;
+  }
+  memset(pixels, 0, sizeof(pixels));
+  memset(case_digits, RENDER_DIGIT_BLANK, sizeof(case_digits));
+  anim_init(&anim, &layout);
+  anim_set_transition(&anim, ANIM_TRANSITION_CROSSFADE, BENCH_TRANSITION_US);
+  anim_set_colors(&anim, lit_rgb, off_rgb);
+  anim_sync(&anim, 0);
+  return true;
+}
+
+size_t bench_run_all(bench_encode_fn encode, bench_result_t *results, size_t max_results) {
+  bench_run_t run = {results, 0, max_results};
+  encoder = encode;
+
+  const display_calibration_t calibration = {
+    .color_gamma = DISPLAY_DEFAULT_COLOR_GAMMA,
+    .brightness_gamma = DISPLAY_DEFAULT_BRIGHTNESS_GAMMA,
+    .white_balance = {255, 255, 255},
+  };
+  color_lut_build(&lut, &calibration, 200);
+  wire_map_build(&map, &lut, COLOR_ORDER_GRB, WIRE_MAP_SCALE_FULL);
+
+  for (size_t i = 0; i < sizeof(strip_lengths) / sizeof(strip_lengths[0]); i++) {
+    case_leds = strip_lengths[i];
+    for (size_t p = 0; p < sizeof(pixels); p++) {
+      pixels[p] = (uint8_t)(p * 37); // Mixed bits for the encoder
+    }
+    run_case(&run, "fill_all", case_fill_all, case_leds, 0);
+    if (encoder != NULL) {
+      run_case(&run, "encode", case_encode, case_leds, 0);
+    }
+  }
+
+  for (size_t i = 0; i < sizeof(digit_counts) / sizeof(digit_counts[0]); i++) {
+    uint8_t digits = digit_counts[i];
+    if (!setup_layout(digits))
+      continue;
+    run_case(&run, "set_time", case_set_time, layout.led_end, digits);
+    run_case(&run, "clear", case_clear, layout.led_end, digits);
+    run_case(&run, "anim_frame", case_anim_frame, layout.led_end, digits);
+  }
+
+  run_case(&run, "wire_map", case_wire_map, 0, 0);
+  run_case(&run, "parse_v1", case_parse_v1, 0, 0);
+  run_case(&run, "parse_legacy", case_parse_legacy, 0, 0);
+  return run.count;
+}
+
+void bench_format(const bench_result_t *result, char *line, size_t size) {
+  snprintf(line, size, "%s,%u,%u,%lu,%lu", result->name, result->leds, result->digits,
+           (unsigned long)result->iterations, (unsigned long)result->ns_per_op);
+}
+
+bool bench_parse(const char *line, bench_result_t *result) {
+  char name[BENCH_NAME_LEN];
+  unsigned int leds, digits;
+  unsigned long iterations, ns_per_op;
+  if (sscanf(line, "%23[a-z0-9_],%u,%u,%lu,%lu", name, &leds, &digits, &iterations, &ns_per_op) != 5)
+    return false;
+
+  memset(result, 0, sizeof(*result));
+  snprintf(result->name, sizeof(result->name), "%s", name);
+  result->leds = (uint16_t)leds;
+  result->digits = (uint8_t)digits;
+  result->iterations = (uint32_t)iterations;
+  result->ns_per_op = (uint32_t)ns_per_op;
+  return true;
+}
+
+const bench_result_t *bench_find(const bench_result_t *baseline, size_t count, const bench_result_t *result) {
+  for (size_t i = 0; i < count; i++) {
+    if (strcmp(baseline[i].name, result->name) == 0 && baseline[i].leds == result->leds &&
+        baseline[i].digits == result->digits)
+      return &baseline[i];
+  }
+  return NULL;
+}
+
+bool bench_regressed(const bench_result_t *result, const bench_result_t *baseline, uint32_t tolerance_pct) {
+  return (uint64_t)result->ns_per_op * 100 > (uint64_t)baseline->ns_per_op * (100 + tolerance_pct);
+}
@@ -0,0 +1,224 @@
+#include "../include/channel_hop.h"
+#include <stdlib.h>
+#include <string.h>
+
+void channel_survey_reset(channel_survey_t *survey) {
+  memset(survey, 0, sizeof(*survey));
+}
+
+void channel_survey_add(channel_survey_t *survey, uint8_t channel, bool busy) {
+  if (channel >= CHANNEL_SURVEY_CHANNELS)
+    return;
+  int32_t reading = busy ? UINT16_MAX : 0;
+  if (!survey->sampled[channel]) {
+    survey->busy[channel] = reading;
+    survey->sampled[channel] = true;
+  } else {
+    survey->busy[channel] += (reading - survey->busy[channel]) / CHANNEL_SURVEY_WEIGHT;
+  }
+}
+
+uint8_t channel_survey_occupancy(const channel_survey_t *survey, uint8_t channel) {
+  if (channel >= CHANNEL_SURVEY_CHANNELS)
+    return 0;
+  return (uint8_t)((survey->busy[channel] * 100U + UINT16_MAX / 2) / UINT16_MAX);
+}
+
+uint16_t channel_survey_score(const channel_survey_t *survey, uint8_t channel) {
+  uint16_t score = 2 * channel_survey_occupancy(survey, channel);
+  if (channel > 0)
+    score += channel_survey_occupancy(survey, channel - 1);
+  if (channel + 1 < CHANNEL_SURVEY_CHANNELS)
+    score += channel_survey_occupancy(survey, channel + 1);
+  return score;
+}
+
+uint8_t channel_survey_best(const channel_survey_t *survey, const uint8_t *channels, uint8_t count,
+                            uint8_t exclude) {
+  uint8_t best = exclude;
+  uint16_t best_score = UINT16_MAX;
+  for (uint8_t i = 0; i < count; i++) {
+    if (channels[i] == exclude)
+      continue;
+    uint16_t score = channel_survey_score(survey, channels[i]);
+    if (score < best_score) {
+      best = channels[i];
+      best_score = score;
+    }
+  }
+  return best;
+}
+
+void channel_survey_format(const channel_survey_t *survey, char *map) {
+  for (int channel = 0; channel < CHANNEL_SURVEY_CHANNELS; channel++) {
+    uint8_t tens = (channel_survey_occupancy(survey, channel) + 5) / 10;
+    map[channel] = tens == 0 ? '.' : '0' + (tens < 9 ? tens : 9);
+  }
+  map[CHANNEL_SURVEY_CHANNELS] = '\0';
+}
+
+static uint8_t copy_set(uint8_t *set, const uint8_t *channels, uint8_t count) {
+  if (count > CHANNEL_HOP_MAX_SET)
+    count = CHANNEL_HOP_MAX_SET;
+  memcpy(set, channels, count);
+  return count;
+}
+
+void channel_hop_rx_init(channel_hop_rx_t *rx, const uint8_t *channels, uint8_t count, uint8_t channel,
+                         int64_t now_us) {
+  memset(rx, 0, sizeof(*rx));
+  rx->count = copy_set(rx->channels, channels, count);
+  rx->channel = channel;
+  rx->last_rx_us = now_us;
+}
+
+void channel_hop_rx_on_message(channel_hop_rx_t *rx, const radio_message_t *message, int64_t rx_us) {
+  rx->last_rx_us = rx_us;
+  rx->searching = false; // Found the controller
+
+  if (!(message->fields & RADIO_FIELD(RADIO_RECORD_HOP)))
+    return;
+  rx->stats.announcements++;
+  if (message->hop_channel >= CHANNEL_SURVEY_CHANNELS || message->hop_channel == rx->channel)
+    return;
+
+  // Every announcement restates the move; the newest one times it
+  rx->hop_pending = true;
+  rx->hop_channel = message->hop_channel;
+  rx->hop_at_us = rx_us + (int64_t)message->hop_delay_ms * 1000;
+}
+
+uint8_t channel_hop_rx_poll(channel_hop_rx_t *rx, int64_t now_us, int64_t *next_us) {
+  if (rx->hop_pending && now_us >= rx->hop_at_us) {
+    rx->channel = rx->hop_channel;
+    rx->hop_pending = false;
+    rx->stats.hops++;
+    rx->last_rx_us = now_us; // The new channel gets a full silence before a search
+  }
+
+  if (!rx->searching && !rx->hop_pending && rx->count > 0 &&
+      now_us - rx->last_rx_us >= (int64_t)CHANNEL_HOP_SEARCH_AFTER_MS * 1000) {
+    rx->searching = true;
+    rx->survey_due = true;
+    rx->search_index = 0;
+    rx->dwell_end_us = now_us;
+    rx->stats.searches++;
+  }
+
+  if (rx->searching && now_us >= rx->dwell_end_us) {
+    // Skip the channel just left when the set has others
+    uint8_t channel = rx->channels[rx->search_index++ % rx->count];
+    if (channel == rx->channel && rx->count > 1) {
+      channel = rx->channels[rx->search_index++ % rx->count];
+    }
+    rx->channel = channel;
+    rx->dwell_end_us = now_us + (int64_t)CHANNEL_HOP_DWELL_MS * 1000;
+    rx->stats.search_steps++;
+  }
+
+  if (next_us != NULL) {
+    if (rx->hop_pending) {
+      *next_us = rx->hop_at_us;
+    } else if (rx->searching) {
+      *next_us = rx->dwell_end_us;
+    } else {
+      *next_us = rx->last_rx_us + (int64_t)CHANNEL_HOP_SEARCH_AFTER_MS * 1000;
+    }
+  }
+  return rx->channel;
+}
+
+void channel_hop_rx_rank(channel_hop_rx_t *rx, const channel_survey_t *survey) {
+  // Stable insertion sort by score - the set is a handful of channels
+  for (uint8_t i = 1; i < rx->count; i++) {
+    uint8_t channel = rx->channels[i];
+    uint16_t score = channel_survey_score(survey, channel);
+    uint8_t j = i;
+    while (j > 0 && channel_survey_score(survey, rx->channels[j - 1]) > score) {
+      rx->channels[j] = rx->channels[j - 1];
+      j--;
+    }
+    rx->channels[j] = channel;
+  }
+  rx->search_index = 0;
+  rx->survey_due = false;
+}
+
+void channel_hop_tx_init(channel_hop_tx_t *tx, const uint8_t *channels, uint8_t count, uint8_t channel,
+                         int64_t now_us) {
+  memset(tx, 0, sizeof(*tx));
+  tx->count = copy_set(tx->channels, channels, count);
+  tx->channel = channel;
+  tx->last_ack_us = now_us;
+  tx->holdoff_until_us = now_us;
+}
+
+void channel_hop_tx_on_frame(channel_hop_tx_t *tx, bool acked, const channel_survey_t *survey, int64_t now_us) {
+  tx->history = (tx->history << 1) | (acked ? 0 : 1);
+  if (tx->history_frames < CHANNEL_HOP_WINDOW_FRAMES)
+    tx->history_frames++;
+
+  uint32_t lost = (uint32_t)__builtin_popcount(tx->history);
+  tx->stats.loss_percent = lost * 100 / tx->history_frames;
+
+  if (acked) {
+    tx->last_ack_us = now_us;
+    // The clock heard this frame's announcement: the move time it stated holds
+    if (tx->announcing)
+      tx->confirmed = true;
+  }
+
+  // A burst counts at once: the window would take most of the clock's search
+  // silence to notice a channel that went bad, too late to tell the clock
+  uint32_t burst_mask = (1U << CHANNEL_HOP_BURST_FRAMES) - 1;
+  bool burst = (tx->history & burst_mask) == burst_mask;
+  if (tx->announcing || now_us < tx->holdoff_until_us || tx->history_frames < CHANNEL_HOP_MIN_FRAMES ||
+      (tx->stats.loss_percent < CHANNEL_HOP_LOSS_PERCENT && !burst))
+    return;
+
+  // Interference that reached the current channel is often wideband (Wi-Fi)
+  // and may not show in the survey yet: prefer a channel out of its reach
+  uint8_t far[CHANNEL_HOP_MAX_SET];
+  uint8_t far_count = 0;
+  for (uint8_t i = 0; i < tx->count; i++) {
+    if (abs(tx->channels[i] - tx->channel) >= CHANNEL_HOP_MIN_SPACING)
+      far[far_count++] = tx->channels[i];
+  }
+  uint16_t current_score = channel_survey_score(survey, tx->channel);
+  uint8_t target = channel_survey_best(survey, far, far_count, tx->channel);
+  if (target == tx->channel || channel_survey_score(survey, target) + CHANNEL_HOP_MIN_GAIN > current_score) {
+    target = channel_survey_best(survey, tx->channels, tx->count, tx->channel);
+  }
+  if (target == tx->channel || channel_survey_score(survey, target) + CHANNEL_HOP_MIN_GAIN > current_score)
+    return;
+  tx->announcing = true;
+  tx->confirmed = false;
+  tx->hop_channel = target;
+}
+
+uint8_t channel_hop_tx_prepare(channel_hop_tx_t *tx, radio_message_t *message, int64_t now_us) {
+  // No ACK for the clock's search silence: it is looking for us, moving won't strand it
+  bool clock_searching = now_us - tx->last_ack_us >= (int64_t)CHANNEL_HOP_SEARCH_AFTER_MS * 1000;
+  if (tx->announcing && ((tx->confirmed && now_us >= tx->hop_at_us) || (!tx->confirmed && clock_searching))) {
+    if (!tx->confirmed)
+      tx->stats.unconfirmed++;
+    tx->channel = tx->hop_channel;
+    tx->announcing = false;
+    tx->history = 0;
+    tx->history_frames = 0;
+    tx->holdoff_until_us = now_us + (int64_t)CHANNEL_HOP_HOLDOFF_MS * 1000;
+    tx->stats.hops++;
+  }
+
+  if (tx->announcing) {
+    // Unconfirmed, the delay restarts with every frame - whichever one the clock
+    // hears and ACKs sets the move time
+    if (!tx->confirmed)
+      tx->hop_at_us = now_us + (int64_t)CHANNEL_HOP_ANNOUNCE_MS * 1000;
+    message->fields |= RADIO_FIELD(RADIO_RECORD_HOP);
+    message->hop_channel = tx->hop_channel;
+    message->hop_delay_ms = (uint16_t)((tx->hop_at_us - now_us) / 1000);
+    tx->stats.announcements++;
+  }
+  return tx->channel;
+}
@@ -0,0 +1,218 @@
+#include "../include/clock_engine.h"
+#include <limits.h>
+#include <string.h>
+
+void clock_engine_init(clock_engine_t *engine) {
+  memset(engine, 0, sizeof(*engine));
+  engine->rate = 1.0f;
+}
+
+static int32_t slew_applied(const clock_engine_t *engine, int64_t now_us) {
+  if (engine->slew_ms == 0)
+    return 0;
+
+  int64_t elapsed_us = now_us - engine->slew_start_us;
+  if (elapsed_us >= (int64_t)CLOCK_ENGINE_SLEW_MS * 1000)
+    return engine->slew_ms;
+  return (int32_t)(engine->slew_ms * elapsed_us / ((int64_t)CLOCK_ENGINE_SLEW_MS * 1000));
+}
+
+// Controller milliseconds left on the clock at now_us according to the local model
+static int32_t remaining_ms(const clock_engine_t *engine, int64_t now_us) {
+  if (!engine->running)
+    return engine->anchor_ms;
+
+  float elapsed_ms = (now_us - engine->anchor_us) / 1000.0f * engine->rate;
+  return engine->anchor_ms - (int32_t)elapsed_ms + slew_applied(engine, now_us);
+}
+
+// Move the anchor to now_us, carrying over the part of the slew not applied yet
+static void rebase(clock_engine_t *engine, int64_t now_us) {
+  int32_t remaining = remaining_ms(engine, now_us);
+  int32_t pending = engine->slew_ms - slew_applied(engine, now_us);
+  engine->anchor_ms = remaining;
+  engine->anchor_us = now_us;
+  engine->slew_ms = pending;
+  engine->slew_start_us = now_us;
+}
+
+static void hold(clock_engine_t *engine, uint16_t seconds, int64_t now_us) {
+  engine->running = false;
+  engine->anchor_ms = seconds * 1000;
+  engine->anchor_us = now_us;
+  engine->slew_ms = 0;
+}
+
+// Start counting down from the top of `seconds` - the phase is unknown until
+// the next boundary
+static void start(clock_engine_t *engine, uint16_t seconds, int64_t now_us) {
+  hold(engine, seconds, now_us);
+  engine->running = true;
+}
+
+// Pull the model into [low, high] - slewed, or at once for large errors
+static void correct(clock_engine_t *engine, int32_t low, int32_t high, int64_t now_us) {
+  int32_t projected = engine->anchor_ms + engine->slew_ms; // After the pending slew
+  int32_t target = projected < low ? low : (projected > high ? high : projected);
+  int32_t error = target - projected;
+  if (error == 0)
+    return;
+
+  if (error > CLOCK_ENGINE_SNAP_MS || error < -CLOCK_ENGINE_SNAP_MS) {
+    engine->anchor_ms = target;
+    engine->slew_ms = 0;
+    engine->stats.snaps++;
+    return;
+  }
+  engine->slew_ms += error;
+  engine->slew_start_us = now_us;
+  engine->stats.corrections++;
+}
+
+// gap_us is the packet gap the flip to `seconds` happened in
+static void update_rate(clock_engine_t *engine, uint16_t seconds, int64_t now_us, int64_t gap_us) {
+  int64_t flip_us = now_us - gap_us / 2;
+  if (!engine->have_rate_base) {
+    engine->have_rate_base = true;
+    engine->rate_base_us = flip_us;
+    engine->rate_base_gap_us = gap_us;
+    engine->rate_base_seconds = seconds;
+    return;
+  }
+
+  // Flip times are known to +/- half their gap each
+  int64_t span_us = flip_us - engine->rate_base_us;
+  int64_t uncertainty_us = (engine->rate_base_gap_us + gap_us) / 2;
+  if (span_us < (int64_t)CLOCK_ENGINE_RATE_MIN_SPAN_MS * 1000 ||
+      span_us < uncertainty_us * CLOCK_ENGINE_RATE_SPAN_FACTOR)
+    return;
+
+  float rate = (engine->rate_base_seconds - seconds) * 1000000.0f / span_us;
+  if (rate < 1.0f - CLOCK_ENGINE_RATE_LIMIT)
+    rate = 1.0f - CLOCK_ENGINE_RATE_LIMIT;
+  if (rate > 1.0f + CLOCK_ENGINE_RATE_LIMIT)
+    rate = 1.0f + CLOCK_ENGINE_RATE_LIMIT;
+  engine->rate = rate;
+}
+
+void clock_engine_on_packet(clock_engine_t *engine, uint16_t seconds, clock_run_state_t run_state, int64_t now_us) {
+  engine->stats.packets++;
+  int64_t gap_us = now_us - engine->anchor_us; // Time since the previous packet
+  bool had_value = engine->valid && !engine->blank;
+  uint16_t previous = engine->packet_seconds;
+  engine->valid = true;
+  engine->packet_seconds = seconds;
+
+  if (seconds == CLOCK_ENGINE_BLANK) {
+    engine->blank = true;
+    engine->have_rate_base = false;
+    hold(engine, 0, now_us);
+    return;
+  }
+  engine->blank = false;
+
+  if (run_state == CLOCK_RUN_STOPPED) {
+    engine->have_rate_base = false;
+    hold(engine, seconds, now_us);
+    return;
+  }
+  if (!had_value) {
+    if (run_state == CLOCK_RUN_RUNNING) {
+      start(engine, seconds, now_us);
+    } else {
+      hold(engine, seconds, now_us);
+    }
+    return;
+  }
+
+  rebase(engine, now_us);
+  int32_t high = seconds * 1000;
+  int32_t low = seconds > 0 ? high - 1000 + 1 : 0;
+  int delta = (int)previous - (int)seconds;
+
+  // Counting down: up to one step per second since the last packet (+1 for
+  // a boundary just missed)
+  int max_steps = (int)(gap_us / 1000000) + 1;
+  if (delta >= 1 && delta <= max_steps) {
+    if (!engine->running) {
+      // Starting: the clock flipped some time since the last packet
+      engine->running = true;
+      engine->anchor_ms = high;
+      engine->slew_ms = 0;
+    }
+
+    // The flip to `seconds` happened after the previous packet
+    int32_t since_flip_ms = (int32_t)(gap_us / 1000);
+    if (high - since_flip_ms > low) {
+      low = high - since_flip_ms;
+    }
+    engine->stats.boundaries++;
+    engine->stats.last_error_ms = engine->anchor_ms + engine->slew_ms - high;
+    correct(engine, low, high, now_us);
+    update_rate(engine, seconds, now_us, gap_us);
+    return;
+  }
+
+  if (delta == 0) {
+    if (!engine->running) {
+      if (run_state == CLOCK_RUN_RUNNING) {
+        start(engine, seconds, now_us);
+      } else {
+        hold(engine, seconds, now_us);
+      }
+      return;
+    }
+
+    // Known to be running: both bounds hold
+    if (run_state == CLOCK_RUN_RUNNING) {
+      correct(engine, low, high, now_us);
+      return;
+    }
+
+    // Still on the same value well past the flip we expected - clock stopped.
+    // Being a little ahead is left for the next boundary to correct, so the
+    // lower bound is not enforced here.
+    int32_t stop_threshold = low - 1 - (int32_t)(CLOCK_ENGINE_STOP_GRACE_MS * engine->rate);
+    if (engine->anchor_ms + engine->slew_ms < stop_threshold) {
+      engine->have_rate_base = false;
+      hold(engine, seconds, now_us);
+      return;
+    }
+    correct(engine, INT32_MIN, high, now_us);
+    return;
+  }
+
+  // Value went up or jumped: clock was reset or set. Without a run state,
+  // hold it until the controller shows it counting again.
+  engine->stats.snaps++;
+  engine->have_rate_base = false;
+  if (run_state == CLOCK_RUN_RUNNING) {
+    start(engine, seconds, now_us);
+  } else {
+    hold(engine, seconds, now_us);
+  }
+}
+
+uint16_t clock_engine_seconds(const clock_engine_t *engine, int64_t now_us) {
+  if (!engine->valid || engine->blank)
+    return CLOCK_ENGINE_BLANK;
+  if (!engine->running)
+    return engine->packet_seconds;
+
+  int32_t remaining = remaining_ms(engine, now_us);
+  if (remaining <= 0)
+    return 0;
+  return (uint16_t)((remaining + 999) / 1000);
+}
+
+int64_t clock_engine_us_to_next_flip(const clock_engine_t *engine, int64_t now_us) {
+  if (!engine->valid || engine->blank || !engine->running)
+    return -1;
+
+  int32_t remaining = remaining_ms(engine, now_us);
+  if (remaining <= 0)
+    return -1;
+
+  int32_t next_boundary = ((remaining + 999) / 1000 - 1) * 1000;
+  return (int64_t)((remaining - next_boundary) * 1000 / engine->rate);
+}
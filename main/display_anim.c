@@ -0,0 +1,177 @@
+#include "../include/display_anim.h"
+#include <string.h>
+
+void anim_init(anim_engine_t *anim, const compiled_layout_t *layout) {
+  memset(anim, 0, sizeof(*anim));
+  anim->layout = layout;
+  anim->transition_us = 1;
+  anim->effect_period_us = 1;
+  for (int i = 0; i < LAYOUT_ELEMENTS; i++) {
+    anim->elements[i].drawn = ANIM_NOT_DRAWN;
+  }
+}
+
+void anim_set_transition(anim_engine_t *anim, anim_transition_t transition, uint32_t duration_us) {
+  anim->transition = transition;
+  anim->transition_us = duration_us > 0 ? duration_us : 1;
+}
+
+void anim_set_effect(anim_engine_t *anim, anim_effect_t effect, uint32_t period_us, int64_t now_us) {
+  if (effect == anim->effect && period_us == anim->effect_period_us)
+    return;
+  anim->effect = effect;
+  anim->effect_period_us = period_us > 0 ? period_us : 1;
+  anim->effect_start_us = now_us;
+}
+
+void anim_set_colors(anim_engine_t *anim, const uint8_t lit[3], const uint8_t off[3]) {
+  if (memcmp(anim->lit_rgb, lit, 3) == 0 && memcmp(anim->off_rgb, off, 3) == 0)
+    return;
+  memcpy(anim->lit_rgb, lit, 3);
+  memcpy(anim->off_rgb, off, 3);
+  for (int i = 0; i < LAYOUT_ELEMENTS; i++) {
+    anim->elements[i].drawn = ANIM_NOT_DRAWN;
+  }
+}
+
+// How an element looks: LEDs lit along its run and their level. Equal keys
+// draw identical pixels, so unchanged elements are skipped.
+static uint32_t draw_key(const anim_engine_t *anim, uint16_t led_count, uint16_t level, uint16_t effect) {
+  uint32_t lit = led_count;
+  uint32_t shade;
+  if (anim->transition == ANIM_TRANSITION_WIPE) {
+    lit = (led_count * level + ANIM_LEVEL_FULL / 2) / ANIM_LEVEL_FULL;
+    shade = effect;
+  } else {
+    shade = (uint32_t)level * effect / ANIM_LEVEL_FULL;
+  }
+  if (lit == 0 || shade == 0)
+    return 0;
+  return lit << 9 | shade;
+}
+
+static void element_draw(const anim_engine_t *anim, uint8_t *pixels, int element, uint32_t key, bool *changed,
+                         int32_t *sum_delta) {
+  segment_range_t range = layout_element_range(anim->layout, element);
+  uint16_t lit = key >> 9;
+  uint16_t shade = key & 0x1FF;
+
+  uint8_t rgb[3];
+  for (int c = 0; c < 3; c++) {
+    rgb[c] = anim->off_rgb[c] + ((anim->lit_rgb[c] - anim->off_rgb[c]) * shade) / ANIM_LEVEL_FULL;
+  }
+
+  // Wipes grow in drawing direction, which is against the data on reversed runs
+  segment_range_t on = {range.start, lit};
+  segment_range_t dark = {range.start + lit, range.count - lit};
+  if (layout_element_reversed(anim->layout, element)) {
+    dark.start = range.start;
+    on.start = range.start + dark.count;
+  }
+  *changed |= render_fill_spans(pixels, &on, 1, rgb, sum_delta);
+  *changed |= render_fill_spans(pixels, &dark, 1, anim->off_rgb, sum_delta);
+}
+
+// Transition level at now_us; ends the transition once it has run its course
+static uint16_t element_level(anim_engine_t *anim, anim_element_t *e, int64_t now_us) {
+  uint16_t to = e->target ? ANIM_LEVEL_FULL : 0;
+  if (!e->moving)
+    return to;
+
+  int64_t elapsed = now_us - e->start_us;
+  if (elapsed >= anim->transition_us) {
+    e->moving = false;
+    anim->moving_count--;
+    return to;
+  }
+  if (elapsed <= 0)
+    return e->from;
+
+  int32_t progress = (int32_t)(elapsed * ANIM_LEVEL_FULL / anim->transition_us);
+  return e->from + ((int32_t)to - e->from) * progress / ANIM_LEVEL_FULL;
+}
+
+// Effect level at now_us, ANIM_LEVEL_FULL without an effect
+static uint16_t effect_level(const anim_engine_t *anim, int64_t now_us) {
+  if (anim->effect == ANIM_EFFECT_NONE)
+    return ANIM_LEVEL_FULL;
+
+  int64_t period = anim->effect_period_us;
+  int64_t phase = (now_us - anim->effect_start_us) % period;
+  if (phase < 0)
+    phase += period;
+
+  if (anim->effect == ANIM_EFFECT_FLASH)
+    return phase < period / 2 ? ANIM_LEVEL_FULL : 0;
+
+  // Triangle from full down to the floor and back
+  int64_t distance = phase * 2 < period ? period - phase * 2 : phase * 2 - period;
+  return ANIM_PULSE_FLOOR + (ANIM_LEVEL_FULL - ANIM_PULSE_FLOOR) * distance / period;
+}
+
+void anim_sync(anim_engine_t *anim, uint64_t mask) {
+  anim->lit_count = 0;
+  for (int i = 0; i < LAYOUT_ELEMENTS; i++) {
+    anim_element_t *e = &anim->elements[i];
+    uint16_t led_count = layout_element_range(anim->layout, i).count;
+    e->target = (mask >> i) & 1;
+    e->moving = false;
+    e->from = e->target ? ANIM_LEVEL_FULL : 0;
+    e->drawn = draw_key(anim, led_count, e->from, ANIM_LEVEL_FULL);
+    if (e->target && led_count > 0) {
+      anim->lit_count++;
+    }
+  }
+  anim->moving_count = 0;
+}
+
+void anim_set_mask(anim_engine_t *anim, uint64_t mask, int64_t now_us) {
+  for (int i = 0; i < LAYOUT_ELEMENTS; i++) {
+    anim_element_t *e = &anim->elements[i];
+    bool lit = (mask >> i) & 1;
+    if (lit == e->target || layout_element_range(anim->layout, i).count == 0)
+      continue;
+    if (lit) {
+      anim->lit_count++;
+    } else {
+      anim->lit_count--;
+    }
+
+    if (anim->transition == ANIM_TRANSITION_CUT) {
+      if (e->moving) {
+        e->moving = false;
+        anim->moving_count--;
+      }
+      e->target = lit;
+      continue;
+    }
+
+    // Reversing mid-transition starts from the level reached so far
+    e->from = element_level(anim, e, now_us);
+    e->target = lit;
+    e->start_us = now_us;
+    if (!e->moving) {
+      e->moving = true;
+      anim->moving_count++;
+    }
+  }
+}
+
+bool anim_render(anim_engine_t *anim, uint8_t *pixels, int64_t now_us, int32_t *sum_delta) {
+  uint16_t effect = effect_level(anim, now_us);
+  bool changed = false;
+
+  for (int i = 0; i < LAYOUT_ELEMENTS; i++) {
+    anim_element_t *e = &anim->elements[i];
+    uint16_t led_count = layout_element_range(anim->layout, i).count;
+    if (led_count == 0)
+      continue;
+
+    uint32_t key = draw_key(anim, led_count, element_level(anim, e, now_us), effect);
+    if (key != e->drawn) {
+      element_draw(anim, pixels, i, key, &changed, sum_delta);
+      e->drawn = key;
+    }
+  }
+  return changed;
+}
@@ -1,18 +1,15 @@
 #include "../include/display_driver.h"
+#include "../include/display_anim.h"
+#include "../include/latency_trace.h"
 #include "../include/led_strip_encoder.h"
+#include "../include/platform.h"
+#include "../include/power_limit.h"
 #include "esp_log.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
-#include "driver/gpio.h"
-#include "driver/rmt_tx.h"
 #include <stdlib.h>
 #include <string.h>
 
 static const char *TAG = "DISPLAY_DRIVER";
 
-// RMT configuration for WS2815
-#define RMT_LED_STRIP_RESOLUTION_HZ 10000000 // 10MHz resolution, 1 tick = 0.1us
-
 // Test pattern timing constants (milliseconds)
 #define TEST_COLOR_DELAY_MS 1000
 #define TEST_SEGMENT_DELAY_MS 300
@@ -21,164 +18,452 @@ static const char *TAG = "DISPLAY_DRIVER";
 #define TEST_LED_OFF_DELAY_MS 200
 #define NUMBER_CYCLE_DELAY_MS 200
 
-// Brightness levels for test patterns
-#define TEST_COLOR_BRIGHTNESS 100
-#define TEST_WHITE_BRIGHTNESS 50
-
-// 7-segment digit patterns (0-9)
-// Each bit represents a segment: A,B,C,D,E,F,G
-static const uint8_t digit_patterns[10] = {
-  0x3F, // 0: A+B+C+D+E+F
-  0x06, // 1: B+C
-  0x5B, // 2: A+B+G+E+D
-  0x4F, // 3: A+B+C+D+G
-  0x66, // 4: F+G+B+C
-  0x6D, // 5: A+F+G+C+D
-  0x7D, // 6: A+F+G+C+D+E
-  0x07, // 7: A+B+C
-  0x7F, // 8: A+B+C+D+E+F+G
-  0x6F  // 9: A+B+C+D+F+G
-};
-
-// LED strip buffer
-static uint8_t led_buffer[LED_COUNT * 3]; // RGB buffer for RMT
+// Linear levels for test patterns, on top of the display brightness
+#define TEST_COLOR_LEVEL 100
+#define TEST_WHITE_LEVEL 50
+#define FILL_LEVEL_FULL 255
+
+// LED strip framebuffers, RGB as drawn - brightness, gamma and channel order
+// are applied by the transports through wire_map as a frame is sent. Rendering always targets the back
+// buffer (led_buffer); the front buffer is owned by the RMT channel while a
+// frame is on the wire and is swapped in display_update().
+static uint8_t led_buffers[2][LED_COUNT * 3];
+static uint8_t *led_buffer = led_buffers[0];
+static int back_index = 0;
+
+// Set whenever a write changes led_buffer; cleared once the frame is submitted
+static bool led_buffer_dirty = true;
+
+// Sum of each channel's values in led_buffer, kept up to date by the fill
+// functions for the power estimate. Both buffers hold the same frame after a
+// swap, so it follows led_buffer across swaps.
+static int32_t channel_sum[3] = {0, 0, 0};
+static power_limit_t power;
+
+// Transmit state shared with the transport done callbacks; a frame is on the
+// wire until every output chain has reported completion
+static volatile bool tx_in_flight = false;
+static volatile uint8_t tx_outputs_pending = 0;
+static volatile int64_t tx_start_us = 0;
+static platform_signal_t tx_done_signal = NULL;
 
 // Display driver mutex for thread-safe operations
-static SemaphoreHandle_t display_mutex = NULL;
-
-// LED offset constants for segment positioning
-#define SEGMENT_A_OFFSET 0
-#define SEGMENT_B_OFFSET 15
-#define SEGMENT_C_OFFSET 45
-#define SEGMENT_D_OFFSET 75
-#define SEGMENT_E_OFFSET 90
-#define SEGMENT_F_OFFSET 120
-#define SEGMENT_G_OFFSET 150
-// Physical LED base positions for each digit (actual wiring)
-#define DIGIT_0_BASE 0    // Digit 0 starts at LED 0
-#define DIGIT_1_BASE 165  // Digit 1 starts at LED 165
-
-// Initialize segment-to-LED mapping for 2-digit display
-static void init_segment_mapping(PlayClockDisplay *display) {
-  // Digit 0 (left digit) - uses LEDs 0-164
-  // Digit 1 (right digit) - uses LEDs 165-329
-  
-  // Define actual base positions for each digit
-  uint16_t digit_base[PLAY_CLOCK_DIGITS] = {DIGIT_0_BASE, DIGIT_1_BASE};
-  
-  for (int digit = 0; digit < PLAY_CLOCK_DIGITS; digit++) {
-    uint16_t base_offset = digit_base[digit];
-    
-    // Segment A (top horizontal) - 15 LEDs
-    display->segments[digit][SEGMENT_A] = (segment_range_t){base_offset + SEGMENT_A_OFFSET, LEDS_PER_SEGMENT_HORIZONTAL};
-    
-    // Segment B (upper right vertical) - 30 LEDs  
-    display->segments[digit][SEGMENT_B] = (segment_range_t){base_offset + SEGMENT_B_OFFSET, LEDS_PER_SEGMENT_VERTICAL};
-    
-    // Segment C (lower right vertical) - 30 LEDs
-    display->segments[digit][SEGMENT_C] = (segment_range_t){base_offset + SEGMENT_C_OFFSET, LEDS_PER_SEGMENT_VERTICAL};
-    
-    // Segment D (bottom horizontal) - 15 LEDs
-    display->segments[digit][SEGMENT_D] = (segment_range_t){base_offset + SEGMENT_D_OFFSET, LEDS_PER_SEGMENT_HORIZONTAL};
-    
-    // Segment E (lower left vertical) - 30 LEDs
-    display->segments[digit][SEGMENT_E] = (segment_range_t){base_offset + SEGMENT_E_OFFSET, LEDS_PER_SEGMENT_VERTICAL};
-    
-    // Segment F (upper left vertical) - 30 LEDs
-    display->segments[digit][SEGMENT_F] = (segment_range_t){base_offset + SEGMENT_F_OFFSET, LEDS_PER_SEGMENT_VERTICAL};
-    
-    // Segment G (middle horizontal) - 15 LEDs
-    display->segments[digit][SEGMENT_G] = (segment_range_t){base_offset + SEGMENT_G_OFFSET, LEDS_PER_SEGMENT_HORIZONTAL};
+static platform_mutex_t display_mutex = NULL;
+
+#if DISPLAY_SYMBOL_CACHE
+// Pre-encoded RMT symbols for glyph frames: one lit and one dark run as long as
+// the longest segment or indicator. Every element's run is a prefix of one of
+// them, so a frame for a segment mask is assembled as a span list without
+// running the bit encoder.
+#define SYMBOLS_PER_LED 24
+#define SYMBOL_CACHE_ELEMENTS LAYOUT_ELEMENTS
+#define SYMBOL_CACHE_MAX_SPANS (SYMBOL_CACHE_ELEMENTS * 2 + 8)
+
+typedef struct {
+  bool valid;      // Runs match key_rgb and the current wire_map
+  bool layout_ok;  // Segments don't overlap - frames can be assembled from spans
+  uint8_t key_rgb[3];
+  uint16_t run_leds;
+  rmt_symbol_word_t *lit_run;
+  rmt_symbol_word_t *dark_run;
+  uint8_t order[SYMBOL_CACHE_ELEMENTS]; // Fitted elements sorted by start LED
+  uint8_t element_count;
+  led_symbol_span_t spans[2][DISPLAY_MAX_OUTPUTS][SYMBOL_CACHE_MAX_SPANS]; // Per framebuffer and output
+} symbol_cache_t;
+
+static symbol_cache_t symbol_cache;
+#endif
+
+// True while led_buffer holds exactly the glyph described by segment_mask
+static bool glyph_frame = false;
+
+// Segment transitions and effects; while animating, display_animate() draws
+// each frame and led_buffer is not a plain glyph
+static anim_engine_t anim;
+static bool animating = false;
+
+// Color pipeline tables at the display brightness; rebuilt only when
+// brightness or calibration changes
+static color_lut_t color_lut;
+
+// Framebuffer to wire bytes: color_lut at the power limit, in DISPLAY_COLOR_ORDER.
+// The encoders read it while a frame is on the wire, so changes only mark it
+// stale and it is rebuilt before the next frame is submitted.
+static wire_map_t wire_map;
+static bool wire_map_stale = true;
+
+// Layout override written by display_store_layout(), read at boot
+#define LAYOUT_STORAGE_NAMESPACE "display"
+#define LAYOUT_STORAGE_KEY "layout"
+
+// Resend an unchanged frame at this interval so the strip recovers from glitches
+#define DISPLAY_KEEPALIVE_MS 1000
+
+// A dark frame is on the strip: keepalives stop until something is drawn, so a
+// blank display sends nothing and the render task can idle
+static bool dark_on_wire = false;
+
+// Lay the output chains out back to back in the framebuffer
+static bool init_outputs(PlayClockDisplay *display) {
+  const gpio_num_t pins[] = DISPLAY_OUTPUT_PINS;
+  const uint16_t strip_leds[] = DISPLAY_OUTPUT_STRIP_LEDS;
+  uint32_t first_led = 0;
+
+  display->output_count = DISPLAY_OUTPUT_COUNT;
+  for (int out = 0; out < display->output_count; out++) {
+    display->outputs[out].gpio_num = pins[out];
+    display->outputs[out].first_led = first_led;
+    display->outputs[out].strip_leds = strip_leds[out];
+    first_led += strip_leds[out];
   }
+  if (first_led > LED_COUNT) {
+    ESP_LOGE(TAG, "Output chains need %lu LEDs, framebuffer holds %d", (unsigned long)first_led, LED_COUNT);
+    return false;
+  }
+  return true;
 }
 
-// Set LED color in buffer (RGB format for RMT encoder) - thread-safe
-static void set_led_color(uint16_t led_index, color_t color, uint8_t brightness) {
-  if (led_index < LED_COUNT) {
-    uint8_t r = (color.r * brightness) / 255;
-    uint8_t g = (color.g * brightness) / 255;
-    uint8_t b = (color.b * brightness) / 255;
-    
-    // WS2815 uses RGB format
-    led_buffer[led_index * 3 + 0] = r; // Red
-    led_buffer[led_index * 3 + 1] = g; // Green  
-    led_buffer[led_index * 3 + 2] = b; // Blue
+// Chain geometry the layout is compiled against
+static int layout_outputs(const PlayClockDisplay *display, layout_output_t *outputs) {
+  for (int out = 0; out < display->output_count; out++) {
+    outputs[out] = (layout_output_t){display->outputs[out].first_led, display->outputs[out].strip_leds};
   }
+  return display->output_count;
 }
 
-// Helper function to fill all LEDs with a specific color - thread-safe
-static void fill_all_leds(color_t color, uint8_t brightness) {
-  for (int i = 0; i < LED_COUNT; i++) {
-    set_led_color(i, color, brightness);
+// Compile a layout for this display; logs and returns false if it doesn't fit
+static bool compile_layout(const PlayClockDisplay *display, const display_layout_t *layout,
+                           compiled_layout_t *compiled, const char *source) {
+  layout_output_t outputs[LAYOUT_MAX_OUTPUTS];
+  const char *error = display_layout_compile(layout, outputs, layout_outputs(display, outputs), compiled);
+  if (error != NULL) {
+    ESP_LOGE(TAG, "%s layout rejected: %s", source, error);
+    return false;
+  }
+  return true;
+}
+
+// Stored layout, if there is a valid one
+static bool load_stored_layout(display_layout_t *layout) {
+  size_t size = sizeof(*layout);
+  if (!platform_storage_load(LAYOUT_STORAGE_NAMESPACE, LAYOUT_STORAGE_KEY, layout, &size))
+    return false;
+  if (size != sizeof(*layout) || layout->version != LAYOUT_VERSION) {
+    ESP_LOGW(TAG, "Ignoring stored layout (size %u, version %d)", (unsigned)size, layout->version);
+    return false;
   }
+  return true;
 }
 
+// Compile the stored layout, falling back to the built-in wiring
+static bool init_layout(PlayClockDisplay *display) {
+  static display_layout_t layout; // Kept off the init task stack
+  bool compiled = false;
+
+  if (load_stored_layout(&layout)) {
+    compiled = compile_layout(display, &layout, &display->layout, "Stored");
+    if (compiled)
+      ESP_LOGI(TAG, "Using stored layout");
+  }
+  if (!compiled) {
+    const uint8_t digit_outputs[DISPLAY_DIGIT_COUNT] = DISPLAY_DIGIT_OUTPUTS;
+    const uint16_t digit_bases[DISPLAY_DIGIT_COUNT] = DISPLAY_DIGIT_BASES;
+    const layout_indicator_t separator = DISPLAY_SEPARATOR_LEDS;
+    display_layout_default(&layout, DISPLAY_DIGIT_COUNT, digit_outputs, digit_bases);
+    if (separator.count > 0) {
+      layout.indicators[LAYOUT_SEPARATOR] = separator;
+      layout.indicator_count = LAYOUT_SEPARATOR + 1;
+    }
+    if (!compile_layout(display, &layout, &display->layout, "Built-in"))
+      return false;
+  }
+
+  display->layout_source = layout;
+
+  // Only the prefix of each chain the layout uses is transmitted
+  for (int out = 0; out < display->output_count; out++) {
+    display->outputs[out].active_leds = display->layout.output_active[out];
+  }
+  display->active_led_count = display->layout.led_end;
+  ESP_LOGI(TAG, "Layout: %d digits, %d indicators, %d glyph spans", display->layout.digit_count,
+           display->layout.indicator_count, display->layout.span_count);
+  return true;
+}
+
+// Add a fill's per-channel change to the running sums
+static void add_channel_delta(const int32_t delta[3]) {
+  channel_sum[0] += delta[0];
+  channel_sum[1] += delta[1];
+  channel_sum[2] += delta[2];
+}
+
+// Fill a run of LEDs with a color at a linear level (FILL_LEVEL_FULL = as is)
+static void fill_led_range(uint16_t start, uint16_t count, color_t color, uint8_t level) {
+  glyph_frame = false;
+  animating = false; // The animation no longer knows what the buffer shows
+
+  uint8_t rgb[3] = {color.r * level / FILL_LEVEL_FULL, color.g * level / FILL_LEVEL_FULL,
+                    color.b * level / FILL_LEVEL_FULL};
+  int32_t delta[3] = {0, 0, 0};
+  if (render_fill(led_buffer, LED_COUNT, start, count, rgb, delta)) {
+    led_buffer_dirty = true;
+    add_channel_delta(delta);
+  }
+}
+
+// Set LED color in buffer - thread-safe
+static void set_led_color(uint16_t led_index, color_t color, uint8_t level) {
+  fill_led_range(led_index, 1, color, level);
+}
 
+// Helper function to fill all LEDs with a specific color - thread-safe
+static void fill_all_leds(color_t color, uint8_t level) {
+  fill_led_range(0, LED_COUNT, color, level);
+}
 
 // Set segment LEDs - thread-safe
 static void set_segment_leds(PlayClockDisplay *display, uint8_t digit, segment_t segment, color_t color) {
-  if (digit >= PLAY_CLOCK_DIGITS || segment >= SEGMENTS_PER_DIGIT) return;
+  if (digit >= display->layout.digit_count || segment >= SEGMENTS_PER_DIGIT) return;
   
-  segment_range_t range = display->segments[digit][segment];
-  for (uint16_t i = 0; i < range.count; i++) {
-    set_led_color(range.start + i, color, display->brightness);
+  segment_range_t range = display->layout.segments[digit][segment];
+  fill_led_range(range.start, range.count, color, FILL_LEVEL_FULL);
+}
+
+#if DISPLAY_SYMBOL_CACHE
+// Allocate the symbol runs and sort the fitted elements by strip position
+static bool symbol_cache_init(PlayClockDisplay *display) {
+  uint16_t run_leds = 0;
+
+  symbol_cache.element_count = 0;
+  for (int idx = 0; idx < SYMBOL_CACHE_ELEMENTS; idx++) {
+    segment_range_t range = layout_element_range(&display->layout, idx);
+    if (range.count == 0)
+      continue; // Digit or indicator not fitted
+    if (range.count > run_leds) {
+      run_leds = range.count;
+    }
+
+    // Insertion sort by start LED
+    int j = symbol_cache.element_count++;
+    while (j > 0) {
+      uint8_t prev = symbol_cache.order[j - 1];
+      if (layout_element_range(&display->layout, prev).start <= range.start) {
+        break;
+      }
+      symbol_cache.order[j] = prev;
+      j--;
+    }
+    symbol_cache.order[j] = idx;
+  }
+
+  // Overlapping elements can't be expressed as a span list
+  symbol_cache.layout_ok = true;
+  uint16_t next_free = 0;
+  for (int i = 0; i < symbol_cache.element_count; i++) {
+    segment_range_t range = layout_element_range(&display->layout, symbol_cache.order[i]);
+    if (range.start < next_free) {
+      symbol_cache.layout_ok = false;
+    }
+    next_free = range.start + range.count;
+  }
+
+  if (symbol_cache.lit_run == NULL) {
+    size_t run_bytes = run_leds * SYMBOLS_PER_LED * sizeof(rmt_symbol_word_t);
+    // The copy encoder reads these from the RMT ISR, keep them in internal RAM
+    symbol_cache.lit_run = platform_malloc_internal(run_bytes);
+    symbol_cache.dark_run = platform_malloc_internal(run_bytes);
+    if (symbol_cache.lit_run == NULL || symbol_cache.dark_run == NULL) {
+      free(symbol_cache.lit_run);
+      free(symbol_cache.dark_run);
+      symbol_cache.lit_run = NULL;
+      symbol_cache.dark_run = NULL;
+      return false;
+    }
+  }
+  symbol_cache.run_leds = run_leds;
+  symbol_cache.valid = false;
+  return true;
+}
+
+// Encode one LED of each run and replicate it - only needed when the lit color
+// or the wire map changes. No frame may be on the wire.
+static void symbol_cache_rebuild(PlayClockDisplay *display) {
+  if (symbol_cache.lit_run == NULL)
+    return;
+
+  led_strip_encoder_config_t encoder_config = {
+    .resolution = LED_TRANSPORT_RMT_RESOLUTION_HZ,
+    .wire_map = &wire_map,
+  };
+  const uint8_t off[3] = {display->color_off.r, display->color_off.g, display->color_off.b};
+  led_strip_encode_symbols(&encoder_config, display->lit_rgb, sizeof(display->lit_rgb), symbol_cache.lit_run);
+  led_strip_encode_symbols(&encoder_config, off, sizeof(off), symbol_cache.dark_run);
+
+  for (uint16_t led = 1; led < symbol_cache.run_leds; led++) {
+    memcpy(&symbol_cache.lit_run[led * SYMBOLS_PER_LED], symbol_cache.lit_run, SYMBOLS_PER_LED * sizeof(rmt_symbol_word_t));
+    memcpy(&symbol_cache.dark_run[led * SYMBOLS_PER_LED], symbol_cache.dark_run, SYMBOLS_PER_LED * sizeof(rmt_symbol_word_t));
+  }
+
+  memcpy(symbol_cache.key_rgb, display->lit_rgb, sizeof(symbol_cache.key_rgb));
+  symbol_cache.valid = true;
+  ESP_LOGD(TAG, "Symbol cache rebuilt for RGB(%d,%d,%d) @ %d", display->lit_rgb[0], display->lit_rgb[1],
+           display->lit_rgb[2], display->brightness);
+}
+
+// Append dark spans covering count LEDs; returns false if the span list is full
+static bool symbol_cache_add_dark(led_symbol_span_t *spans, size_t *span_count, uint16_t count) {
+  while (count > 0) {
+    if (*span_count >= SYMBOL_CACHE_MAX_SPANS)
+      return false;
+    uint16_t chunk = count < symbol_cache.run_leds ? count : symbol_cache.run_leds;
+    spans[(*span_count)++] = (led_symbol_span_t){symbol_cache.dark_run, chunk * SYMBOLS_PER_LED};
+    count -= chunk;
+  }
+  return true;
+}
+
+// Build one output's span list for a segment mask into the given slot; returns
+// the span count or 0 to fall back to the byte encoder
+static size_t symbol_cache_build_frame(PlayClockDisplay *display, uint64_t segment_mask, int slot, int out) {
+  const display_output_t *output = &display->outputs[out];
+  led_symbol_span_t *spans = symbol_cache.spans[slot][out];
+  size_t span_count = 0;
+  uint16_t position = output->first_led;
+  uint16_t end = output->first_led + output->tx_leds;
+
+  for (int i = 0; i < symbol_cache.element_count; i++) {
+    uint8_t idx = symbol_cache.order[i];
+    segment_range_t range = layout_element_range(&display->layout, idx);
+    if (range.start < output->first_led || range.start + range.count > end)
+      continue; // On another chain
+
+    if (!symbol_cache_add_dark(spans, &span_count, range.start - position) || span_count >= SYMBOL_CACHE_MAX_SPANS)
+      return 0;
+
+    const rmt_symbol_word_t *run = (segment_mask & (1ULL << idx)) ? symbol_cache.lit_run : symbol_cache.dark_run;
+    spans[span_count++] = (led_symbol_span_t){run, range.count * SYMBOLS_PER_LED};
+    position = range.start + range.count;
+  }
+
+  if (!symbol_cache_add_dark(spans, &span_count, end - position))
+    return 0;
+  return span_count;
+}
+#endif
+
+// Transport done callback (ISR) - once every chain is done the front buffer is free again
+static PLATFORM_ISR_ATTR void display_tx_done_cb(void *arg) {
+  PlayClockDisplay *display = (PlayClockDisplay *)arg;
+
+  platform_critical_enter();
+  bool frame_done = tx_outputs_pending > 0 && --tx_outputs_pending == 0;
+  platform_critical_exit();
+  if (!frame_done)
+    return;
+
+  display->frame_us = (uint32_t)(platform_micros() - tx_start_us);
+  tx_in_flight = false;
+  latency_trace_mark(LATENCY_STAGE_DONE);
+  platform_signal_give(tx_done_signal);
+}
+
+// Block until the frame on the wire has finished (used only on rare paths)
+static void wait_for_tx_idle(void) {
+  while (tx_in_flight) {
+    platform_signal_take(tx_done_signal, 50);
   }
 }
 
 bool display_begin(PlayClockDisplay *display) {
-  ESP_LOGI(TAG, "Initializing WS2815 display with RMT");
+  return display_begin_with_transport(display, DISPLAY_TRANSPORT);
+}
+
+bool display_begin_with_transport(PlayClockDisplay *display, led_transport_kind_t transport_kind) {
+  ESP_LOGI(TAG, "Initializing WS2815 display with %s", led_transport_kind_name(transport_kind));
 
   // Create display mutex if not already created
   if (display_mutex == NULL) {
-    display_mutex = xSemaphoreCreateMutex();
+    display_mutex = platform_mutex_create();
     if (display_mutex == NULL) {
       ESP_LOGE(TAG, "Failed to create display mutex");
       return false;
     }
   }
+  if (tx_done_signal == NULL) {
+    tx_done_signal = platform_signal_create();
+    if (tx_done_signal == NULL) {
+      ESP_LOGE(TAG, "Failed to create transmit done semaphore");
+      return false;
+    }
+  }
 
   // Initialize structure
   memset(display, 0, sizeof(PlayClockDisplay));
 
-  // Configure RMT TX channel for WS2815
-  ESP_LOGI(TAG, "Configuring RMT channel for WS2815 on GPIO %d", LED_STRIP_PIN);
-  rmt_tx_channel_config_t tx_chan_config = {
-    .clk_src = RMT_CLK_SRC_DEFAULT,
-    .gpio_num = LED_STRIP_PIN,
-    .mem_block_symbols = 64,
-    .resolution_hz = RMT_LED_STRIP_RESOLUTION_HZ,
-    .trans_queue_depth = 4,
-  };
-  esp_err_t rmt_result = rmt_new_tx_channel(&tx_chan_config, &display->rmt_channel);
-  if (rmt_result != ESP_OK) {
-    ESP_LOGE(TAG, "Failed to create RMT TX channel: %s", esp_err_to_name(rmt_result));
+  led_buffer_dirty = true;
+  if (!init_outputs(display)) {
     return false;
   }
 
-  // Install LED strip encoder
-  ESP_LOGI(TAG, "Installing LED strip encoder");
-  led_strip_encoder_config_t encoder_config = {
-    .resolution = RMT_LED_STRIP_RESOLUTION_HZ,
-  };
-  rmt_result = rmt_new_led_strip_encoder(&encoder_config, &display->rmt_encoder);
-  if (rmt_result != ESP_OK) {
-    ESP_LOGE(TAG, "Failed to create LED strip encoder: %s", esp_err_to_name(rmt_result));
-    return false;
+  // Every LED on the chains draws its idle current, lit or not
+  uint32_t strip_leds = 0;
+  for (int out = 0; out < display->output_count; out++) {
+    strip_leds += display->outputs[out].strip_leds;
+  }
+  power_limit_init(&power, DISPLAY_POWER_BUDGET_MA, DISPLAY_POWER_CHANNEL_UA,
+                   strip_leds * DISPLAY_POWER_IDLE_UA / 1000, DISPLAY_POWER_RELEASE_STEP);
+
+  // Output backend behind display_update(), one per chain
+  led_transport_t *transports[DISPLAY_MAX_OUTPUTS];
+  for (int out = 0; out < display->output_count; out++) {
+    display_output_t *output = &display->outputs[out];
+
+    // First frame covers the whole chain so LEDs past the layout start dark
+    output->tx_leds = output->strip_leds;
+
+    led_transport_config_t transport_config = {
+      .gpio_num = output->gpio_num,
+      .max_leds = output->strip_leds,
+      .on_done = display_tx_done_cb,
+      .done_arg = display,
+      .wire_map = &wire_map,
+    };
+    esp_err_t transport_result = led_transport_new(transport_kind, &transport_config, &output->transport);
+    if (transport_result != ESP_OK) {
+      ESP_LOGE(TAG, "Failed to create %s transport for output %d: %s", led_transport_kind_name(transport_kind),
+               out, esp_err_to_name(transport_result));
+      return false;
+    }
+    transports[out] = output->transport;
+  }
+
+  // Parallel chains must start on the same clock edge
+  if (display->output_count > 1) {
+    esp_err_t sync_result = led_transport_sync_group(transports, display->output_count);
+    if (sync_result != ESP_OK) {
+      ESP_LOGE(TAG, "Failed to synchronize %d outputs: %s", display->output_count, esp_err_to_name(sync_result));
+      return false;
+    }
   }
 
-  // Enable RMT channel
-  ESP_LOGI(TAG, "Enabling RMT TX channel");
-  rmt_result = rmt_enable(display->rmt_channel);
-  if (rmt_result != ESP_OK) {
-    ESP_LOGE(TAG, "Failed to enable RMT TX channel: %s", esp_err_to_name(rmt_result));
+  ESP_LOGI(TAG, "%s transport configured successfully on %d output(s)",
+           display->outputs[0].transport->name, display->output_count);
+
+  if (!init_layout(display)) {
     return false;
   }
+  anim_init(&anim, &display->layout);
+  anim_set_transition(&anim, DISPLAY_TRANSITION, DISPLAY_TRANSITION_MS * 1000);
+  ESP_LOGI(TAG, "Layout uses %d of %d LEDs", display->active_led_count, LED_COUNT);
 
-  ESP_LOGI(TAG, "RMT channel configured successfully");
+#if DISPLAY_SYMBOL_CACHE
+  if (display->outputs[0].transport->submit_spans != NULL && !symbol_cache_init(display)) {
+    ESP_LOGW(TAG, "No memory for RMT symbol cache - using byte encoder");
+  }
+#endif
 
-  // Initialize segment mapping
-  ESP_LOGI(TAG, "Initializing segment mapping for %d digits", PLAY_CLOCK_DIGITS);
-  init_segment_mapping(display);
+  display->format = DISPLAY_TIME_FORMAT;
+  display->suppress_zeros = DISPLAY_SUPPRESS_ZEROS;
 
   // Initialize colors
   display->color_off = (color_t){0, 0, 0};
@@ -186,82 +471,200 @@ bool display_begin(PlayClockDisplay *display) {
   display->color_warning = (color_t){255, 255, 0}; // Yellow
   display->color_error = (color_t){255, 0, 0};
   
-  // Set default brightness
+  // Set default brightness and color calibration
   display->brightness = 255;
+  display->calibration = (display_calibration_t){
+    .color_gamma = DISPLAY_DEFAULT_COLOR_GAMMA,
+    .brightness_gamma = DISPLAY_DEFAULT_BRIGHTNESS_GAMMA,
+    .white_balance = {255, 255, 255},
+  };
+  color_lut_build(&color_lut, &display->calibration, display->brightness);
+  wire_map_stale = true;
   ESP_LOGI(TAG, "Brightness set to default: %d", display->brightness);
 
-  // Clear display
+  // Clear display; the self-tests (display_connection_test(), display_test_pattern())
+  // are up to the caller so boot isn't held up by them
   display_clear(display);
 
-  // Run connection test
-  ESP_LOGI(TAG, "Running LED strip connection test...");
-  bool test_result = display_connection_test(display);
-  if (!test_result) {
-    ESP_LOGW(TAG, "LED strip connection test failed - continuing anyway");
-  } else {
-    ESP_LOGI(TAG, "LED strip connection test passed");
-  }
-
   display->initialized = true;
   ESP_LOGI(TAG, "WS2815 display initialized successfully");
   return true;
 }
 
-void display_set_time(PlayClockDisplay *display, uint16_t seconds) {
-  if (!display->initialized)
-    return;
+// Color of lit segments in the current mode
+static color_t segment_color(const PlayClockDisplay *display) {
+  if (display->current_mode == DISPLAY_MODE_ERROR)
+    return display->color_error;
+  if (display->current_mode == DISPLAY_MODE_RESET)
+    return display->color_warning;
+  return display->color_on;
+}
 
-  // Thread-safe display operations
-  xSemaphoreTake(display_mutex, portMAX_DELAY);
+static void fill_spans(const segment_range_t *spans, size_t span_count, const uint8_t rgb[3]) {
+  int32_t delta[3] = {0, 0, 0};
+  if (render_fill_spans(led_buffer, spans, span_count, rgb, delta)) {
+    led_buffer_dirty = true;
+    add_channel_delta(delta);
+  }
+}
+
+static void fill_glyph(PlayClockDisplay *display, int digit, uint8_t value, const uint8_t rgb[3]) {
+  size_t span_count;
+  const segment_range_t *spans = layout_glyph_spans(&display->layout, digit, value, &span_count);
+  fill_spans(spans, span_count, rgb);
+}
+
+// Draw changed glyphs and indicators directly from their spans - caller holds display_mutex
+static void draw_glyphs_locked(PlayClockDisplay *display, const uint8_t *digits, uint64_t indicator_mask,
+                               const uint8_t rgb[3], const uint8_t off[3]) {
+  bool recolor = memcmp(rgb, display->lit_rgb, 3) != 0;
 
-  // Check for null signal (255 seconds = 0xFF)
-  if (seconds == 255) {
-    ESP_LOGI(TAG, "Received null signal (255 seconds) - clearing display");
+  for (int digit = 0; digit < display->layout.digit_count; digit++) {
+    uint8_t previous = display->current_digits[digit];
+    if (digits[digit] != previous) {
+      fill_glyph(display, digit, previous, off);
+    }
+    if (digits[digit] != previous || recolor) {
+      fill_glyph(display, digit, digits[digit], rgb);
+    }
+    display->current_digits[digit] = digits[digit];
+  }
+
+  for (int i = 0; i < display->layout.indicator_count; i++) {
+    uint64_t bit = 1ULL << LAYOUT_INDICATOR_BIT(i);
+    bool was_lit = (display->segment_mask & bit) != 0;
+    bool lit = (indicator_mask & bit) != 0;
+    if (lit && (!was_lit || recolor)) {
+      fill_spans(&display->layout.indicators[i], 1, rgb);
+    } else if (!lit && was_lit) {
+      fill_spans(&display->layout.indicators[i], 1, off);
+    }
+  }
+
+  display->segment_mask = render_segment_mask(display->current_digits, display->layout.digit_count) | indicator_mask;
+}
+
+// Draw the animation frame at now_us; once it settles the buffer is a plain
+// glyph again. Caller holds display_mutex.
+static void animate_locked(int64_t now_us) {
+  int32_t delta[3] = {0, 0, 0};
+  if (anim_render(&anim, led_buffer, now_us, delta)) {
+    led_buffer_dirty = true;
+    add_channel_delta(delta);
+  }
+  animating = !anim_settled(&anim);
+  glyph_frame = !animating;
+}
+
+// Draw digit values and the separator. Without transitions only glyphs that
+// change (or all lit ones on a color change) are touched, so the cost follows
+// the lit LEDs, not the framebuffer size; with them, the changing segments
+// start their transition. Caller holds display_mutex.
+static void draw_digits_locked(PlayClockDisplay *display, const uint8_t *digits, bool separator) {
+  color_t color = segment_color(display);
+  const uint8_t rgb[3] = {color.r, color.g, color.b};
+  const uint8_t off[3] = {display->color_off.r, display->color_off.g, display->color_off.b};
+
+  // Something other than a glyph was drawn (tests, single segments) - start from dark
+  if (!glyph_frame && !animating) {
     display_clear(display);
-    xSemaphoreGive(display_mutex);
-    display_update(display);
-    display->last_update_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    memset(display->current_digits, RENDER_DIGIT_BLANK, sizeof(display->current_digits));
+    display->segment_mask = 0;
+    anim_sync(&anim, 0);
+  }
+  anim_set_colors(&anim, rgb, off);
+
+  uint64_t indicator_mask = 0;
+  for (int i = 0; i < display->layout.indicator_count; i++) {
+    uint64_t bit = 1ULL << LAYOUT_INDICATOR_BIT(i);
+    if (i == LAYOUT_SEPARATOR ? separator : (display->segment_mask & bit) != 0) {
+      indicator_mask |= bit;
+    }
+  }
+
+  if (animating || anim_enabled(&anim)) {
+    memcpy(display->current_digits, digits, display->layout.digit_count);
+    display->segment_mask = render_segment_mask(digits, display->layout.digit_count) | indicator_mask;
+    anim_set_mask(&anim, display->segment_mask, platform_micros());
+    animate_locked(platform_micros());
+  } else {
+    draw_glyphs_locked(display, digits, indicator_mask, rgb, off);
+    anim_sync(&anim, display->segment_mask);
+    glyph_frame = true;
+  }
+  memcpy(display->lit_rgb, rgb, sizeof(rgb));
+  display->last_update_time = platform_millis();
+}
+
+void display_set_digits(PlayClockDisplay *display, const uint8_t *digits, bool separator) {
+  if (!display->initialized)
     return;
+
+  platform_mutex_lock(display_mutex);
+  draw_digits_locked(display, digits, separator);
+  platform_mutex_unlock(display_mutex);
+}
+
+bool display_animate(PlayClockDisplay *display) {
+  if (!display->initialized || !animating)
+    return false;
+
+  platform_mutex_lock(display_mutex);
+  if (animating) {
+    animate_locked(platform_micros());
   }
+  bool busy = animating;
+  platform_mutex_unlock(display_mutex);
+  return busy;
+}
 
-  ESP_LOGI(TAG, "Setting time: %d seconds", seconds);
+void display_set_transition(PlayClockDisplay *display, anim_transition_t transition, uint32_t duration_ms) {
+  if (!display->initialized)
+    return;
 
-  // Extract digits (00-99 seconds)
-  uint8_t tens = (seconds / 10) % 10;
-  uint8_t ones = seconds % 10;
-  
-  display->current_digits[0] = tens;
-  display->current_digits[1] = ones;
+  platform_mutex_lock(display_mutex);
+  anim_set_transition(&anim, transition, duration_ms * 1000);
+  platform_mutex_unlock(display_mutex);
+}
 
-  // Clear all segments first
-  display_clear(display);
-  
-  // Set segments for each digit
-  for (int digit = 0; digit < PLAY_CLOCK_DIGITS; digit++) {
-    uint8_t digit_value = display->current_digits[digit];
-    uint8_t pattern = digit_patterns[digit_value];
-    
-    color_t segment_color = display->color_on;
-    
-    // Apply mode-specific colors
-    if (display->current_mode == DISPLAY_MODE_ERROR) {
-      segment_color = display->color_error;
-    } else if (display->current_mode == DISPLAY_MODE_RESET) {
-      segment_color = display->color_warning;
-    }
-    
-    // Set segments based on pattern
-    for (int seg = 0; seg < SEGMENTS_PER_DIGIT; seg++) {
-      if (pattern & (1 << seg)) {
-        set_segment_leds(display, digit, seg, segment_color);
-      }
-    }
+void display_set_effect(PlayClockDisplay *display, anim_effect_t effect, uint32_t period_ms) {
+  if (!display->initialized)
+    return;
+
+  platform_mutex_lock(display_mutex);
+  int64_t now_us = platform_micros();
+  anim_set_effect(&anim, effect, period_ms * 1000, now_us);
+  // A glyph on display starts (or stops) the effect right away
+  if (glyph_frame || animating) {
+    animate_locked(now_us);
   }
+  platform_mutex_unlock(display_mutex);
+}
 
-  // Log the time
-  display->last_update_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
-  
-  xSemaphoreGive(display_mutex);
+void display_set_time(PlayClockDisplay *display, uint32_t value) {
+  if (!display->initialized)
+    return;
+
+  ESP_LOGD(TAG, "Setting time: %lu", (unsigned long)value);
+  uint8_t digits[DISPLAY_MAX_DIGITS];
+  bool separator = render_format_value(display->format, value, display->suppress_zeros, digits,
+                                       display->layout.digit_count);
+  display_set_digits(display, digits, separator);
+}
+
+void display_set_blank(PlayClockDisplay *display) {
+  if (!display->initialized)
+    return;
+
+  ESP_LOGD(TAG, "Blanking display");
+  uint8_t digits[DISPLAY_MAX_DIGITS];
+  memset(digits, RENDER_DIGIT_BLANK, sizeof(digits));
+  display_set_digits(display, digits, false);
+}
+
+void display_set_format(PlayClockDisplay *display, render_format_t format, bool suppress_zeros) {
+  display->format = format;
+  display->suppress_zeros = suppress_zeros;
 }
 
 void display_set_color(PlayClockDisplay *display, uint8_t r, uint8_t g, uint8_t b) {
@@ -269,14 +672,14 @@ void display_set_color(PlayClockDisplay *display, uint8_t r, uint8_t g, uint8_t
     return;
 
   // Thread-safe display operations
-  xSemaphoreTake(display_mutex, portMAX_DELAY);
+  platform_mutex_lock(display_mutex);
   
   // Update the main color with received RGB values
   display->color_on = (color_t){r, g, b};
   
-  ESP_LOGI(TAG, "Display color updated to RGB(%d,%d,%d)", r, g, b);
+  ESP_LOGD(TAG, "Display color updated to RGB(%d,%d,%d)", r, g, b);
   
-  xSemaphoreGive(display_mutex);
+  platform_mutex_unlock(display_mutex);
 }
 
 void display_set_run_mode(PlayClockDisplay *display) {
@@ -284,7 +687,7 @@ void display_set_run_mode(PlayClockDisplay *display) {
     return;
 
   display->current_mode = DISPLAY_MODE_RUN;
-  ESP_LOGI(TAG, "Display mode: RUN");
+  ESP_LOGD(TAG, "Display mode: RUN");
 }
 
 void display_set_stop_mode(PlayClockDisplay *display) {
@@ -316,31 +719,94 @@ void display_clear(PlayClockDisplay *display) {
     return;
 
   // Clear all LEDs using helper function
-  fill_all_leds(display->color_off, display->brightness);
+  fill_all_leds(display->color_off, FILL_LEVEL_FULL);
 }
 
 void display_set_brightness(PlayClockDisplay *display, uint8_t brightness) {
   if (!display->initialized)
     return;
-    
-  display->brightness = brightness;
+
+  platform_mutex_lock(display_mutex);
+  if (brightness != display->brightness) {
+    display->brightness = brightness;
+    color_lut_build(&color_lut, &display->calibration, brightness);
+    // Nothing is redrawn - the next frame goes out through the new map
+    wire_map_stale = true;
+    led_buffer_dirty = true;
+  }
+  platform_mutex_unlock(display_mutex);
   ESP_LOGI(TAG, "Brightness set to: %d", brightness);
 }
 
+void display_set_calibration(PlayClockDisplay *display, const display_calibration_t *calibration) {
+  if (!display->initialized || !calibration)
+    return;
+
+  platform_mutex_lock(display_mutex);
+  display->calibration = *calibration;
+  color_lut_build(&color_lut, &display->calibration, display->brightness);
+  wire_map_stale = true;
+  led_buffer_dirty = true;
+  platform_mutex_unlock(display_mutex);
+  ESP_LOGI(TAG, "Calibration set: color gamma %.2f, brightness gamma %.2f, white balance %d/%d/%d",
+           calibration->color_gamma, calibration->brightness_gamma,
+           calibration->white_balance[0], calibration->white_balance[1], calibration->white_balance[2]);
+}
+
 void display_set_segment(PlayClockDisplay *display, uint8_t digit, segment_t segment, bool enable) {
-  if (!display->initialized || digit >= PLAY_CLOCK_DIGITS || segment >= SEGMENTS_PER_DIGIT)
+  if (!display->initialized || digit >= display->layout.digit_count || segment >= SEGMENTS_PER_DIGIT)
     return;
 
   color_t color = enable ? display->color_on : display->color_off;
   set_segment_leds(display, digit, segment, color);
 }
 
+void display_set_indicator(PlayClockDisplay *display, uint8_t indicator, bool enable) {
+  if (!display->initialized || indicator >= display->layout.indicator_count)
+    return;
+
+  platform_mutex_lock(display_mutex);
+  uint64_t bit = 1ULL << LAYOUT_INDICATOR_BIT(indicator);
+  display->segment_mask = enable ? display->segment_mask | bit : display->segment_mask & ~bit;
+  if ((glyph_frame || animating) && (animating || anim_enabled(&anim))) {
+    anim_set_mask(&anim, display->segment_mask, platform_micros());
+    animate_locked(platform_micros());
+  } else {
+    color_t color = enable ? segment_color(display) : display->color_off;
+    const uint8_t rgb[3] = {color.r, color.g, color.b};
+    fill_spans(&display->layout.indicators[indicator], 1, rgb);
+    anim_sync(&anim, display->segment_mask);
+  }
+  platform_mutex_unlock(display_mutex);
+}
+
+const char *display_check_layout(PlayClockDisplay *display, const display_layout_t *layout) {
+  static compiled_layout_t check; // Only validated here, the running layout is untouched
+  layout_output_t outputs[LAYOUT_MAX_OUTPUTS];
+  return display_layout_compile(layout, outputs, layout_outputs(display, outputs), &check);
+}
+
+bool display_store_layout(PlayClockDisplay *display, const display_layout_t *layout) {
+  const char *error = layout != NULL ? display_check_layout(display, layout) : NULL;
+  if (error != NULL) {
+    ESP_LOGE(TAG, "New layout rejected: %s", error);
+    return false;
+  }
+
+  if (!platform_storage_store(LAYOUT_STORAGE_NAMESPACE, LAYOUT_STORAGE_KEY, layout, layout != NULL ? sizeof(*layout) : 0)) {
+    ESP_LOGE(TAG, "Failed to store layout");
+    return false;
+  }
+  ESP_LOGI(TAG, "Layout %s - applies on next boot", layout != NULL ? "stored" : "cleared");
+  return true;
+}
+
 // Helper function to test single LED color
 static void test_single_led_color(PlayClockDisplay *display, color_t color, const char* color_name) {
   ESP_LOGI(TAG, "Testing LED color: %s", color_name);
   set_led_color(0, color, 255);
   display_update(display);
-  vTaskDelay(pdMS_TO_TICKS(TEST_LED_DELAY_MS));
+  platform_delay_ms(TEST_LED_DELAY_MS);
 }
 
 // Connection test - checks if LED strip responds to basic commands
@@ -358,18 +824,18 @@ bool display_connection_test(PlayClockDisplay *display) {
   ESP_LOGI(TAG, "Clearing first LED");
   set_led_color(0, (color_t){0, 0, 0}, 255);
   display_update(display);
-  vTaskDelay(pdMS_TO_TICKS(TEST_LED_OFF_DELAY_MS));
+  platform_delay_ms(TEST_LED_OFF_DELAY_MS);
   
   ESP_LOGI(TAG, "LED strip connection test completed");
   return true; // Always return true for now - visual verification needed
 }
 
 // Helper function to test all LEDs with a specific color
-static void test_all_leds_color(PlayClockDisplay *display, color_t color, uint8_t brightness, const char* color_name) {
+static void test_all_leds_color(PlayClockDisplay *display, color_t color, uint8_t level, const char* color_name) {
   ESP_LOGI(TAG, "Test pattern: All LEDs %s", color_name);
-  fill_all_leds(color, brightness);
+  fill_all_leds(color, level);
   display_update(display);
-  vTaskDelay(pdMS_TO_TICKS(TEST_COLOR_DELAY_MS));
+  platform_delay_ms(TEST_COLOR_DELAY_MS);
 }
 
 // Helper function to test individual segment
@@ -377,10 +843,10 @@ static void test_single_segment(PlayClockDisplay *display, uint8_t digit, segmen
   ESP_LOGI(TAG, "Testing segment %d on digit %d", segment, digit);
   set_segment_leds(display, digit, segment, (color_t){255, 255, 0}); // Yellow
   display_update(display);
-  vTaskDelay(pdMS_TO_TICKS(TEST_SEGMENT_DELAY_MS));
+  platform_delay_ms(TEST_SEGMENT_DELAY_MS);
   set_segment_leds(display, digit, segment, display->color_off);
   display_update(display);
-  vTaskDelay(pdMS_TO_TICKS(TEST_SEGMENT_OFF_DELAY_MS));
+  platform_delay_ms(TEST_SEGMENT_OFF_DELAY_MS);
 }
 
 // Test function to verify digit addressing - helps find correct base addresses
@@ -388,12 +854,12 @@ static void test_digit_addressing(PlayClockDisplay *display) {
   ESP_LOGI(TAG, "=== DIGIT ADDRESSING TEST ===");
   
   // Test each digit individually with all segments lit (digit 8)
-  for (int digit = 0; digit < PLAY_CLOCK_DIGITS; digit++) {
+  for (int digit = 0; digit < display->layout.digit_count; digit++) {
     ESP_LOGI(TAG, "Testing digit %d - should show '8'", digit);
     display_clear(display);
     
     // Light all segments for this digit (pattern for 8)
-    uint8_t pattern = digit_patterns[8]; // 0x7F = all segments
+    uint8_t pattern = render_digit_pattern(8); // 0x7F = all segments
     for (int seg = 0; seg < SEGMENTS_PER_DIGIT; seg++) {
       if (pattern & (1 << seg)) {
         set_segment_leds(display, digit, seg, (color_t){255, 0, 0}); // Red
@@ -401,13 +867,20 @@ static void test_digit_addressing(PlayClockDisplay *display) {
     }
     
     display_update(display);
-    ESP_LOGI(TAG, "Digit %d base address: %d, LED range: %d-%d", 
-             digit, 
-             (digit == 0) ? DIGIT_0_BASE : DIGIT_1_BASE,
-             (digit == 0) ? DIGIT_0_BASE : DIGIT_1_BASE,
-             (digit == 0) ? DIGIT_0_BASE + 164 : DIGIT_1_BASE + 164);
+    const segment_range_t *segments = display->layout.segments[digit];
+    uint16_t first = UINT16_MAX, last = 0;
+    for (int seg = 0; seg < SEGMENTS_PER_DIGIT; seg++) {
+      if (segments[seg].count == 0)
+        continue;
+      if (segments[seg].start < first)
+        first = segments[seg].start;
+      if (segments[seg].start + segments[seg].count - 1 > last)
+        last = segments[seg].start + segments[seg].count - 1;
+    }
+    ESP_LOGI(TAG, "Digit %d on output %d, LED range: %d-%d",
+             digit, display->layout.digit_output[digit], first, last);
     
-    vTaskDelay(pdMS_TO_TICKS(3000)); // Show for 3 seconds
+    platform_delay_ms(3000); // Show for 3 seconds
   }
   
   display_clear(display);
@@ -427,13 +900,13 @@ void display_test_pattern(PlayClockDisplay *display) {
   // Clear display first
   display_clear(display);
   display_update(display);
-  vTaskDelay(pdMS_TO_TICKS(500));
+  platform_delay_ms(500);
   
   // Test primary colors using helper function
-  test_all_leds_color(display, (color_t){255, 0, 0}, TEST_COLOR_BRIGHTNESS, "red");
-  test_all_leds_color(display, (color_t){0, 255, 0}, TEST_COLOR_BRIGHTNESS, "green");
-  test_all_leds_color(display, (color_t){0, 0, 255}, TEST_COLOR_BRIGHTNESS, "blue");
-  test_all_leds_color(display, (color_t){255, 255, 255}, TEST_WHITE_BRIGHTNESS, "white");
+  test_all_leds_color(display, (color_t){255, 0, 0}, TEST_COLOR_LEVEL, "red");
+  test_all_leds_color(display, (color_t){0, 255, 0}, TEST_COLOR_LEVEL, "green");
+  test_all_leds_color(display, (color_t){0, 0, 255}, TEST_COLOR_LEVEL, "blue");
+  test_all_leds_color(display, (color_t){255, 255, 255}, TEST_WHITE_LEVEL, "white");
   
   // Test digit addressing to verify second digit wiring
   test_digit_addressing(display);
@@ -447,11 +920,19 @@ void display_test_pattern(PlayClockDisplay *display) {
     test_single_segment(display, 0, seg);
   }
   
-  // Test 6: Display "88" (all segments on)
-  ESP_LOGI(TAG, "Test pattern: Display '88' (all segments)");
-  display_set_time(display, 88);
+  // Test 6: All digits "8" and the separator (all segments on)
+  ESP_LOGI(TAG, "Test pattern: Display all 8s (all segments)");
+  for (int digit = 0; digit < display->layout.digit_count; digit++) {
+    for (int seg = 0; seg < SEGMENTS_PER_DIGIT; seg++) {
+      set_segment_leds(display, digit, seg, display->color_on);
+    }
+  }
+  for (int i = 0; i < display->layout.indicator_count; i++) {
+    fill_led_range(display->layout.indicators[i].start, display->layout.indicators[i].count, display->color_on,
+                   FILL_LEVEL_FULL);
+  }
   display_update(display);
-  vTaskDelay(pdMS_TO_TICKS(2000));
+  platform_delay_ms(2000);
   
   // Clear display
   display_clear(display);
@@ -460,44 +941,215 @@ void display_test_pattern(PlayClockDisplay *display) {
   ESP_LOGI(TAG, "LED test pattern completed");
 }
 
-void display_update(PlayClockDisplay *display) {
-  if (!display->initialized)
-    return;
+// Swap framebuffers and hand the new front buffer to the transport - caller holds display_mutex
+static bool display_submit_locked(PlayClockDisplay *display) {
+  int front_index = back_index;
+  const uint8_t *front = led_buffers[front_index];
 
-  // Thread-safe display update
-  xSemaphoreTake(display_mutex, portMAX_DELAY);
+  // No frame is on the wire, so the encoders' map can change now
+  if (wire_map_stale) {
+    wire_map_build(&wire_map, &color_lut, DISPLAY_COLOR_ORDER, power.limit);
+    wire_map_stale = false;
+#if DISPLAY_SYMBOL_CACHE
+    symbol_cache.valid = false;
+#endif
+  }
+
+#if DISPLAY_SYMBOL_CACHE
+  // Re-encode the cached runs only when the lit color or the map changed
+  if (glyph_frame && (!symbol_cache.valid || memcmp(symbol_cache.key_rgb, display->lit_rgb, 3) != 0)) {
+    symbol_cache_rebuild(display);
+  }
+#endif
 
   // Force buffer access to prevent compiler optimization issues
   // This simulates the effect of debug logging that was making it work
-  volatile uint8_t buffer_check = led_buffer[0] + led_buffer[1] + led_buffer[2];
+  volatile uint8_t buffer_check = front[0] + front[1] + front[2];
   (void)buffer_check; // Prevent unused variable warning
 
-  // Transmit LED data using RMT
-  rmt_transmit_config_t tx_config = {
-    .loop_count = 0, // no transfer loop
-  };
-  
-  esp_err_t result = rmt_transmit(display->rmt_channel, display->rmt_encoder, 
-                                 led_buffer, sizeof(led_buffer), &tx_config);
+  // Transmit LED data - only the populated span of each chain. Transports never
+  // block on their queue, the caller retries on the next update.
+  platform_critical_enter();
+  tx_outputs_pending = display->output_count;
+  tx_in_flight = true;
+  platform_critical_exit();
+  tx_start_us = platform_micros();
+
+  int submitted = 0;
+  esp_err_t result = ESP_OK;
+  for (; submitted < display->output_count; submitted++) {
+    display_output_t *output = &display->outputs[submitted];
+    result = ESP_ERR_NOT_SUPPORTED;
+
+#if DISPLAY_SYMBOL_CACHE
+    // Glyph frames are assembled from pre-encoded symbol runs
+    if (glyph_frame && symbol_cache.valid && symbol_cache.layout_ok &&
+        output->transport->submit_spans != NULL && output->tx_leds == output->active_leds) {
+      size_t span_count = symbol_cache_build_frame(display, display->segment_mask, front_index, submitted);
+      if (span_count > 0) {
+        result = output->transport->submit_spans(output->transport, symbol_cache.spans[front_index][submitted], span_count);
+      }
+    }
+#endif
+
+    if (result == ESP_ERR_NOT_SUPPORTED) {
+      result = output->transport->submit(output->transport, front + output->first_led * 3, output->tx_leds * 3);
+    }
+    if (result != ESP_OK) {
+      break;
+    }
+  }
+
   if (result != ESP_OK) {
-    ESP_LOGE(TAG, "Failed to transmit LED data: %s", esp_err_to_name(result));
-    xSemaphoreGive(display_mutex);
+    ESP_LOGE(TAG, "Failed to transmit LED data on output %d: %s", submitted, esp_err_to_name(result));
+    // Chains already queued are held by the sync manager - drop them
+    for (int out = 0; out < submitted; out++) {
+      led_transport_abort(display->outputs[out].transport);
+    }
+    platform_critical_enter();
+    tx_outputs_pending = 0;
+    tx_in_flight = false;
+    platform_critical_exit();
+    return false;
+  }
+
+  // Render into the other buffer from now on; it starts as a copy of the frame
+  // on the wire so incremental writes and dirty tracking stay correct
+  back_index = front_index ^ 1;
+  led_buffer = led_buffers[back_index];
+  memcpy(led_buffer, front, sizeof(led_buffers[0]));
+  return true;
+}
+
+// Channel value sum as sent: each channel's framebuffer sum at the wire value
+// of full scale. Gamma only lowers the values in between, so this errs high.
+static uint32_t wire_channel_sum(void) {
+  uint64_t sum = 0;
+  for (int channel = 0; channel < 3; channel++) {
+    sum += (uint64_t)channel_sum[channel] * color_lut.table[channel][255] / 255;
+  }
+  return (uint32_t)sum;
+}
+
+void display_update(PlayClockDisplay *display) {
+  if (!display->initialized)
     return;
+
+  int64_t submit_start_us = platform_micros();
+
+  // Thread-safe display update
+  platform_mutex_lock(display_mutex);
+
+  // A limit change resends the frame through a map at the new scale
+  uint16_t previous_limit = power.limit;
+  if (power_limit_update(&power, wire_channel_sum()) != previous_limit) {
+    wire_map_stale = true;
+    led_buffer_dirty = true;
+  }
+
+  // Skip the RMT transaction when nothing changed, apart from a periodic keepalive
+  uint32_t current_time = platform_millis();
+  if (!led_buffer_dirty && (dark_on_wire || current_time - display->last_transmit_time < DISPLAY_KEEPALIVE_MS)) {
+    platform_mutex_unlock(display_mutex);
+    return;
+  }
+
+  // Previous frame still on the wire - the frame stays dirty and goes out on the next call
+  if (tx_in_flight) {
+    platform_mutex_unlock(display_mutex);
+    return;
+  }
+
+  // Keepalive frames carry nothing new and aren't traced. Marked before the
+  // hand-off so the done callback can't overtake it.
+  if (led_buffer_dirty) {
+    latency_trace_mark(LATENCY_STAGE_SUBMIT);
+  }
+
+  if (!display_submit_locked(display)) {
+    platform_mutex_unlock(display_mutex);
+    return;
+  }
+
+  led_buffer_dirty = false;
+  display->last_transmit_time = current_time;
+  dark_on_wire = channel_sum[0] == 0 && channel_sum[1] == 0 && channel_sum[2] == 0;
+
+  // Once the tail of each chain has been blanked, only the layout span is sent
+  for (int out = 0; out < display->output_count; out++) {
+    display_output_t *output = &display->outputs[out];
+    if (output->active_leds > 0) {
+      output->tx_leds = output->active_leds;
+    }
   }
-  
-  // Wait for transmission to complete
-  rmt_tx_wait_all_done(display->rmt_channel, portMAX_DELAY);
-  
-  // WS2815 requires explicit reset delay after transmission
-  esp_rom_delay_us(320);
 
-  uint32_t current_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
   if (current_time - display->last_update_time > 1000) {
-    ESP_LOGD(TAG, "Display update - mode: %d", display->current_mode);
+    led_transport_stats_t stats;
+    display_get_transport_stats(display, &stats);
+    ESP_LOGD(TAG, "Display update - mode: %d, %s x%d frame %lu us (max %lu), %lu irqs / %lu us, encode %lu us",
+             display->current_mode, display->outputs[0].transport->name, display->output_count,
+             (unsigned long)stats.frame_us, (unsigned long)stats.frame_us_max,
+             (unsigned long)stats.irq_count, (unsigned long)stats.irq_us, (unsigned long)stats.encode_us);
     display->last_update_time = current_time;
   }
   
-  xSemaphoreGive(display_mutex);
+  platform_mutex_unlock(display_mutex);
+  display->submit_us = (uint32_t)(platform_micros() - submit_start_us);
+}
+
+// Combined over all chains: the slowest chain's timing, total interrupt load
+void display_get_transport_stats(PlayClockDisplay *display, led_transport_stats_t *stats) {
+  if (!stats)
+    return;
+
+  memset(stats, 0, sizeof(*stats));
+  for (int out = 0; out < display->output_count; out++) {
+    const volatile led_transport_stats_t *chain = &display->outputs[out].transport->stats;
+    if (out == 0 || chain->frames < stats->frames) {
+      stats->frames = chain->frames;
+    }
+    if (chain->frame_us > stats->frame_us) {
+      stats->frame_us = chain->frame_us;
+    }
+    if (chain->frame_us_max > stats->frame_us_max) {
+      stats->frame_us_max = chain->frame_us_max;
+    }
+    stats->irq_count += chain->irq_count;
+    stats->irq_us += chain->irq_us;
+    stats->encode_us += chain->encode_us;
+  }
+}
+
+void display_get_power_stats(PlayClockDisplay *display, power_limit_stats_t *stats) {
+  if (!stats)
+    return;
+
+  memset(stats, 0, sizeof(*stats));
+  if (!display->initialized)
+    return;
+
+  platform_mutex_lock(display_mutex);
+  *stats = power.stats;
+  platform_mutex_unlock(display_mutex);
+}
+
+void display_flush(PlayClockDisplay *display) {
+  if (!display->initialized)
+    return;
+
+  wait_for_tx_idle();
+  display_update(display);
+  wait_for_tx_idle();
+}
+
+bool display_is_idle(PlayClockDisplay *display) {
+  if (!display->initialized)
+    return false;
+
+  platform_mutex_lock(display_mutex);
+  bool idle = dark_on_wire && !led_buffer_dirty && !animating && !tx_in_flight;
+  platform_mutex_unlock(display_mutex);
+  return idle;
 }
 
 void display_set_all_white(PlayClockDisplay *display) {
@@ -507,9 +1159,9 @@ void display_set_all_white(PlayClockDisplay *display) {
   ESP_LOGI(TAG, "Setting all LEDs to white");
   
   // Thread-safe white LED setting
-  xSemaphoreTake(display_mutex, portMAX_DELAY);
-  fill_all_leds((color_t){255, 255, 255}, display->brightness);
-  xSemaphoreGive(display_mutex);
+  platform_mutex_lock(display_mutex);
+  fill_all_leds((color_t){255, 255, 255}, FILL_LEVEL_FULL);
+  platform_mutex_unlock(display_mutex);
   
   display_update(display);
 }
@@ -0,0 +1,183 @@
+#include "../include/display_layout.h"
+#include <stdlib.h>
+#include <string.h>
+
+// LED offset of each segment from the start of its digit (built-in wiring)
+static const layout_segment_t default_segments[SEGMENTS_PER_DIGIT] = {
+  [SEGMENT_A] = {0, LEDS_PER_SEGMENT_HORIZONTAL, 0},   // Top horizontal
+  [SEGMENT_B] = {15, LEDS_PER_SEGMENT_VERTICAL, 0},    // Upper right vertical
+  [SEGMENT_C] = {45, LEDS_PER_SEGMENT_VERTICAL, 0},    // Lower right vertical
+  [SEGMENT_D] = {75, LEDS_PER_SEGMENT_HORIZONTAL, 0},  // Bottom horizontal
+  [SEGMENT_E] = {90, LEDS_PER_SEGMENT_VERTICAL, 0},    // Lower left vertical
+  [SEGMENT_F] = {120, LEDS_PER_SEGMENT_VERTICAL, 0},   // Upper left vertical
+  [SEGMENT_G] = {150, LEDS_PER_SEGMENT_HORIZONTAL, 0}, // Middle horizontal
+};
+
+void display_layout_default(display_layout_t *layout, int digit_count, const uint8_t *outputs, const uint16_t *bases) {
+  memset(layout, 0, sizeof(*layout));
+  layout->version = LAYOUT_VERSION;
+  layout->digit_count = digit_count < LAYOUT_MAX_DIGITS ? digit_count : LAYOUT_MAX_DIGITS;
+  for (int digit = 0; digit < layout->digit_count; digit++) {
+    layout->digits[digit].output = outputs[digit];
+    layout->digits[digit].base = bases[digit];
+    memcpy(layout->digits[digit].segments, default_segments, sizeof(default_segments));
+  }
+}
+
+// Whole decimal number up to max
+static bool parse_number(const char *text, uint32_t max, uint32_t *value) {
+  char *end;
+  if (text[0] < '0' || text[0] > '9')
+    return false;
+  unsigned long parsed = strtoul(text, &end, 10);
+  if (*end != '\0' || parsed > max)
+    return false;
+  *value = (uint32_t)parsed;
+  return true;
+}
+
+const char *display_layout_edit(display_layout_t *layout, int argc, const char *const *argv) {
+  uint32_t values[4];
+  if (argc < 1)
+    return "missing edit";
+  const char *what = argv[0];
+
+  if (strcmp(what, "digits") == 0) {
+    if (argc != 2 || !parse_number(argv[1], LAYOUT_MAX_DIGITS, &values[0]) || values[0] == 0)
+      return "usage: digits <1-6>";
+    layout->digit_count = values[0];
+    return NULL;
+  }
+
+  if (strcmp(what, "digit") == 0) {
+    if (argc != 4 || !parse_number(argv[1], LAYOUT_MAX_DIGITS - 1, &values[0]) ||
+        !parse_number(argv[2], LAYOUT_MAX_OUTPUTS - 1, &values[1]) || !parse_number(argv[3], UINT16_MAX, &values[2]))
+      return "usage: digit <digit> <output> <base>";
+    layout->digits[values[0]].output = values[1];
+    layout->digits[values[0]].base = values[2];
+    return NULL;
+  }
+
+  if (strcmp(what, "segment") == 0) {
+    bool reversed = argc == 6 && strcmp(argv[5], "r") == 0;
+    if ((argc != 5 && !reversed) || !parse_number(argv[1], LAYOUT_MAX_DIGITS - 1, &values[0]) ||
+        argv[2][0] < 'a' || argv[2][0] >= 'a' + SEGMENTS_PER_DIGIT || argv[2][1] != '\0' ||
+        !parse_number(argv[3], UINT16_MAX, &values[1]) || !parse_number(argv[4], UINT16_MAX, &values[2]))
+      return "usage: segment <digit> <a-g> <start> <count> [r]";
+    layout->digits[values[0]].segments[argv[2][0] - 'a'] = (layout_segment_t){values[1], values[2], reversed};
+    return NULL;
+  }
+
+  if (strcmp(what, "indicator") == 0) {
+    if (argc != 5 || !parse_number(argv[1], LAYOUT_MAX_INDICATORS - 1, &values[0]) ||
+        !parse_number(argv[2], LAYOUT_MAX_OUTPUTS - 1, &values[1]) ||
+        !parse_number(argv[3], UINT16_MAX, &values[2]) || !parse_number(argv[4], UINT16_MAX, &values[3]))
+      return "usage: indicator <indicator> <output> <start> <count>";
+    layout->indicators[values[0]] = (layout_indicator_t){values[1], values[2], values[3]};
+    if (layout->indicator_count <= values[0])
+      layout->indicator_count = values[0] + 1;
+    return NULL;
+  }
+  return "unknown edit (digits, digit, segment, indicator)";
+}
+
+// Absolute range of a run on its chain; false if it doesn't fit the chain
+static bool place(const layout_output_t *output, uint32_t offset, uint32_t count, segment_range_t *range) {
+  if (offset + count > output->led_count)
+    return false;
+  *range = (segment_range_t){output->first_led + offset, count};
+  return true;
+}
+
+static void mark_active(compiled_layout_t *compiled, const layout_output_t *outputs, int out, segment_range_t range) {
+  if (range.count == 0)
+    return;
+  uint16_t end = range.start + range.count;
+  if (end - outputs[out].first_led > compiled->output_active[out])
+    compiled->output_active[out] = end - outputs[out].first_led;
+  if (end > compiled->led_end)
+    compiled->led_end = end;
+}
+
+// Lit segments of one glyph, sorted by position and merged where they touch
+static void compile_glyph(compiled_layout_t *compiled, int digit, uint8_t value) {
+  segment_range_t *spans = &compiled->spans[compiled->span_count];
+  uint8_t pattern = render_digit_pattern(value);
+  int count = 0;
+
+  for (int seg = 0; seg < SEGMENTS_PER_DIGIT; seg++) {
+    segment_range_t range = compiled->segments[digit][seg];
+    if (!(pattern & (1 << seg)) || range.count == 0)
+      continue;
+
+    int j = count++;
+    while (j > 0 && spans[j - 1].start > range.start) {
+      spans[j] = spans[j - 1];
+      j--;
+    }
+    spans[j] = range;
+  }
+
+  int merged = 0;
+  for (int i = 0; i < count; i++) {
+    if (merged > 0 && spans[i].start <= spans[merged - 1].start + spans[merged - 1].count) {
+      uint16_t end = spans[i].start + spans[i].count;
+      if (end > spans[merged - 1].start + spans[merged - 1].count)
+        spans[merged - 1].count = end - spans[merged - 1].start;
+    } else {
+      spans[merged++] = spans[i];
+    }
+  }
+
+  compiled->glyphs[digit][value] = (layout_glyph_t){compiled->span_count, merged};
+  compiled->span_count += merged;
+}
+
+const char *display_layout_compile(const display_layout_t *layout, const layout_output_t *outputs, int output_count,
+                                   compiled_layout_t *compiled) {
+  if (layout->version != LAYOUT_VERSION)
+    return "unsupported layout version";
+  if (layout->digit_count == 0 || layout->digit_count > LAYOUT_MAX_DIGITS)
+    return "bad digit count";
+  if (layout->indicator_count > LAYOUT_MAX_INDICATORS)
+    return "bad indicator count";
+  if (output_count > LAYOUT_MAX_OUTPUTS)
+    return "too many outputs";
+
+  memset(compiled, 0, sizeof(*compiled));
+  compiled->digit_count = layout->digit_count;
+  compiled->indicator_count = layout->indicator_count;
+
+  for (int digit = 0; digit < layout->digit_count; digit++) {
+    const layout_digit_t *source = &layout->digits[digit];
+    if (source->output >= output_count)
+      return "digit on a missing output";
+
+    compiled->digit_output[digit] = source->output;
+    for (int seg = 0; seg < SEGMENTS_PER_DIGIT; seg++) {
+      const layout_segment_t *segment = &source->segments[seg];
+      segment_range_t *range = &compiled->segments[digit][seg];
+      if (!place(&outputs[source->output], (uint32_t)source->base + segment->start, segment->count, range))
+        return "segment runs past the end of its chain";
+      if (segment->reversed)
+        compiled->reversed[digit] |= 1 << seg;
+      mark_active(compiled, outputs, source->output, *range);
+    }
+  }
+
+  for (int i = 0; i < layout->indicator_count; i++) {
+    const layout_indicator_t *indicator = &layout->indicators[i];
+    if (indicator->output >= output_count)
+      return "indicator on a missing output";
+    if (!place(&outputs[indicator->output], indicator->start, indicator->count, &compiled->indicators[i]))
+      return "indicator runs past the end of its chain";
+    mark_active(compiled, outputs, indicator->output, compiled->indicators[i]);
+  }
+
+  for (int digit = 0; digit < layout->digit_count; digit++) {
+    for (uint8_t value = 0; value < LAYOUT_GLYPHS; value++) {
+      compile_glyph(compiled, digit, value);
+    }
+  }
+  return NULL;
+}
@@ -0,0 +1,160 @@
+#include "../include/display_render.h"
+#include <math.h>
+
+// 7-segment digit patterns (0-9)
+// Each bit represents a segment: A,B,C,D,E,F,G
+static const uint8_t digit_patterns[10] = {
+  0x3F, // 0: A+B+C+D+E+F
+  0x06, // 1: B+C
+  0x5B, // 2: A+B+G+E+D
+  0x4F, // 3: A+B+C+D+G
+  0x66, // 4: F+G+B+C
+  0x6D, // 5: A+F+G+C+D
+  0x7D, // 6: A+F+G+C+D+E
+  0x07, // 7: A+B+C
+  0x7F, // 8: A+B+C+D+E+F+G
+  0x6F  // 9: A+B+C+D+F+G
+};
+
+uint8_t render_digit_pattern(uint8_t value) {
+  return value < 10 ? digit_patterns[value] : 0;
+}
+
+uint64_t render_segment_mask(const uint8_t *digits, int digit_count) {
+  uint64_t mask = 0;
+  for (int digit = 0; digit < digit_count; digit++) {
+    mask |= (uint64_t)render_digit_pattern(digits[digit]) << (digit * SEGMENTS_PER_DIGIT);
+  }
+  return mask;
+}
+
+// Largest value that fits in the given number of decimal digits
+static uint32_t largest_value(int digit_count) {
+  uint32_t largest = 0;
+  for (int digit = 0; digit < digit_count && largest < UINT32_MAX / 10; digit++) {
+    largest = largest * 10 + 9;
+  }
+  return largest;
+}
+
+bool render_format_value(render_format_t format, uint32_t value, bool suppress_zeros, uint8_t *digits, int digit_count) {
+  if (digit_count <= 0)
+    return false;
+
+  bool separator = false;
+  int always_shown = 1; // Trailing digits kept even when zero
+  uint32_t shown;
+  if (format == RENDER_FORMAT_MMSS && digit_count >= 3) {
+    uint32_t max_minutes = largest_value(digit_count - 2);
+    uint32_t minutes = value / 60;
+    uint32_t seconds = value % 60;
+    if (minutes > max_minutes) {
+      minutes = max_minutes;
+      seconds = 59;
+    }
+    shown = minutes * 100 + seconds;
+    always_shown = 3;
+    separator = true;
+  } else {
+    uint32_t largest = largest_value(digit_count);
+    shown = value < largest ? value : largest;
+  }
+
+  for (int digit = digit_count - 1; digit >= 0; digit--) {
+    digits[digit] = shown % 10;
+    shown /= 10;
+  }
+  if (suppress_zeros) {
+    for (int digit = 0; digit < digit_count - always_shown && digits[digit] == 0; digit++) {
+      digits[digit] = RENDER_DIGIT_BLANK;
+    }
+  }
+  return separator;
+}
+
+// Pipeline value for one channel:
+//   255 * white_balance * (value / 255)^color_gamma * (brightness / 255)^brightness_gamma
+// Non-zero inputs never round down to black, so dim segments stay lit.
+static uint8_t color_pipeline_value(const display_calibration_t *calibration, int channel, uint8_t value, uint8_t brightness) {
+  if (value == 0 || brightness == 0 || calibration->white_balance[channel] == 0)
+    return 0;
+
+  float out = calibration->white_balance[channel] *
+              powf(value / 255.0f, calibration->color_gamma) *
+              powf(brightness / 255.0f, calibration->brightness_gamma);
+  int rounded = (int)(out + 0.5f);
+  return rounded < 1 ? 1 : (rounded > 255 ? 255 : rounded);
+}
+
+void color_lut_build(color_lut_t *lut, const display_calibration_t *calibration, uint8_t brightness) {
+  lut->calibration = *calibration;
+  for (int channel = 0; channel < 3; channel++) {
+    for (int value = 0; value < 256; value++) {
+      lut->table[channel][value] = color_pipeline_value(calibration, channel, value, brightness);
+    }
+  }
+  lut->brightness = brightness;
+}
+
+// Framebuffer channel sent in each wire slot
+static const uint8_t color_order_sources[][3] = {
+  [COLOR_ORDER_RGB] = {0, 1, 2},
+  [COLOR_ORDER_GRB] = {1, 0, 2},
+  [COLOR_ORDER_BRG] = {2, 0, 1},
+  [COLOR_ORDER_RBG] = {0, 2, 1},
+  [COLOR_ORDER_GBR] = {1, 2, 0},
+  [COLOR_ORDER_BGR] = {2, 1, 0},
+};
+
+void wire_map_build(wire_map_t *map, const color_lut_t *lut, color_order_t order, uint16_t scale) {
+  for (int slot = 0; slot < 3; slot++) {
+    uint8_t source = color_order_sources[order][slot];
+    map->source[slot] = source;
+    for (int value = 0; value < 256; value++) {
+      map->table[slot][value] = (uint8_t)(lut->table[source][value] * scale / WIRE_MAP_SCALE_FULL);
+    }
+  }
+}
+
+// Fill a run of LEDs; adds the change in each channel's value sum to sum_delta
+static bool fill_run(uint8_t *pixel, uint16_t count, const uint8_t rgb[3], int32_t *sum_delta) {
+  bool changed = false;
+  int32_t delta[3] = {0, 0, 0};
+  uint8_t *end = pixel + count * 3;
+  for (; pixel < end; pixel += 3) {
+    if (pixel[0] != rgb[0] || pixel[1] != rgb[1] || pixel[2] != rgb[2]) {
+      delta[0] += rgb[0] - pixel[0];
+      delta[1] += rgb[1] - pixel[1];
+      delta[2] += rgb[2] - pixel[2];
+      pixel[0] = rgb[0];
+      pixel[1] = rgb[1];
+      pixel[2] = rgb[2];
+      changed = true;
+    }
+  }
+  if (sum_delta != NULL) {
+    sum_delta[0] += delta[0];
+    sum_delta[1] += delta[1];
+    sum_delta[2] += delta[2];
+  }
+  return changed;
+}
+
+bool render_fill(uint8_t *pixels, uint16_t led_count, uint16_t start, uint16_t count, const uint8_t rgb[3],
+                 int32_t *sum_delta) {
+  if (start >= led_count)
+    return false;
+  if (count > led_count - start)
+    count = led_count - start;
+
+  return fill_run(&pixels[start * 3], count, rgb, sum_delta);
+}
+
+bool render_fill_spans(uint8_t *pixels, const segment_range_t *spans, size_t span_count, const uint8_t rgb[3],
+                       int32_t *sum_delta) {
+  bool changed = false;
+  for (size_t i = 0; i < span_count; i++) {
+    changed |= fill_run(&pixels[spans[i].start * 3], spans[i].count, rgb, sum_delta);
+  }
+  return changed;
+}
@@ -0,0 +1,50 @@
+#include "../include/frame_scheduler.h"
+#include <string.h>
+
+void frame_scheduler_init(frame_scheduler_t *scheduler, uint32_t rate_hz, int64_t now_us) {
+  memset(scheduler, 0, sizeof(*scheduler));
+  scheduler->period_us = 1000000 / (rate_hz > 0 ? rate_hz : 1);
+  scheduler->budget_us = scheduler->period_us / 100 * FRAME_SCHEDULER_BUDGET_PERCENT;
+  frame_scheduler_resync(scheduler, now_us);
+}
+
+void frame_scheduler_resync(frame_scheduler_t *scheduler, int64_t now_us) {
+  scheduler->deadline_us = now_us + scheduler->period_us;
+  scheduler->skip_render = false;
+}
+
+int64_t frame_scheduler_time_to_deadline(const frame_scheduler_t *scheduler, int64_t now_us) {
+  int64_t remaining = scheduler->deadline_us - now_us;
+  return remaining > 0 ? remaining : 0;
+}
+
+bool frame_scheduler_begin(frame_scheduler_t *scheduler, int64_t now_us) {
+  scheduler->pass_start_us = now_us;
+
+  if (now_us >= scheduler->deadline_us) {
+    // Stay on the grid: late frames are dropped, not run back to back
+    int64_t late_periods = (now_us - scheduler->deadline_us) / scheduler->period_us;
+    scheduler->stats.frames++;
+    scheduler->stats.missed += (uint32_t)late_periods;
+    scheduler->deadline_us += (late_periods + 1) * scheduler->period_us;
+  }
+
+  if (scheduler->skip_render) {
+    scheduler->skip_render = false;
+    scheduler->stats.skipped++;
+    return false;
+  }
+  return true;
+}
+
+void frame_scheduler_end(frame_scheduler_t *scheduler, int64_t now_us) {
+  uint32_t work_us = (uint32_t)(now_us - scheduler->pass_start_us);
+  scheduler->stats.work_us = work_us;
+  if (work_us > scheduler->stats.work_us_max)
+    scheduler->stats.work_us_max = work_us;
+
+  if (work_us > scheduler->budget_us) {
+    scheduler->stats.overruns++;
+    scheduler->skip_render = true;
+  }
+}
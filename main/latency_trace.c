@@ -0,0 +1,182 @@
+#include "../include/latency_trace.h"
+#include "../include/platform.h"
+#include <stdatomic.h>
+#include <string.h>
+
+// Log-linear histogram: exact below 16 us, then 8 buckets per power of two up
+// to ~1 s (12.5% resolution)
+#define LATENCY_EXACT_BUCKETS 16
+#define LATENCY_SUB_BUCKETS 8
+#define LATENCY_MAX_MSB 19
+#define LATENCY_BUCKETS (LATENCY_EXACT_BUCKETS + (LATENCY_MAX_MSB - 3) * LATENCY_SUB_BUCKETS)
+
+// Open trace tag: sequence << 8 | last stage reached
+#define TRACE_TAG(sequence, stage) (((uint32_t)(sequence) << 8) | (uint32_t)(stage))
+#define TRACE_TAG_STAGE(tag) ((tag) & 0xFF)
+#define TRACE_TAG_SEQUENCE(tag) ((uint8_t)((tag) >> 8))
+#define TRACE_CLOSED LATENCY_STAGE_COUNT
+
+typedef struct {
+  uint32_t count;
+  uint32_t min_us;
+  uint32_t max_us;
+  uint64_t sum_us;
+  uint32_t buckets[LATENCY_BUCKETS];
+} latency_histogram_t;
+
+static int marker_pin = LATENCY_TRACE_MARKER_NONE;
+static atomic_uint_least32_t trace_tag = TRACE_TAG(0, TRACE_CLOSED);
+static atomic_uint_least32_t trace_rx_us;
+
+static latency_event_t ring[LATENCY_TRACE_RING_SIZE];
+static atomic_uint_least32_t ring_head;
+
+// Each stage's histogram has a single writer (see latency_trace.h)
+static latency_histogram_t histograms[LATENCY_STAGE_COUNT];
+
+static const char *stage_names[LATENCY_STAGE_COUNT] = {
+  [LATENCY_STAGE_RX] = "rx",
+  [LATENCY_STAGE_PARSE] = "parse",
+  [LATENCY_STAGE_RENDER] = "render",
+  [LATENCY_STAGE_SUBMIT] = "submit",
+  [LATENCY_STAGE_DONE] = "done",
+};
+
+static PLATFORM_ISR_ATTR int bucket_index(uint32_t us) {
+  if (us < LATENCY_EXACT_BUCKETS)
+    return us;
+
+  int msb = 31 - __builtin_clz(us);
+  if (msb > LATENCY_MAX_MSB)
+    return LATENCY_BUCKETS - 1;
+  int sub = (us >> (msb - 3)) & (LATENCY_SUB_BUCKETS - 1);
+  return LATENCY_EXACT_BUCKETS + (msb - 4) * LATENCY_SUB_BUCKETS + sub;
+}
+
+static uint32_t bucket_upper_us(int bucket) {
+  if (bucket < LATENCY_EXACT_BUCKETS)
+    return bucket;
+
+  int msb = 4 + (bucket - LATENCY_EXACT_BUCKETS) / LATENCY_SUB_BUCKETS;
+  int sub = (bucket - LATENCY_EXACT_BUCKETS) % LATENCY_SUB_BUCKETS;
+  return ((uint32_t)(LATENCY_SUB_BUCKETS + sub + 1) << (msb - 3)) - 1;
+}
+
+static PLATFORM_ISR_ATTR void record(latency_stage_t stage, uint8_t sequence, uint32_t now_us, uint32_t latency_us) {
+  uint32_t slot = atomic_fetch_add_explicit(&ring_head, 1, memory_order_relaxed) % LATENCY_TRACE_RING_SIZE;
+  ring[slot] = (latency_event_t){now_us, latency_us, stage, sequence};
+
+  latency_histogram_t *histogram = &histograms[stage];
+  if (histogram->count == 0 || latency_us < histogram->min_us)
+    histogram->min_us = latency_us;
+  if (latency_us > histogram->max_us)
+    histogram->max_us = latency_us;
+  histogram->sum_us += latency_us;
+  histogram->buckets[bucket_index(latency_us)]++;
+  histogram->count++;
+}
+
+static PLATFORM_ISR_ATTR void set_marker(int level) {
+  if (marker_pin != LATENCY_TRACE_MARKER_NONE) {
+    platform_gpio_set(marker_pin, level);
+  }
+}
+
+void latency_trace_init(int pin) {
+  marker_pin = pin;
+  if (marker_pin != LATENCY_TRACE_MARKER_NONE) {
+    platform_gpio_config(marker_pin, PLATFORM_GPIO_OUTPUT);
+    platform_gpio_set(marker_pin, 0);
+  }
+  atomic_store(&trace_tag, TRACE_TAG(0, TRACE_CLOSED));
+  atomic_store(&ring_head, 0);
+  memset(ring, 0, sizeof(ring));
+  latency_trace_reset_stats();
+}
+
+void latency_trace_begin(uint8_t sequence, int64_t rx_us) {
+  // Close first so no stage of the previous trace is measured against the new time
+  atomic_store_explicit(&trace_tag, TRACE_TAG(sequence, TRACE_CLOSED), memory_order_release);
+  atomic_store_explicit(&trace_rx_us, (uint32_t)rx_us, memory_order_relaxed);
+  set_marker(1);
+  record(LATENCY_STAGE_RX, sequence, (uint32_t)rx_us, 0);
+  atomic_store_explicit(&trace_tag, TRACE_TAG(sequence, LATENCY_STAGE_RX), memory_order_release);
+}
+
+PLATFORM_ISR_ATTR void latency_trace_mark(latency_stage_t stage) {
+  uint32_t tag = atomic_load_explicit(&trace_tag, memory_order_acquire);
+  if (TRACE_TAG_STAGE(tag) == TRACE_CLOSED || stage != TRACE_TAG_STAGE(tag) + 1)
+    return;
+
+  uint32_t now_us = (uint32_t)platform_micros();
+  uint32_t latency_us = now_us - atomic_load_explicit(&trace_rx_us, memory_order_relaxed);
+  uint8_t sequence = TRACE_TAG_SEQUENCE(tag);
+  bool expired = latency_us > LATENCY_TRACE_TIMEOUT_US;
+  uint32_t next = TRACE_TAG(sequence, expired ? TRACE_CLOSED : stage);
+
+  // Lost the race against a new trace or another mark - nothing to record
+  if (!atomic_compare_exchange_strong_explicit(&trace_tag, &tag, next, memory_order_acq_rel, memory_order_relaxed))
+    return;
+
+  if (!expired) {
+    record(stage, sequence, now_us, latency_us);
+  }
+  if (expired || stage == LATENCY_STAGE_DONE) {
+    set_marker(0);
+  }
+}
+
+void latency_trace_end(void) {
+  uint32_t tag = atomic_load_explicit(&trace_tag, memory_order_acquire);
+  if (TRACE_TAG_STAGE(tag) == TRACE_CLOSED)
+    return;
+  if (atomic_compare_exchange_strong(&trace_tag, &tag, TRACE_TAG(TRACE_TAG_SEQUENCE(tag), TRACE_CLOSED))) {
+    set_marker(0);
+  }
+}
+
+void latency_trace_get_stats(latency_stage_t stage, latency_stage_stats_t *stats) {
+  memset(stats, 0, sizeof(*stats));
+  if (stage >= LATENCY_STAGE_COUNT)
+    return;
+
+  // Diagnostic snapshot - the writer may update it meanwhile
+  const latency_histogram_t *histogram = &histograms[stage];
+  uint32_t count = histogram->count;
+  if (count == 0)
+    return;
+
+  stats->count = count;
+  stats->min_us = histogram->min_us;
+  stats->max_us = histogram->max_us;
+  stats->avg_us = (uint32_t)(histogram->sum_us / count);
+
+  uint32_t p99_rank = count - count / 100; // ceil(0.99 * count)
+  uint32_t seen = 0;
+  for (int bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+    seen += histogram->buckets[bucket];
+    if (seen >= p99_rank) {
+      uint32_t upper = bucket_upper_us(bucket);
+      stats->p99_us = upper < stats->max_us ? upper : stats->max_us;
+      break;
+    }
+  }
+}
+
+void latency_trace_reset_stats(void) {
+  memset(histograms, 0, sizeof(histograms));
+}
+
+size_t latency_trace_read_events(latency_event_t *events, size_t max) {
+  uint32_t head = atomic_load_explicit(&ring_head, memory_order_relaxed);
+  size_t available = head < LATENCY_TRACE_RING_SIZE ? head : LATENCY_TRACE_RING_SIZE;
+  size_t count = available < max ? available : max;
+  for (size_t i = 0; i < count; i++) {
+    events[i] = ring[(head - count + i) % LATENCY_TRACE_RING_SIZE];
+  }
+  return count;
+}
+
+const char *latency_stage_name(latency_stage_t stage) {
+  return stage < LATENCY_STAGE_COUNT ? stage_names[stage] : "unknown";
+}
@@ -0,0 +1,95 @@
+#include "../include/layout_console.h"
+#include "esp_console.h"
+#include "esp_log.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "LAYOUT_CONSOLE";
+
+static PlayClockDisplay *console_display = NULL;
+static display_layout_t edited; // Owned by the console task
+
+static void print_layout(const display_layout_t *layout) {
+  printf("digits %d\n", layout->digit_count);
+  for (int digit = 0; digit < layout->digit_count; digit++) {
+    const layout_digit_t *source = &layout->digits[digit];
+    printf("digit %d %d %d\n", digit, source->output, source->base);
+    for (int seg = 0; seg < SEGMENTS_PER_DIGIT; seg++) {
+      const layout_segment_t *segment = &source->segments[seg];
+      printf("segment %d %c %d %d%s\n", digit, 'a' + seg, segment->start, segment->count,
+             segment->reversed ? " r" : "");
+    }
+  }
+  for (int i = 0; i < layout->indicator_count; i++) {
+    const layout_indicator_t *indicator = &layout->indicators[i];
+    printf("indicator %d %d %d %d\n", i, indicator->output, indicator->start, indicator->count);
+  }
+}
+
+static int layout_command(int argc, char **argv) {
+  if (argc < 2 || strcmp(argv[1], "show") == 0) {
+    print_layout(&edited);
+    return 0;
+  }
+
+  const char *action = argv[1];
+  if (strcmp(action, "check") == 0 || strcmp(action, "save") == 0) {
+    const char *error = display_check_layout(console_display, &edited);
+    if (error != NULL) {
+      printf("Layout rejected: %s\n", error);
+      return 1;
+    }
+    if (strcmp(action, "check") == 0) {
+      printf("Layout fits the output chains\n");
+      return 0;
+    }
+    return display_store_layout(console_display, &edited) ? 0 : 1;
+  }
+  if (strcmp(action, "revert") == 0) {
+    edited = console_display->layout_source;
+    return 0;
+  }
+  if (strcmp(action, "builtin") == 0) {
+    return display_store_layout(console_display, NULL) ? 0 : 1;
+  }
+
+  const char *error = display_layout_edit(&edited, argc - 1, (const char *const *)&argv[1]);
+  if (error != NULL) {
+    printf("%s\n", error);
+    return 1;
+  }
+  return 0;
+}
+
+bool layout_console_start(PlayClockDisplay *display) {
+  console_display = display;
+  edited = display->layout_source;
+
+  esp_console_repl_t *repl = NULL;
+  esp_console_repl_config_t repl_config = ESP_CONSOLE_REPL_CONFIG_DEFAULT();
+  repl_config.prompt = "clock>";
+  esp_console_dev_uart_config_t uart_config = ESP_CONSOLE_DEV_UART_CONFIG_DEFAULT();
+  esp_err_t err = esp_console_new_repl_uart(&uart_config, &repl_config, &repl);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to create console: %s", esp_err_to_name(err));
+    return false;
+  }
+
+  const esp_console_cmd_t command = {
+    .command = "layout",
+    .help = "Show, edit, check and store the LED layout: layout [show | check | save | revert | builtin | "
+            "digits N | digit D OUT BASE | segment D a-g START COUNT [r] | indicator I OUT START COUNT]",
+    .hint = NULL,
+    .func = &layout_command,
+  };
+  err = esp_console_cmd_register(&command);
+  if (err == ESP_OK)
+    err = esp_console_register_help_command();
+  if (err == ESP_OK)
+    err = esp_console_start_repl(repl);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to start console: %s", esp_err_to_name(err));
+    return false;
+  }
+  return true;
+}
@@ -9,39 +9,185 @@
 
 static const char *TAG = "led_encoder";
 
+#define LED_STRIP_SYMBOLS_PER_BYTE 8
+
 typedef struct {
     rmt_encoder_t base;
-    rmt_encoder_t *bytes_encoder;
-    rmt_encoder_t *copy_encoder;
-    int state;
+    rmt_encoder_t *pixel_encoder; // Simple encoder calling led_strip_encode_pixels()
+    const wire_map_t *wire_map;
+    rmt_symbol_word_t bit0;
+    rmt_symbol_word_t bit1;
     rmt_symbol_word_t reset_code;
 } rmt_led_strip_encoder_t;
 
+// WS2815 specific timing requirements
+static void led_strip_bit_symbols(uint32_t resolution, rmt_symbol_word_t *bit0, rmt_symbol_word_t *bit1)
+{
+    *bit0 = (rmt_symbol_word_t) {
+        .level0 = 1,
+        .duration0 = 0.3 * resolution / 1000000, // T0H=0.3us
+        .level1 = 0,
+        .duration1 = 0.9 * resolution / 1000000, // T0L=0.9us
+    };
+    *bit1 = (rmt_symbol_word_t) {
+        .level0 = 1,
+        .duration0 = 0.9 * resolution / 1000000, // T1H=0.9us
+        .level1 = 0,
+        .duration1 = 0.3 * resolution / 1000000, // T1L=0.3us
+    };
+}
+
+static rmt_symbol_word_t led_strip_reset_symbol(uint32_t resolution)
+{
+    uint32_t reset_ticks = resolution / 1000000 * 300 / 2; // WS2815 reset code duration: 300us
+    return (rmt_symbol_word_t) {
+        .level0 = 0,
+        .duration0 = reset_ticks,
+        .level1 = 0,
+        .duration1 = reset_ticks,
+    };
+}
+
+// Wire byte at index of a frame: through the map, pixel by pixel, when there is one
+static inline uint8_t led_strip_wire_byte(const wire_map_t *wire_map, const uint8_t *data, size_t index)
+{
+    if (wire_map == NULL) {
+        return data[index];
+    }
+    size_t pixel = index / 3;
+    size_t slot = index - pixel * 3;
+    return wire_map->table[slot][data[pixel * 3 + wire_map->source[slot]]];
+}
+
+// Simple encoder callback, run from the RMT refill interrupt: as many whole
+// bytes as fit, then the reset code
+RMT_ENCODER_FUNC_ATTR
+static size_t led_strip_encode_pixels(const void *data, size_t data_size, size_t symbols_written, size_t symbols_free, rmt_symbol_word_t *symbols, bool *done, void *arg)
+{
+    rmt_led_strip_encoder_t *led_encoder = (rmt_led_strip_encoder_t *)arg;
+    size_t index = symbols_written / LED_STRIP_SYMBOLS_PER_BYTE;
+    size_t written = 0;
+    while (index < data_size && symbols_free - written >= LED_STRIP_SYMBOLS_PER_BYTE) {
+        uint8_t value = led_strip_wire_byte(led_encoder->wire_map, data, index++);
+        for (int bit = 0; bit < LED_STRIP_SYMBOLS_PER_BYTE; bit++) {
+            // MSB first
+            symbols[written++] = (value & (0x80 >> bit)) ? led_encoder->bit1 : led_encoder->bit0;
+        }
+    }
+    if (index == data_size && written < symbols_free) {
+        symbols[written++] = led_encoder->reset_code;
+        *done = true;
+    }
+    return written;
+}
+
 RMT_ENCODER_FUNC_ATTR
 static size_t rmt_encode_led_strip(rmt_encoder_t *encoder, rmt_channel_handle_t channel, const void *primary_data, size_t data_size, rmt_encode_state_t *ret_state)
 {
     rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
-    rmt_encoder_handle_t bytes_encoder = led_encoder->bytes_encoder;
-    rmt_encoder_handle_t copy_encoder = led_encoder->copy_encoder;
+    return led_encoder->pixel_encoder->encode(led_encoder->pixel_encoder, channel, primary_data, data_size, ret_state);
+}
+
+static esp_err_t rmt_del_led_strip_encoder(rmt_encoder_t *encoder)
+{
+    rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
+    rmt_del_encoder(led_encoder->pixel_encoder);
+    free(led_encoder);
+    return ESP_OK;
+}
+
+RMT_ENCODER_FUNC_ATTR
+static esp_err_t rmt_led_strip_encoder_reset(rmt_encoder_t *encoder)
+{
+    rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
+    return rmt_encoder_reset(led_encoder->pixel_encoder);
+}
+
+esp_err_t rmt_new_led_strip_encoder(const led_strip_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder)
+{
+    esp_err_t ret = ESP_OK;
+    rmt_led_strip_encoder_t *led_encoder = NULL;
+    ESP_GOTO_ON_FALSE(config && ret_encoder, ESP_ERR_INVALID_ARG, err, TAG, "invalid argument");
+    led_encoder = rmt_alloc_encoder_mem(sizeof(rmt_led_strip_encoder_t));
+    ESP_GOTO_ON_FALSE(led_encoder, ESP_ERR_NO_MEM, err, TAG, "no mem for led strip encoder");
+    led_encoder->base.encode = rmt_encode_led_strip;
+    led_encoder->base.del = rmt_del_led_strip_encoder;
+    led_encoder->base.reset = rmt_led_strip_encoder_reset;
+    led_encoder->wire_map = config->wire_map;
+    led_strip_bit_symbols(config->resolution, &led_encoder->bit0, &led_encoder->bit1);
+    led_encoder->reset_code = led_strip_reset_symbol(config->resolution);
+
+    // WS2815 transfer bit order: G7...G0R7...R0B7...B0 - the wire map puts the channels in order
+    rmt_simple_encoder_config_t pixel_encoder_config = {
+        .callback = led_strip_encode_pixels,
+        .arg = led_encoder,
+        .min_chunk_size = LED_STRIP_SYMBOLS_PER_BYTE,
+    };
+    ESP_GOTO_ON_ERROR(rmt_new_simple_encoder(&pixel_encoder_config, &led_encoder->pixel_encoder), err, TAG, "create pixel encoder failed");
+    *ret_encoder = &led_encoder->base;
+    return ESP_OK;
+err:
+    if (led_encoder) {
+        free(led_encoder);
+    }
+    return ret;
+}
+
+esp_err_t led_strip_encode_symbols(const led_strip_encoder_config_t *config, const uint8_t *data, size_t data_size, rmt_symbol_word_t *symbols)
+{
+    ESP_RETURN_ON_FALSE(config && data && symbols, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    rmt_symbol_word_t bit0, bit1;
+    led_strip_bit_symbols(config->resolution, &bit0, &bit1);
+    for (size_t i = 0; i < data_size; i++) {
+        uint8_t value = led_strip_wire_byte(config->wire_map, data, i);
+        for (int bit = 0; bit < LED_STRIP_SYMBOLS_PER_BYTE; bit++) {
+            // MSB first, same as the strip encoder
+            *symbols++ = (value & (0x80 >> bit)) ? bit1 : bit0;
+        }
+    }
+    return ESP_OK;
+}
+
+typedef struct {
+    rmt_encoder_t base;
+    rmt_encoder_t *copy_encoder;
+    int state;
+    size_t span_index;
+    rmt_symbol_word_t reset_code;
+} rmt_led_span_encoder_t;
+
+RMT_ENCODER_FUNC_ATTR
+static size_t rmt_encode_led_spans(rmt_encoder_t *encoder, rmt_channel_handle_t channel, const void *primary_data, size_t data_size, rmt_encode_state_t *ret_state)
+{
+    rmt_led_span_encoder_t *span_encoder = __containerof(encoder, rmt_led_span_encoder_t, base);
+    rmt_encoder_handle_t copy_encoder = span_encoder->copy_encoder;
+    const led_symbol_span_t *spans = (const led_symbol_span_t *)primary_data;
+    size_t span_count = data_size / sizeof(led_symbol_span_t);
     rmt_encode_state_t session_state = RMT_ENCODING_RESET;
     rmt_encode_state_t state = RMT_ENCODING_RESET;
     size_t encoded_symbols = 0;
-    switch (led_encoder->state) {
-    case 0: // send RGB data
-        encoded_symbols += bytes_encoder->encode(bytes_encoder, channel, primary_data, data_size, &session_state);
-        if (session_state & RMT_ENCODING_COMPLETE) {
-            led_encoder->state = 1; // switch to next state when current encoding session finished
-        }
-        if (session_state & RMT_ENCODING_MEM_FULL) {
-            state |= RMT_ENCODING_MEM_FULL;
-            goto out; // yield if there's no free space for encoding artifacts
+    switch (span_encoder->state) {
+    case 0: // copy cached symbol runs
+        while (span_encoder->span_index < span_count) {
+            const led_symbol_span_t *span = &spans[span_encoder->span_index];
+            encoded_symbols += copy_encoder->encode(copy_encoder, channel, span->symbols,
+                                                    span->count * sizeof(rmt_symbol_word_t), &session_state);
+            if (session_state & RMT_ENCODING_COMPLETE) {
+                span_encoder->span_index++;
+            }
+            if (session_state & RMT_ENCODING_MEM_FULL) {
+                state |= RMT_ENCODING_MEM_FULL;
+                goto out; // yield if there's no free space for encoding artifacts
+            }
         }
+        span_encoder->state = 1;
     // fall-through
     case 1: // send reset code
-        encoded_symbols += copy_encoder->encode(copy_encoder, channel, &led_encoder->reset_code,
-                                                sizeof(led_encoder->reset_code), &session_state);
+        encoded_symbols += copy_encoder->encode(copy_encoder, channel, &span_encoder->reset_code,
+                                                sizeof(span_encoder->reset_code), &session_state);
         if (session_state & RMT_ENCODING_COMPLETE) {
-            led_encoder->state = RMT_ENCODING_RESET; // back to the initial encoding session
+            span_encoder->state = RMT_ENCODING_RESET; // back to the initial encoding session
+            span_encoder->span_index = 0;
             state |= RMT_ENCODING_COMPLETE;
         }
         if (session_state & RMT_ENCODING_MEM_FULL) {
@@ -54,73 +200,46 @@ out:
     return encoded_symbols;
 }
 
-static esp_err_t rmt_del_led_strip_encoder(rmt_encoder_t *encoder)
+static esp_err_t rmt_del_led_span_encoder(rmt_encoder_t *encoder)
 {
-    rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
-    rmt_del_encoder(led_encoder->bytes_encoder);
-    rmt_del_encoder(led_encoder->copy_encoder);
-    free(led_encoder);
+    rmt_led_span_encoder_t *span_encoder = __containerof(encoder, rmt_led_span_encoder_t, base);
+    rmt_del_encoder(span_encoder->copy_encoder);
+    free(span_encoder);
     return ESP_OK;
 }
 
 RMT_ENCODER_FUNC_ATTR
-static esp_err_t rmt_led_strip_encoder_reset(rmt_encoder_t *encoder)
+static esp_err_t rmt_led_span_encoder_reset(rmt_encoder_t *encoder)
 {
-    rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
-    rmt_encoder_reset(led_encoder->bytes_encoder);
-    rmt_encoder_reset(led_encoder->copy_encoder);
-    led_encoder->state = RMT_ENCODING_RESET;
+    rmt_led_span_encoder_t *span_encoder = __containerof(encoder, rmt_led_span_encoder_t, base);
+    rmt_encoder_reset(span_encoder->copy_encoder);
+    span_encoder->state = RMT_ENCODING_RESET;
+    span_encoder->span_index = 0;
     return ESP_OK;
 }
 
-esp_err_t rmt_new_led_strip_encoder(const led_strip_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder)
+esp_err_t rmt_new_led_span_encoder(const led_strip_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder)
 {
     esp_err_t ret = ESP_OK;
-    rmt_led_strip_encoder_t *led_encoder = NULL;
+    rmt_led_span_encoder_t *span_encoder = NULL;
     ESP_GOTO_ON_FALSE(config && ret_encoder, ESP_ERR_INVALID_ARG, err, TAG, "invalid argument");
-    led_encoder = rmt_alloc_encoder_mem(sizeof(rmt_led_strip_encoder_t));
-    ESP_GOTO_ON_FALSE(led_encoder, ESP_ERR_NO_MEM, err, TAG, "no mem for led strip encoder");
-    led_encoder->base.encode = rmt_encode_led_strip;
-    led_encoder->base.del = rmt_del_led_strip_encoder;
-    led_encoder->base.reset = rmt_led_strip_encoder_reset;
-    // WS2815 specific timing requirements
-    rmt_bytes_encoder_config_t bytes_encoder_config = {
-        .bit0 = {
-            .level0 = 1,
-            .duration0 = 0.3 * config->resolution / 1000000, // T0H=0.3us
-            .level1 = 0,
-            .duration1 = 0.9 * config->resolution / 1000000, // T0L=0.9us
-        },
-        .bit1 = {
-            .level0 = 1,
-            .duration0 = 0.9 * config->resolution / 1000000, // T1H=0.9us
-            .level1 = 0,
-            .duration1 = 0.3 * config->resolution / 1000000, // T1L=0.3us
-        },
-        .flags.msb_first = 1 // WS2815 transfer bit order: G7...G0R7...R0B7...B0
-    };
-    ESP_GOTO_ON_ERROR(rmt_new_bytes_encoder(&bytes_encoder_config, &led_encoder->bytes_encoder), err, TAG, "create bytes encoder failed");
+    span_encoder = rmt_alloc_encoder_mem(sizeof(rmt_led_span_encoder_t));
+    ESP_GOTO_ON_FALSE(span_encoder, ESP_ERR_NO_MEM, err, TAG, "no mem for led span encoder");
+    span_encoder->base.encode = rmt_encode_led_spans;
+    span_encoder->base.del = rmt_del_led_span_encoder;
+    span_encoder->base.reset = rmt_led_span_encoder_reset;
     rmt_copy_encoder_config_t copy_encoder_config = {};
-    ESP_GOTO_ON_ERROR(rmt_new_copy_encoder(&copy_encoder_config, &led_encoder->copy_encoder), err, TAG, "create copy encoder failed");
+    ESP_GOTO_ON_ERROR(rmt_new_copy_encoder(&copy_encoder_config, &span_encoder->copy_encoder), err, TAG, "create copy encoder failed");
 
-    uint32_t reset_ticks = config->resolution / 1000000 * 300 / 2; // WS2815 reset code duration: 300us
-    led_encoder->reset_code = (rmt_symbol_word_t) {
-        .level0 = 0,
-        .duration0 = reset_ticks,
-        .level1 = 0,
-        .duration1 = reset_ticks,
-    };
-    *ret_encoder = &led_encoder->base;
+    span_encoder->reset_code = led_strip_reset_symbol(config->resolution);
+    *ret_encoder = &span_encoder->base;
     return ESP_OK;
 err:
-    if (led_encoder) {
-        if (led_encoder->bytes_encoder) {
-            rmt_del_encoder(led_encoder->bytes_encoder);
-        }
-        if (led_encoder->copy_encoder) {
-            rmt_del_encoder(led_encoder->copy_encoder);
+    if (span_encoder) {
+        if (span_encoder->copy_encoder) {
+            rmt_del_encoder(span_encoder->copy_encoder);
         }
-        free(led_encoder);
+        free(span_encoder);
     }
     return ret;
 }
@@ -0,0 +1,74 @@
+#include "../include/led_transport.h"
+#include "../include/platform.h"
+#include "esp_log.h"
+
+static const char *TAG = "LED_TRANSPORT";
+
+esp_err_t led_transport_new(led_transport_kind_t kind, const led_transport_config_t *config, led_transport_t **ret_transport) {
+  if (!config || !ret_transport) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  ESP_LOGI(TAG, "Creating %s transport on GPIO %d for %d LEDs",
+           led_transport_kind_name(kind), config->gpio_num, (int)config->max_leds);
+
+  switch (kind) {
+  case LED_TRANSPORT_RMT:
+    return led_transport_new_rmt(config, false, ret_transport);
+  case LED_TRANSPORT_RMT_DMA:
+    return led_transport_new_rmt(config, true, ret_transport);
+  case LED_TRANSPORT_SPI_DMA:
+    return led_transport_new_spi(config, ret_transport);
+  }
+
+  ESP_LOGE(TAG, "Unknown transport kind %d", kind);
+  return ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t led_transport_sync_group(led_transport_t **transports, size_t count) {
+  if (!transports || count == 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    if (transports[i]->kind == LED_TRANSPORT_SPI_DMA) {
+      ESP_LOGE(TAG, "%s transport can't run synchronized outputs", transports[i]->name);
+      return ESP_ERR_NOT_SUPPORTED;
+    }
+  }
+  return led_transport_rmt_sync_group(transports, count);
+}
+
+void led_transport_abort(led_transport_t *transport) {
+  if (transport && transport->abort) {
+    transport->abort(transport);
+  }
+}
+
+const char *led_transport_kind_name(led_transport_kind_t kind) {
+  switch (kind) {
+  case LED_TRANSPORT_RMT:
+    return "RMT";
+  case LED_TRANSPORT_RMT_DMA:
+    return "RMT+DMA";
+  case LED_TRANSPORT_SPI_DMA:
+    return "SPI+DMA";
+  }
+  return "unknown";
+}
+
+PLATFORM_ISR_ATTR void led_transport_frame_done(led_transport_t *transport, int64_t start_us, uint32_t irq_count, uint32_t irq_ns) {
+  uint32_t frame_us = (uint32_t)(platform_micros() - start_us);
+
+  transport->stats.frames++;
+  transport->stats.frame_us = frame_us;
+  if (frame_us > transport->stats.frame_us_max) {
+    transport->stats.frame_us_max = frame_us;
+  }
+  transport->stats.irq_count = irq_count;
+  transport->stats.irq_us = irq_ns / 1000;
+
+  if (transport->on_done) {
+    transport->on_done(transport->done_arg);
+  }
+}
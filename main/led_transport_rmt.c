@@ -0,0 +1,240 @@
+#include "../include/led_transport.h"
+#include "driver/rmt_tx.h"
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "soc/soc_caps.h"
+#include <stdlib.h>
+
+static const char *TAG = "LED_TRANSPORT_RMT";
+
+// RMT memory per channel: one block without DMA, a large DMA buffer where supported
+#define RMT_MEM_BLOCK_SYMBOLS 64
+#define RMT_DMA_MEM_SYMBOLS 1024
+// ESP32 has no RMT DMA - borrow extra memory blocks to cut refill interrupts instead
+#define RMT_LARGE_MEM_SYMBOLS 256
+#define RMT_TRANS_QUEUE_DEPTH 4
+#define RMT_MAX_SYNC_CHANNELS 8
+
+typedef struct {
+  led_transport_t base;
+  rmt_channel_handle_t channel;
+  rmt_encoder_handle_t strip_encoder;
+  rmt_encoder_handle_t span_encoder;
+  rmt_sync_manager_handle_t sync_manager; // Shared by a synchronized group
+  bool owns_sync_manager;
+
+  // Wrapper around the encoder used for the current frame; every encode call
+  // after the first one runs from the RMT refill interrupt, so it is timed here
+  rmt_encoder_t stats_encoder;
+  rmt_encoder_handle_t active_encoder;
+  volatile uint32_t irq_count;
+  volatile uint32_t irq_ns;
+  volatile int64_t start_us;
+} rmt_led_transport_t;
+
+RMT_ENCODER_FUNC_ATTR
+static size_t rmt_encode_with_stats(rmt_encoder_t *encoder, rmt_channel_handle_t channel, const void *primary_data, size_t data_size, rmt_encode_state_t *ret_state) {
+  rmt_led_transport_t *transport = __containerof(encoder, rmt_led_transport_t, stats_encoder);
+  uint32_t start = esp_cpu_get_cycle_count();
+  size_t encoded = transport->active_encoder->encode(transport->active_encoder, channel, primary_data, data_size, ret_state);
+  // Converted at the clock the cycles ran at: DFS may change it between refills
+  uint32_t cycles = esp_cpu_get_cycle_count() - start;
+  uint32_t mhz = esp_rom_get_cpu_ticks_per_us();
+  transport->irq_ns += cycles / mhz * 1000 + cycles % mhz * 1000 / mhz;
+  transport->irq_count++;
+  return encoded;
+}
+
+RMT_ENCODER_FUNC_ATTR
+static esp_err_t rmt_stats_encoder_reset(rmt_encoder_t *encoder) {
+  rmt_led_transport_t *transport = __containerof(encoder, rmt_led_transport_t, stats_encoder);
+  return rmt_encoder_reset(transport->active_encoder);
+}
+
+static esp_err_t rmt_stats_encoder_del(rmt_encoder_t *encoder) {
+  return ESP_OK; // Embedded in the transport, freed with it
+}
+
+static IRAM_ATTR bool rmt_transport_done_cb(rmt_channel_handle_t channel, const rmt_tx_done_event_data_t *edata, void *user_ctx) {
+  rmt_led_transport_t *transport = (rmt_led_transport_t *)user_ctx;
+  led_transport_frame_done(&transport->base, transport->start_us, transport->irq_count + 1, transport->irq_ns);
+  return false;
+}
+
+static esp_err_t rmt_transport_start(rmt_led_transport_t *transport, rmt_encoder_handle_t encoder, const void *data, size_t size) {
+  rmt_transmit_config_t tx_config = {
+    .loop_count = 0, // no transfer loop
+    .flags.queue_nonblocking = 1,
+  };
+
+  int64_t start_us = esp_timer_get_time();
+  transport->active_encoder = encoder;
+  transport->irq_count = 0;
+  transport->irq_ns = 0;
+  transport->start_us = start_us;
+
+  esp_err_t result = rmt_transmit(transport->channel, &transport->stats_encoder, data, size, &tx_config);
+  transport->base.stats.encode_us = (uint32_t)(esp_timer_get_time() - start_us);
+  return result;
+}
+
+static esp_err_t rmt_transport_submit(led_transport_t *base, const uint8_t *pixels, size_t size) {
+  rmt_led_transport_t *transport = __containerof(base, rmt_led_transport_t, base);
+  return rmt_transport_start(transport, transport->strip_encoder, pixels, size);
+}
+
+static esp_err_t rmt_transport_submit_spans(led_transport_t *base, const led_symbol_span_t *spans, size_t span_count) {
+  rmt_led_transport_t *transport = __containerof(base, rmt_led_transport_t, base);
+  return rmt_transport_start(transport, transport->span_encoder, spans, span_count * sizeof(led_symbol_span_t));
+}
+
+static void rmt_transport_abort(led_transport_t *base) {
+  rmt_led_transport_t *transport = __containerof(base, rmt_led_transport_t, base);
+  // Disabling a TX channel drops its pending transactions
+  rmt_disable(transport->channel);
+  rmt_enable(transport->channel);
+  if (transport->sync_manager) {
+    rmt_sync_reset(transport->sync_manager);
+  }
+}
+
+static void rmt_transport_del(led_transport_t *base) {
+  rmt_led_transport_t *transport = __containerof(base, rmt_led_transport_t, base);
+  if (transport->owns_sync_manager) {
+    rmt_del_sync_manager(transport->sync_manager);
+  }
+  if (transport->channel) {
+    rmt_disable(transport->channel);
+    rmt_del_channel(transport->channel);
+  }
+  if (transport->strip_encoder) {
+    rmt_del_encoder(transport->strip_encoder);
+  }
+  if (transport->span_encoder) {
+    rmt_del_encoder(transport->span_encoder);
+  }
+  free(transport);
+}
+
+esp_err_t led_transport_new_rmt(const led_transport_config_t *config, bool with_dma, led_transport_t **ret_transport) {
+  rmt_led_transport_t *transport = calloc(1, sizeof(rmt_led_transport_t));
+  if (transport == NULL) {
+    ESP_LOGE(TAG, "No memory for RMT transport");
+    return ESP_ERR_NO_MEM;
+  }
+
+  transport->base.name = with_dma ? "RMT+DMA" : "RMT";
+  transport->base.kind = with_dma ? LED_TRANSPORT_RMT_DMA : LED_TRANSPORT_RMT;
+  transport->base.submit = rmt_transport_submit;
+  transport->base.submit_spans = rmt_transport_submit_spans;
+  transport->base.abort = rmt_transport_abort;
+  transport->base.del = rmt_transport_del;
+  transport->base.on_done = config->on_done;
+  transport->base.done_arg = config->done_arg;
+  transport->stats_encoder.encode = rmt_encode_with_stats;
+  transport->stats_encoder.reset = rmt_stats_encoder_reset;
+  transport->stats_encoder.del = rmt_stats_encoder_del;
+
+  // Configure RMT TX channel for WS2815
+  rmt_tx_channel_config_t tx_chan_config = {
+    .clk_src = RMT_CLK_SRC_DEFAULT,
+    .gpio_num = config->gpio_num,
+    .mem_block_symbols = RMT_MEM_BLOCK_SYMBOLS,
+    .resolution_hz = LED_TRANSPORT_RMT_RESOLUTION_HZ,
+    .trans_queue_depth = RMT_TRANS_QUEUE_DEPTH,
+  };
+  if (with_dma) {
+#if SOC_RMT_SUPPORT_DMA
+    tx_chan_config.mem_block_symbols = RMT_DMA_MEM_SYMBOLS;
+    tx_chan_config.flags.with_dma = 1;
+#else
+    ESP_LOGW(TAG, "RMT DMA not supported on this chip - using %d symbol buffer", RMT_LARGE_MEM_SYMBOLS);
+    tx_chan_config.mem_block_symbols = RMT_LARGE_MEM_SYMBOLS;
+#endif
+  }
+
+  esp_err_t result = rmt_new_tx_channel(&tx_chan_config, &transport->channel);
+  if (result != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to create RMT TX channel: %s", esp_err_to_name(result));
+    goto err;
+  }
+
+  // Install LED strip encoder and the span encoder for pre-encoded frames
+  led_strip_encoder_config_t encoder_config = {
+    .resolution = LED_TRANSPORT_RMT_RESOLUTION_HZ,
+    .wire_map = config->wire_map,
+  };
+  result = rmt_new_led_strip_encoder(&encoder_config, &transport->strip_encoder);
+  if (result != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to create LED strip encoder: %s", esp_err_to_name(result));
+    goto err;
+  }
+  result = rmt_new_led_span_encoder(&encoder_config, &transport->span_encoder);
+  if (result != ESP_OK) {
+    ESP_LOGW(TAG, "Failed to create LED span encoder: %s - pre-encoded frames disabled", esp_err_to_name(result));
+    transport->span_encoder = NULL;
+    transport->base.submit_spans = NULL;
+  }
+  transport->active_encoder = transport->strip_encoder;
+
+  rmt_tx_event_callbacks_t tx_callbacks = {
+    .on_trans_done = rmt_transport_done_cb,
+  };
+  result = rmt_tx_register_event_callbacks(transport->channel, &tx_callbacks, transport);
+  if (result != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to register RMT callbacks: %s", esp_err_to_name(result));
+    goto err;
+  }
+
+  result = rmt_enable(transport->channel);
+  if (result != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to enable RMT TX channel: %s", esp_err_to_name(result));
+    goto err;
+  }
+
+  ESP_LOGI(TAG, "RMT transport ready (%d symbols%s)", (int)tx_chan_config.mem_block_symbols,
+           tx_chan_config.flags.with_dma ? ", DMA" : "");
+  *ret_transport = &transport->base;
+  return ESP_OK;
+
+err:
+  if (transport->channel) {
+    rmt_del_channel(transport->channel);
+    transport->channel = NULL;
+  }
+  rmt_transport_del(&transport->base);
+  return result;
+}
+
+esp_err_t led_transport_rmt_sync_group(led_transport_t **transports, size_t count) {
+  if (count > RMT_MAX_SYNC_CHANNELS) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  rmt_channel_handle_t channels[RMT_MAX_SYNC_CHANNELS];
+  for (size_t i = 0; i < count; i++) {
+    channels[i] = __containerof(transports[i], rmt_led_transport_t, base)->channel;
+  }
+
+  rmt_sync_manager_config_t sync_config = {
+    .tx_channel_array = channels,
+    .array_size = count,
+  };
+  rmt_sync_manager_handle_t sync_manager = NULL;
+  esp_err_t result = rmt_new_sync_manager(&sync_config, &sync_manager);
+  if (result != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to create RMT sync manager: %s", esp_err_to_name(result));
+    return result;
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    rmt_led_transport_t *transport = __containerof(transports[i], rmt_led_transport_t, base);
+    transport->sync_manager = sync_manager;
+    transport->owns_sync_manager = (i == 0);
+  }
+  ESP_LOGI(TAG, "%d RMT channels synchronized", (int)count);
+  return ESP_OK;
+}
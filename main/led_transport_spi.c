@@ -0,0 +1,177 @@
+#include "../include/led_transport.h"
+#include "driver/spi_master.h"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "LED_TRANSPORT_SPI";
+
+// HSPI drives the strip; the radio owns VSPI (GPIO 18/19/23)
+#define LED_SPI_HOST SPI2_HOST
+// 3.2 MHz: one SPI bit = 312.5 ns, four SPI bits per WS2815 bit
+//   0 -> 1000 (T0H 0.31 us, T0L 0.94 us), 1 -> 1110 (T1H 0.94 us, T1L 0.31 us)
+#define LED_SPI_CLOCK_HZ 3200000
+#define LED_SPI_BYTES_PER_DATA_BYTE 4
+#define LED_SPI_BIT0_PATTERN 0x8
+#define LED_SPI_BIT1_PATTERN 0xE
+// Trailing low time for the WS2815 latch: 128 bytes = 320 us at 3.2 MHz
+#define LED_SPI_RESET_BYTES 128
+
+typedef struct {
+  led_transport_t base;
+  bool bus_initialized;
+  spi_device_handle_t device;
+  spi_transaction_t transaction;
+  bool transaction_pending; // Queued and not yet reaped with spi_device_get_trans_result()
+  uint8_t *dma_buffer;
+  size_t dma_capacity;
+  const wire_map_t *wire_map;
+  volatile int64_t start_us;
+} spi_led_transport_t;
+
+// SPI bit pattern for each nibble of a data byte, MSB first
+static uint16_t nibble_patterns[16];
+
+static void build_nibble_patterns(void) {
+  for (int nibble = 0; nibble < 16; nibble++) {
+    uint16_t pattern = 0;
+    for (int bit = 3; bit >= 0; bit--) {
+      pattern = (pattern << 4) | ((nibble & (1 << bit)) ? LED_SPI_BIT1_PATTERN : LED_SPI_BIT0_PATTERN);
+    }
+    nibble_patterns[nibble] = pattern;
+  }
+}
+
+// SPI post-transaction callback (ISR) - the whole frame went out in one DMA transaction
+static IRAM_ATTR void spi_transport_post_cb(spi_transaction_t *transaction) {
+  spi_led_transport_t *transport = (spi_led_transport_t *)transaction->user;
+  led_transport_frame_done(&transport->base, transport->start_us, 1, 0);
+}
+
+static esp_err_t spi_transport_submit(led_transport_t *base, const uint8_t *pixels, size_t size) {
+  spi_led_transport_t *transport = __containerof(base, spi_led_transport_t, base);
+  size_t encoded_size = size * LED_SPI_BYTES_PER_DATA_BYTE + LED_SPI_RESET_BYTES;
+  if (encoded_size > transport->dma_capacity || (transport->wire_map != NULL && size % 3 != 0)) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+
+  // Reap the previous frame; the caller only submits once it has completed
+  if (transport->transaction_pending) {
+    spi_transaction_t *done = NULL;
+    if (spi_device_get_trans_result(transport->device, &done, 0) != ESP_OK) {
+      return ESP_ERR_INVALID_STATE;
+    }
+    transport->transaction_pending = false;
+  }
+
+  int64_t start_us = esp_timer_get_time();
+
+  // Map each pixel to its wire bytes and expand every bit into its SPI bit pattern
+  uint8_t *out = transport->dma_buffer;
+  uint8_t wire[3];
+  for (size_t i = 0; i < size; i++) {
+    uint8_t value = pixels[i];
+    if (transport->wire_map != NULL) {
+      size_t slot = i % 3;
+      if (slot == 0) {
+        wire_map_pixel(transport->wire_map, &pixels[i], wire);
+      }
+      value = wire[slot];
+    }
+    uint16_t high = nibble_patterns[value >> 4];
+    uint16_t low = nibble_patterns[value & 0x0F];
+    out[0] = high >> 8;
+    out[1] = high & 0xFF;
+    out[2] = low >> 8;
+    out[3] = low & 0xFF;
+    out += LED_SPI_BYTES_PER_DATA_BYTE;
+  }
+  memset(out, 0, LED_SPI_RESET_BYTES);
+
+  transport->transaction.length = encoded_size * 8; // In bits
+  transport->transaction.tx_buffer = transport->dma_buffer;
+  transport->start_us = start_us;
+
+  esp_err_t result = spi_device_queue_trans(transport->device, &transport->transaction, 0);
+  if (result == ESP_OK) {
+    transport->transaction_pending = true;
+  }
+  transport->base.stats.encode_us = (uint32_t)(esp_timer_get_time() - start_us);
+  return result;
+}
+
+static void spi_transport_del(led_transport_t *base) {
+  spi_led_transport_t *transport = __containerof(base, spi_led_transport_t, base);
+  if (transport->device) {
+    spi_bus_remove_device(transport->device);
+  }
+  if (transport->bus_initialized) {
+    spi_bus_free(LED_SPI_HOST);
+  }
+  heap_caps_free(transport->dma_buffer);
+  free(transport);
+}
+
+esp_err_t led_transport_new_spi(const led_transport_config_t *config, led_transport_t **ret_transport) {
+  spi_led_transport_t *transport = calloc(1, sizeof(spi_led_transport_t));
+  if (transport == NULL) {
+    ESP_LOGE(TAG, "No memory for SPI transport");
+    return ESP_ERR_NO_MEM;
+  }
+
+  transport->base.name = "SPI+DMA";
+  transport->base.kind = LED_TRANSPORT_SPI_DMA;
+  transport->base.submit = spi_transport_submit;
+  transport->base.submit_spans = NULL; // Not an RMT backend
+  transport->base.del = spi_transport_del;
+  transport->base.on_done = config->on_done;
+  transport->base.done_arg = config->done_arg;
+  transport->wire_map = config->wire_map;
+  transport->transaction.user = transport;
+  build_nibble_patterns();
+
+  transport->dma_capacity = config->max_leds * 3 * LED_SPI_BYTES_PER_DATA_BYTE + LED_SPI_RESET_BYTES;
+  transport->dma_buffer = heap_caps_malloc(transport->dma_capacity, MALLOC_CAP_DMA);
+  if (transport->dma_buffer == NULL) {
+    ESP_LOGE(TAG, "No memory for %d byte SPI DMA buffer", (int)transport->dma_capacity);
+    spi_transport_del(&transport->base);
+    return ESP_ERR_NO_MEM;
+  }
+
+  spi_bus_config_t bus_config = {
+    .mosi_io_num = config->gpio_num,
+    .miso_io_num = -1,
+    .sclk_io_num = -1,
+    .quadwp_io_num = -1,
+    .quadhd_io_num = -1,
+    .max_transfer_sz = transport->dma_capacity,
+  };
+  esp_err_t result = spi_bus_initialize(LED_SPI_HOST, &bus_config, SPI_DMA_CH_AUTO);
+  if (result != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to initialize SPI bus: %s", esp_err_to_name(result));
+    spi_transport_del(&transport->base);
+    return result;
+  }
+  transport->bus_initialized = true;
+
+  spi_device_interface_config_t device_config = {
+    .mode = 0,
+    .clock_speed_hz = LED_SPI_CLOCK_HZ,
+    .spics_io_num = -1,
+    .queue_size = 1,
+    .post_cb = spi_transport_post_cb,
+  };
+  result = spi_bus_add_device(LED_SPI_HOST, &device_config, &transport->device);
+  if (result != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to add SPI device: %s", esp_err_to_name(result));
+    spi_transport_del(&transport->base);
+    return result;
+  }
+
+  ESP_LOGI(TAG, "SPI transport ready (%d byte DMA buffer at %d Hz)", (int)transport->dma_capacity, LED_SPI_CLOCK_HZ);
+  *ret_transport = &transport->base;
+  return ESP_OK;
+}
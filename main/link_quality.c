@@ -0,0 +1,135 @@
+#include "../include/link_quality.h"
+#include <stdio.h>
+#include <string.h>
+
+static const uint16_t jitter_edges_ms[LINK_QUALITY_JITTER_BINS - 1] = LINK_QUALITY_JITTER_EDGES_MS;
+
+void link_quality_init(link_quality_t *link) {
+  memset(link, 0, sizeof(*link));
+}
+
+static void push_frames(link_quality_t *link, uint32_t count, bool lost) {
+  if (count > LINK_QUALITY_WINDOW_FRAMES)
+    count = LINK_QUALITY_WINDOW_FRAMES;
+  for (uint32_t i = 0; i < count; i++) {
+    link->history = (link->history << 1) | (lost ? 1 : 0);
+  }
+  uint32_t frames = link->history_frames + count;
+  link->history_frames = frames < LINK_QUALITY_WINDOW_FRAMES ? frames : LINK_QUALITY_WINDOW_FRAMES;
+}
+
+static void add_jitter(link_quality_t *link, uint32_t deviation_us) {
+  link->jitter_us += ((int32_t)deviation_us - (int32_t)link->jitter_us) / LINK_QUALITY_JITTER_WEIGHT;
+
+  int bin = 0;
+  while (bin < LINK_QUALITY_JITTER_BINS - 1 && deviation_us >= jitter_edges_ms[bin] * 1000U) {
+    bin++;
+  }
+  link->stats.jitter_bins[bin]++;
+}
+
+void link_quality_on_batch(link_quality_t *link, const radio_sequence_stats_t *counters, int64_t rx_us) {
+  uint32_t accepted = counters->accepted - link->last_counters.accepted;
+  uint32_t lost = counters->lost - link->last_counters.lost;
+  link->stats.retransmits += counters->duplicates - link->last_counters.duplicates;
+  link->last_counters = *counters;
+
+  // Frames skipped over came before the one that showed the gap
+  push_frames(link, lost, true);
+  push_frames(link, accepted, false);
+  link->stats.frames += lost + accepted;
+  link->stats.lost += lost;
+  if (accepted == 0)
+    return;
+
+  // The batch closes an interval per frame since the previous one, lost or
+  // not; silences long enough to lose the link say nothing about the rate
+  uint32_t spanned = accepted + lost;
+  int64_t elapsed_us = rx_us - link->last_arrival_us;
+  if (link->last_arrival_us != 0 && elapsed_us > 0 && elapsed_us <= (int64_t)LINK_QUALITY_MAX_TIMEOUT_MS * 1000) {
+    if (link->interval_samples > 0) {
+      int64_t deviation_us = elapsed_us - (int64_t)link->interval_us * spanned;
+      add_jitter(link, (uint32_t)(deviation_us < 0 ? -deviation_us : deviation_us));
+    }
+    uint32_t sample_us = (uint32_t)(elapsed_us / spanned);
+    if (link->interval_samples == 0) {
+      link->interval_us = sample_us;
+    } else {
+      link->interval_us += ((int32_t)sample_us - (int32_t)link->interval_us) / LINK_QUALITY_INTERVAL_WEIGHT;
+    }
+    link->interval_samples++;
+  }
+  link->last_arrival_us = rx_us;
+}
+
+uint8_t link_quality_loss_percent(const link_quality_t *link) {
+  if (link->history_frames == 0)
+    return 0;
+  return (uint8_t)(__builtin_popcountll(link->history) * 100 / link->history_frames);
+}
+
+uint32_t link_quality_timeout_ms(const link_quality_t *link) {
+  if (link->interval_samples < LINK_QUALITY_MIN_INTERVALS)
+    return LINK_QUALITY_MAX_TIMEOUT_MS;
+
+  uint64_t timeout_us = (uint64_t)link->interval_us * LINK_QUALITY_MISSED_INTERVALS + 4ULL * link->jitter_us;
+  uint32_t timeout_ms = (uint32_t)((timeout_us + 999) / 1000);
+  if (timeout_ms < LINK_QUALITY_MIN_TIMEOUT_MS)
+    return LINK_QUALITY_MIN_TIMEOUT_MS;
+  return timeout_ms < LINK_QUALITY_MAX_TIMEOUT_MS ? timeout_ms : LINK_QUALITY_MAX_TIMEOUT_MS;
+}
+
+void link_quality_summarize(const link_quality_t *link, link_summary_t *summary) {
+  summary->interval_ms =
+      link->interval_samples >= LINK_QUALITY_MIN_INTERVALS ? (link->interval_us + 500) / 1000 : 0;
+  summary->timeout_ms = link_quality_timeout_ms(link);
+  summary->loss_percent = link_quality_loss_percent(link);
+}
+
+link_status_t link_quality_status(const link_summary_t *summary, uint32_t age_ms) {
+  if (age_ms > summary->timeout_ms)
+    return LINK_STATUS_LOST;
+  if (summary->loss_percent >= LINK_QUALITY_DEGRADED_LOSS_PERCENT || age_ms > summary->timeout_ms / 2)
+    return LINK_STATUS_DEGRADED;
+  return LINK_STATUS_GOOD;
+}
+
+uint32_t link_quality_ms_to_change(const link_summary_t *summary, uint32_t age_ms) {
+  if (age_ms > summary->timeout_ms)
+    return UINT32_MAX;
+  uint32_t overdue_ms = summary->timeout_ms / 2;
+  if (age_ms <= overdue_ms && summary->loss_percent < LINK_QUALITY_DEGRADED_LOSS_PERCENT)
+    return overdue_ms - age_ms + 1;
+  return summary->timeout_ms - age_ms + 1;
+}
+
+const char *link_status_name(link_status_t status) {
+  switch (status) {
+  case LINK_STATUS_LOST:
+    return "lost";
+  case LINK_STATUS_DEGRADED:
+    return "degraded";
+  case LINK_STATUS_GOOD:
+    return "good";
+  default:
+    return "?";
+  }
+}
+
+void link_quality_format_jitter(const link_quality_stats_t *stats, char *line, size_t size) {
+  size_t used = 0;
+  line[0] = '\0';
+  for (int bin = 0; bin < LINK_QUALITY_JITTER_BINS && used < size; bin++) {
+    int written;
+    if (bin < LINK_QUALITY_JITTER_BINS - 1) {
+      written = snprintf(line + used, size - used, "%s<%u:%lu", bin > 0 ? " " : "", jitter_edges_ms[bin],
+                         (unsigned long)stats->jitter_bins[bin]);
+    } else {
+      written = snprintf(line + used, size - used, " >=%u:%lu", jitter_edges_ms[bin - 1],
+                         (unsigned long)stats->jitter_bins[bin]);
+    }
+    if (written < 0)
+      break;
+    used += (size_t)written;
+  }
+}
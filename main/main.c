@@ -1,81 +1,131 @@
+#include "../include/app_events.h"
+#include "../include/bench.h"
+#include "../include/clock_engine.h"
 #include "../include/display_driver.h"
+#include "../include/frame_scheduler.h"
+#include "../include/latency_trace.h"
+#include "../include/layout_console.h"
+#include "../include/led_strip_encoder.h"
+#include "../include/platform.h"
+#include "../include/power_idle.h"
 #include "../include/radio_comm.h"
+#include "../include/state_mailbox.h"
+#include "../include/status_led.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "nvs_flash.h"
+#include <stdio.h>
+#include <string.h>
 
 static const char *TAG = "PLAY_CLOCK";
 
 #define STATUS_LED_PIN GPIO_NUM_2
-#define TEST_BUTTON_PIN GPIO_NUM_0  // Boot button on ESP32
-#define LINK_TIMEOUT_MS 10000
-#define BUTTON_DEBOUNCE_MS 50
+#define TEST_BUTTON_PIN GPIO_NUM_0  // Boot button on ESP32, debounce and long press in app_events.h
 #define NUMBER_CYCLE_DELAY_MS 200
-#define LONG_HOLD_MS 2000  // 2 seconds for long hold detection
+#define LATENCY_MARKER_PIN LATENCY_TRACE_MARKER_NONE // GPIO high from packet arrival until the frame is out, for a scope
+
+// Display self-tests (connection test and test pattern, about 15 s). With
+// BOOT_SELF_TEST 0 they only run when the test button is pressed within
+// SELF_TEST_WINDOW_MS of power-on (GPIO0 is a strapping pin, so it can't be
+// held through reset), and the display comes up blank with the radio listening
+// within a few hundred ms. Either way they run from the render task after the
+// radio is up, and packets received meanwhile are shown once they finish.
+#define BOOT_SELF_TEST 0
+#define SELF_TEST_WINDOW_MS 3000
+
+// Run the bench.h micro-benchmarks at boot and print them as CSV on the console,
+// for host/play_clock_bench -i ... -b ... to check against a baseline
+#define RUN_BENCHMARKS 0
+
+// Serial "layout" command (layout_console.h) for rewiring the segments without
+// recompiling; the stored layout applies from the next boot
+#define LAYOUT_CONSOLE 1
+
+// Radio and render tasks run on separate cores and only share the state
+// mailbox, so a long LED transmit never delays packet reception
+#define RADIO_TASK_STACK_SIZE 4096
+#define RADIO_TASK_PRIORITY 10
+#define RADIO_TASK_CORE 0
+#define RENDER_TASK_STACK_SIZE 4096
+#define RENDER_TASK_PRIORITY 5
+#define RENDER_TASK_CORE 1
+#define RENDER_FRAME_RATE_HZ 60 // Animation frames and keepalive
+
+// Diagnostics go out from their own low-priority task, so the console never
+// holds up a render pass
+#define STATS_TASK_STACK_SIZE 4096
+#define STATS_TASK_PRIORITY 1
+#define STATS_TASK_CORE 0
+#define STATS_INTERVAL_MS 5000
+
+// Clock shown on the display: RADIO_RECORD_PLAY_CLOCK, _GAME_CLOCK or _SHOT_CLOCK.
+// Legacy packets only carry the play clock. Pair the game clock with an MM:SS
+// layout (DISPLAY_TIME_FORMAT in display_driver.h).
+#define DISPLAY_CLOCK RADIO_RECORD_PLAY_CLOCK
+
+// Effect while the shown clock sits at zero (ANIM_EFFECT_NONE to keep it steady)
+#define ZERO_EFFECT ANIM_EFFECT_FLASH
+#define ZERO_EFFECT_PERIOD_MS 500
+
+// Link warnings (link_quality.h). The status LED blinks slowly on a good link,
+// faster on a degraded one (loss, or a packet well overdue) and rapidly once it
+// is lost. LINK_WARNING_INDICATOR is a layout indicator (e.g. a dot wired after
+// the digits) lit while the link isn't good; LINK_LOST_EFFECT runs on the
+// digits while it is lost, as they only show the local countdown then.
+#define LINK_WARNING_NONE 0xFF
+#define LINK_WARNING_INDICATOR LINK_WARNING_NONE
+#define LINK_LOST_EFFECT ANIM_EFFECT_PULSE
+#define LINK_LOST_EFFECT_PERIOD_MS 1000
+
+// Idle: once the strip is dark (blanked, or the link lost for LINK_LOST_BLANK_MS)
+// and nothing is due, LED frames stop, the render task only wakes for an event
+// (app_events.h) or a link status change, and the CPU clock drops
+// (power_idle.h). The status LED then gives a short flash every 2 s.
+#define LINK_LOST_BLANK_MS 600000 // 0 keeps the digits up however long the link is lost
 
 static PlayClockDisplay play_clock_display;
 static RadioComm nrf24_radio;
-static SystemState system_state;
-
-// Button state tracking
-static uint32_t last_button_press_time_ms = 0;
-static bool button_pressed_state = false;
-static uint32_t button_hold_start_time_ms = 0;
-static bool long_hold_triggered = false;
-
-// Button debouncing and press detection
-static bool is_button_pressed(void) {
-  uint32_t current_time_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
-  bool current_state = gpio_get_level(TEST_BUTTON_PIN) == 0; // Boot button is active low
-  
-  if (current_state && !button_pressed_state && 
-      (current_time_ms - last_button_press_time_ms > BUTTON_DEBOUNCE_MS)) {
-    button_pressed_state = true;
-    button_hold_start_time_ms = current_time_ms;
-    long_hold_triggered = false; // Reset long hold flag for new press
-    last_button_press_time_ms = current_time_ms;
-    ESP_LOGI(TAG, "Button pressed detected, long_hold_triggered reset to false");
-    return true;
-  }
-  
-  return false;
-}
+static state_mailbox_t state_mailbox;
 
-// Check for long hold (2+ seconds) - only triggers once per press
-static bool is_button_long_held(void) {
-  if (!button_pressed_state || long_hold_triggered) {
-    return false;
-  }
-  
-  uint32_t current_time_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
-  uint32_t hold_time = current_time_ms - button_hold_start_time_ms;
-  if (hold_time >= LONG_HOLD_MS) {
-    ESP_LOGI(TAG, "Long hold detected, hold_time=%d ms", hold_time);
-    long_hold_triggered = true;
-    return true;
+// Render task numbers for the stats task, copied at the end of every pass
+typedef struct {
+  frame_scheduler_stats_t frames;
+  clock_engine_stats_t clock;
+  bool clock_running;
+  float clock_rate;
+  link_status_t link_status;
+} render_stats_t;
+
+static render_stats_t render_stats;
+static portMUX_TYPE render_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Seconds and run state of the shown clock, CLOCK_ENGINE_BLANK when blanked
+static uint16_t shown_clock_seconds(const SystemState *state, clock_run_state_t *run_state) {
+  if (state->protocol_version == 0) {
+    *run_state = CLOCK_RUN_UNKNOWN;
+    return state->seconds == RADIO_PROTOCOL_BLANK_SECONDS ? CLOCK_ENGINE_BLANK : state->seconds;
   }
-  
-  return false;
-}
 
-// Check for button release (to trigger short press action if no long hold)
-static bool is_button_released(void) {
-  bool current_state = gpio_get_level(TEST_BUTTON_PIN) == 0;
-  
-  // Button was pressed and now released
-  if (button_pressed_state && !current_state) {
-    ESP_LOGI(TAG, "Button release detected, long_hold_triggered=%d", long_hold_triggered);
-    button_pressed_state = false;
-    return !long_hold_triggered; // Only return true if long hold wasn't triggered
+  const radio_clock_t *clock = &state->play_clock;
+  if (DISPLAY_CLOCK == RADIO_RECORD_GAME_CLOCK) {
+    clock = &state->game_clock;
+  } else if (DISPLAY_CLOCK == RADIO_RECORD_SHOT_CLOCK) {
+    clock = &state->shot_clock;
   }
-  
-  return false;
+  *run_state = (clock->flags & RADIO_CLOCK_RUNNING) ? CLOCK_RUN_RUNNING : CLOCK_RUN_STOPPED;
+  if (!(state->fields & RADIO_FIELD(DISPLAY_CLOCK)) || (clock->flags & RADIO_CLOCK_BLANK)) {
+    return CLOCK_ENGINE_BLANK;
+  }
+  return (clock->tenths + 9) / 10; // A started second still shows
 }
 
 // Number cycling test - displays 00-99 on both digits
 static void run_number_cycling_test(void) {
   ESP_LOGI(TAG, "Starting number cycling test (00-99)");
+  display_set_transition(&play_clock_display, ANIM_TRANSITION_CUT, 0);
+  display_set_effect(&play_clock_display, ANIM_EFFECT_NONE, 0);
   
   for (int i = 0; i <= 99; i++) {
     display_set_time(&play_clock_display, i);
@@ -88,18 +138,35 @@ static void run_number_cycling_test(void) {
   // Clear display after test
   display_clear(&play_clock_display);
   display_update(&play_clock_display);
+  display_set_transition(&play_clock_display, DISPLAY_TRANSITION, DISPLAY_TRANSITION_MS);
   ESP_LOGI(TAG, "Number cycling test completed");
 }
 
+// Connection test and full test pattern; the display is blank afterwards
+static void run_self_tests(void) {
+  ESP_LOGI(TAG, "=== DISPLAY SELF-TEST ===");
+  int64_t start_us = platform_micros();
+  display_set_stop_mode(&play_clock_display);
+  if (!display_connection_test(&play_clock_display)) {
+    ESP_LOGW(TAG, "LED strip connection test failed - continuing anyway");
+  }
+  display_test_pattern(&play_clock_display);
+  display_clear(&play_clock_display);
+  display_update(&play_clock_display);
+  ESP_LOGI(TAG, "Display self-test completed in %ld ms", (long)((platform_micros() - start_us) / 1000));
+}
+
 // White LED mode - all LEDs white until button released
 static void run_white_led_mode(void) {
   ESP_LOGI(TAG, "Starting white LED mode (hold button)");
   
   display_set_all_white(&play_clock_display);
   
-  // Wait until button is released
-  while (gpio_get_level(TEST_BUTTON_PIN) == 0) {
-    vTaskDelay(pdMS_TO_TICKS(50));
+  // Wait until button is released; state events are picked up afterwards
+  app_event_t event;
+  while (app_events_button_held()) {
+    if (app_events_wait(&event, UINT32_MAX) && event.type == APP_EVENT_BUTTON_UP)
+      break;
   }
   
   // Clear display after mode
@@ -108,146 +175,422 @@ static void run_white_led_mode(void) {
   ESP_LOGI(TAG, "White LED mode completed");
 }
 
+// Radio receive task - sleeps until the nRF24 IRQ fires, publishes the new
+// state and wakes the render task through the event queue
+static void radio_task(void *arg) {
+  SystemState radio_state;
+  memset(&radio_state, 0, sizeof(radio_state));
+  radio_state.last_status_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
+
+  while (1) {
+    uint32_t previous_status_time = radio_state.last_status_time;
+    bool updated = radio_wait_for_message(&nrf24_radio, &radio_state, LINK_QUALITY_MAX_TIMEOUT_MS);
+
+    // Duplicates still refresh the link timestamp
+    if (updated || radio_state.last_status_time != previous_status_time) {
+      state_mailbox_publish(&state_mailbox, &radio_state);
+      app_events_post(APP_EVENT_STATE);
+    }
+  }
+}
+
 static void setup(void) {
   ESP_LOGI(TAG, "Starting Play Clock Application");
 
-  // Configure status LED
-  gpio_reset_pin(STATUS_LED_PIN);
-  gpio_set_direction(STATUS_LED_PIN, GPIO_MODE_OUTPUT);
-  gpio_set_level(STATUS_LED_PIN, 1);
-  
-  // Configure test button (boot button)
-  ESP_LOGI(TAG, "Configuring test button on GPIO %d", TEST_BUTTON_PIN);
-  gpio_reset_pin(TEST_BUTTON_PIN);
-  gpio_set_direction(TEST_BUTTON_PIN, GPIO_MODE_INPUT);
-  gpio_set_pull_mode(TEST_BUTTON_PIN, GPIO_PULLUP_ONLY);
+  // Status LED steady on through setup
+  if (status_led_init(STATUS_LED_PIN)) {
+    status_led_set(STATUS_LED_ON);
+  }
+
+  // Event queue and the test button (boot button)
+  if (!app_events_init(TEST_BUTTON_PIN)) {
+    ESP_LOGW(TAG, "Test button unavailable");
+  }
 
-  memset(&system_state, 0, sizeof(system_state));
-  system_state.last_status_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
+  power_idle_init();
+
+  latency_trace_init(LATENCY_MARKER_PIN);
+
+  SystemState initial_state;
+  memset(&initial_state, 0, sizeof(initial_state));
+  initial_state.last_status_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
+  state_mailbox_init(&state_mailbox, &initial_state);
+
+  // Settings storage (display layout override)
+  esp_err_t nvs_result = nvs_flash_init();
+  if (nvs_result == ESP_ERR_NVS_NO_FREE_PAGES || nvs_result == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+    ESP_LOGW(TAG, "NVS partition needs erasing");
+    nvs_flash_erase();
+    nvs_result = nvs_flash_init();
+  }
+  if (nvs_result != ESP_OK) {
+    ESP_LOGW(TAG, "NVS unavailable (%s) - using built-in settings", esp_err_to_name(nvs_result));
+  }
 
   if (!display_begin(&play_clock_display)) {
     ESP_LOGE(TAG, "Failed to initialize display");
+    status_led_set(STATUS_LED_FAULT_DISPLAY);
     while (1) {
-      gpio_set_level(STATUS_LED_PIN, 0);
-      vTaskDelay(pdMS_TO_TICKS(100));
-      gpio_set_level(STATUS_LED_PIN, 1);
-      vTaskDelay(pdMS_TO_TICKS(100));
+      vTaskDelay(portMAX_DELAY);
     }
   }
 
-  // Run comprehensive display tests BEFORE radio initialization
-  ESP_LOGI(TAG, "=== DISPLAY TESTING PHASE ===");
-  display_set_stop_mode(&play_clock_display);
-  
-  ESP_LOGI(TAG, "Running LED test pattern for hardware verification...");
-  display_test_pattern(&play_clock_display);
-  
-  ESP_LOGI(TAG, "Display testing completed - ready for operation");
-  display_clear(&play_clock_display);
-  display_update(&play_clock_display);
-  vTaskDelay(pdMS_TO_TICKS(500)); // Brief pause before radio
-  
-  ESP_LOGI(TAG, "=== RADIO INITIALIZATION PHASE ===");
+  // Blank until the first packet; whatever the strip showed before a brownout goes dark
+  display_flush(&play_clock_display);
+  ESP_LOGI(TAG, "Display ready at %ld ms", (long)(platform_micros() / 1000));
+
+#if LAYOUT_CONSOLE
+  if (!layout_console_start(&play_clock_display)) {
+    ESP_LOGW(TAG, "Layout console unavailable");
+  }
+#endif
 
   if (!radio_begin(&nrf24_radio, RADIO_CE_PIN, RADIO_CSN_PIN)) {
     ESP_LOGE(TAG, "Failed to initialize radio");
     display_show_error(&play_clock_display);
+    status_led_set(STATUS_LED_FAULT_RADIO);
     while (1) {
-      gpio_set_level(STATUS_LED_PIN, 0);
-      vTaskDelay(pdMS_TO_TICKS(250));
-      gpio_set_level(STATUS_LED_PIN, 1);
-      vTaskDelay(pdMS_TO_TICKS(250));
+      vTaskDelay(portMAX_DELAY);
     }
   }
 
   radio_start_listening(&nrf24_radio);
+  if (RADIO_CHANNEL_HOPPING) {
+    const uint8_t hop_channels[] = RADIO_HOP_CHANNELS;
+    radio_enable_hopping(&nrf24_radio, hop_channels, sizeof(hop_channels));
+  }
   
   // Dump radio registers for debugging
   vTaskDelay(pdMS_TO_TICKS(100)); // Let radio settle
   radio_dump_registers(&nrf24_radio);
 
-  ESP_LOGI(TAG, "Play Clock initialized successfully");
+  if (!radio_enable_irq(&nrf24_radio, RADIO_IRQ_PIN)) {
+    ESP_LOGW(TAG, "Radio IRQ unavailable - polling every %d ms", RADIO_POLL_INTERVAL_MS);
+  }
+
+  ESP_LOGI(TAG, "Play Clock initialized successfully at %ld ms", (long)(platform_micros() / 1000));
 }
 
-static void loop(void) {
-  uint32_t current_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
+// Render task - owns the display and picks the status LED pattern. Runs on a
+// fixed RENDER_FRAME_RATE_HZ grid, and also wakes early on an event (new state
+// from the radio task, the button) or when the local countdown is due to flip.
+static void render_task(void *arg) {
+  SystemState state;
+  memset(&state, 0, sizeof(state));
+  state.last_status_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
+  link_status_t link_status = LINK_STATUS_LOST;
+  uint32_t link_lost_time = 0;
+  bool lost_blank = false; // Link lost for LINK_LOST_BLANK_MS, digits dark
+  bool idle = false;
+  bool have_state = false;
+  bool redraw = false;
+  uint32_t button_down_time = 0;
+  clock_engine_t clock;
+  clock_engine_init(&clock);
+  uint16_t shown_seconds = CLOCK_ENGINE_BLANK;
+  bool trace_pending = false; // Newest packet not rendered yet
+  frame_scheduler_t scheduler;
 
-  // Check for button press (for debouncing and state tracking)
-  if (is_button_pressed()) {
-    ESP_LOGI(TAG, "Button press detected");
-  }
-  
-  // Debug: Show button state every 5 seconds
-  static uint32_t last_debug_time = 0;
-  if (current_time - last_debug_time > 5000) {
-    bool button_state = gpio_get_level(TEST_BUTTON_PIN) == 0;
-    ESP_LOGI(TAG, "Debug: button_state=%d, button_pressed_state=%d", button_state, button_pressed_state);
-    last_debug_time = current_time;
-  }
-  
-  // Check for button long hold
-  if (is_button_long_held()) {
-    ESP_LOGI(TAG, "Button long hold detected - running white LED mode");
-    run_white_led_mode();
-  }
-  
-  // Check for button release (short press)
-  if (is_button_released()) {
-    ESP_LOGI(TAG, "Test button released - running number cycling test");
-    run_number_cycling_test();
+  if (BOOT_SELF_TEST) {
+    run_self_tests();
   }
+  frame_scheduler_init(&scheduler, RENDER_FRAME_RATE_HZ, platform_micros());
+
+  while (1) {
+    // Sleep until an event, the next frame deadline, or the next local digit
+    // flip if that comes first so it lands on time
+    int64_t now_us = platform_micros();
+    int64_t wait_us = frame_scheduler_time_to_deadline(&scheduler, now_us);
+    if (idle) {
+      // No frames: only the next link status change, unless an event comes first
+      int32_t age_ms = (int32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS - state.last_status_time);
+      uint32_t change_ms = have_state ? link_quality_ms_to_change(&state.link, age_ms > 0 ? (uint32_t)age_ms : 0)
+                                      : UINT32_MAX;
+      wait_us = change_ms == UINT32_MAX ? INT64_MAX : (int64_t)change_ms * 1000;
+    }
+    int64_t flip_us = clock_engine_us_to_next_flip(&clock, now_us);
+    if (!lost_blank && flip_us >= 0 && flip_us < wait_us) {
+      wait_us = flip_us;
+    }
+    app_event_t event;
+    bool have_event = app_events_wait(&event, wait_us == INT64_MAX ? UINT32_MAX
+                                              : wait_us > 0        ? (uint32_t)((wait_us + 999) / 1000)
+                                                                   : 0);
+    if (idle) {
+      // The grid stood still while idle - not missed frames
+      frame_scheduler_resync(&scheduler, platform_micros());
+    }
+    bool render = frame_scheduler_begin(&scheduler, platform_micros());
+    uint32_t current_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
 
-  // Enable debug logging temporarily
-  esp_log_level_set("RADIO_COMM", ESP_LOG_DEBUG);
+    // Input is handled on every pass; only rendering is skipped when over budget
+    SystemState incoming;
+    if (state_mailbox_take(&state_mailbox, &incoming)) {
+      if (!have_state) {
+        ESP_LOGI(TAG, "First packet %ld ms after boot", (long)(incoming.rx_time_us / 1000));
+      }
+      if (!have_state || incoming.sequence != state.sequence) {
+        clock_run_state_t run_state;
+        uint16_t packet_seconds = shown_clock_seconds(&incoming, &run_state);
+        clock_engine_on_packet(&clock, packet_seconds, run_state, incoming.rx_time_us);
+        trace_pending = true;
+      }
+      if (!have_state || incoming.r != state.r || incoming.g != state.g || incoming.b != state.b) {
+        redraw = true;
+      }
+      have_state = true;
+      state = incoming;
+    }
 
-  if (radio_receive_message(&nrf24_radio, &system_state)) {
-    // Set display mode based on system state
-    display_set_run_mode(&play_clock_display);
-    display_set_color(&play_clock_display, system_state.r, system_state.g, system_state.b);
-    display_set_time(&play_clock_display, system_state.seconds);
-    
-    ESP_LOGI(TAG, "Time update: seconds=%d, RGB(%d,%d,%d), seq=%d",
-             system_state.seconds, system_state.r, system_state.g, system_state.b, system_state.sequence);
-    // Update current_time after receiving message
+    // Digits follow the local countdown, which free-runs between packets
+    uint16_t seconds = clock_engine_seconds(&clock, platform_micros());
+    if (have_state && !lost_blank && seconds != shown_seconds) {
+      redraw = true;
+    }
+
+    // Queued events; new state was taken from the mailbox above, whatever
+    // follows a button action stays queued for the next pass
+    bool white_mode = false, button_test = false;
+    while (have_event) {
+      if (event.type == APP_EVENT_BUTTON_DOWN) {
+        ESP_LOGI(TAG, "Button press detected");
+        button_down_time = event.time_ms;
+      } else if (event.type == APP_EVENT_BUTTON_LONG) {
+        white_mode = true;
+        break;
+      } else if (event.type == APP_EVENT_BUTTON_UP && !event.long_press) {
+        button_test = true;
+        break;
+      }
+      have_event = app_events_wait(&event, 0);
+    }
+
+    // Button tests take over the display; the radio keeps receiving meanwhile
+    // and the newest state is drawn once they finish
+    if (white_mode) {
+      ESP_LOGI(TAG, "Button long hold detected - running white LED mode");
+      run_white_led_mode();
+      redraw = have_state;
+      frame_scheduler_resync(&scheduler, platform_micros());
+    }
+    if (button_test) {
+      if (button_down_time < SELF_TEST_WINDOW_MS) {
+        ESP_LOGI(TAG, "Test button pressed at boot - running display self-test");
+        run_self_tests();
+      } else {
+        ESP_LOGI(TAG, "Test button released - running number cycling test");
+        run_number_cycling_test();
+      }
+      redraw = have_state;
+      frame_scheduler_resync(&scheduler, platform_micros());
+    }
+
+    // Full CPU clock back before drawing
+    if (idle && redraw) {
+      power_idle_set(false);
+      idle = false;
+    }
+
+    // Skipped frames keep redraw set and catch up on the next pass
+    if (render && redraw) {
+      // Set display mode based on system state
+      display_set_run_mode(&play_clock_display);
+      display_set_color(&play_clock_display, state.r, state.g, state.b);
+      if (link_status == LINK_STATUS_LOST && seconds != 0) {
+        display_set_effect(&play_clock_display, LINK_LOST_EFFECT, LINK_LOST_EFFECT_PERIOD_MS);
+      } else {
+        display_set_effect(&play_clock_display, seconds == 0 ? ZERO_EFFECT : ANIM_EFFECT_NONE, ZERO_EFFECT_PERIOD_MS);
+      }
+      if (seconds == CLOCK_ENGINE_BLANK || lost_blank) {
+        display_set_blank(&play_clock_display);
+      } else {
+        display_set_time(&play_clock_display, seconds);
+      }
+      if (LINK_WARNING_INDICATOR != LINK_WARNING_NONE) {
+        display_set_indicator(&play_clock_display, LINK_WARNING_INDICATOR, link_status != LINK_STATUS_GOOD);
+      }
+      ESP_LOGD(TAG, "Time update: seconds=%d (packet %d), RGB(%d,%d,%d), seq=%d",
+               seconds, clock.packet_seconds, state.r, state.g, state.b, state.sequence);
+      shown_seconds = seconds;
+      if (trace_pending) {
+        latency_trace_mark(LATENCY_STAGE_RENDER);
+      }
+      redraw = false;
+    } else if (render && trace_pending) {
+      // Nothing visible changed, e.g. the local countdown already flipped
+      latency_trace_mark(LATENCY_STAGE_RENDER);
+      latency_trace_end();
+    }
+    if (render) {
+      trace_pending = false;
+    }
+
+    // Link status from the time since the last payload, against the timeout
+    // adapted to the controller's packet rate. The radio task stamps
+    // last_status_time concurrently, so it may be newer than current_time -
+    // compare as a signed age.
     current_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
-  }
+    int32_t status_age_ms = (int32_t)(current_time - state.last_status_time);
+    link_status_t new_link_status =
+        have_state ? link_quality_status(&state.link, status_age_ms > 0 ? (uint32_t)status_age_ms : 0)
+                   : LINK_STATUS_LOST;
+    if (new_link_status != link_status) {
+      if (new_link_status == LINK_STATUS_LOST) {
+        ESP_LOGW(TAG, "Link lost: no packets for %ld ms (timeout %lu ms)", (long)status_age_ms,
+                 (unsigned long)state.link.timeout_ms);
+        link_lost_time = current_time;
+      } else if (new_link_status == LINK_STATUS_DEGRADED) {
+        ESP_LOGW(TAG, "Link degraded: %u%% loss, last packet %ld ms ago (interval %lu ms)", state.link.loss_percent,
+                 (long)status_age_ms, (unsigned long)state.link.interval_ms);
+      } else {
+        ESP_LOGI(TAG, "Link %s", link_status == LINK_STATUS_LOST ? "restored" : "good again");
+      }
+      // Lost-link effect and warning indicator follow on the next frame
+      if (have_state) {
+        redraw = true;
+      }
+      link_status = new_link_status;
+    }
+    bool blank_for_loss = LINK_LOST_BLANK_MS > 0 && have_state && link_status == LINK_STATUS_LOST &&
+                          current_time - link_lost_time >= LINK_LOST_BLANK_MS;
+    if (blank_for_loss != lost_blank) {
+      ESP_LOGI(TAG, "%s", blank_for_loss ? "Link lost for too long - blanking the display" : "Display back on");
+      lost_blank = blank_for_loss;
+      redraw = true;
+    }
 
-  // Check for link timeout
-  if (current_time - system_state.last_status_time > LINK_TIMEOUT_MS) {
-    if (system_state.link_alive) {
-      ESP_LOGW(TAG, "Link timeout detected");
-      system_state.link_alive = false;
+    if (render) {
+      display_animate(&play_clock_display);
+      display_update(&play_clock_display);
     }
-  } else if (!system_state.link_alive && (current_time - system_state.last_status_time < LINK_TIMEOUT_MS)) {
-    // Link recovered
-    ESP_LOGI(TAG, "Link restored");
-    system_state.link_alive = true;
-  }
 
-  display_update(&play_clock_display);
+    // Idle once the dark frame is out and nothing is pending; a held button
+    // keeps the full clock for the test it is about to start
+    bool now_idle = render && !redraw && !app_events_button_held() && display_is_idle(&play_clock_display);
+    if (now_idle != idle) {
+      power_idle_set(now_idle);
+      idle = now_idle;
+    }
 
-  // Status LED based on link status
-  static bool led_state = false;
-  if (system_state.link_alive) {
-    // Slow blink when link is alive
-    if (current_time % 2000 < 1000) {
-      led_state = true;
+    // Status LED based on link status; its timer does the blinking
+    if (idle) {
+      status_led_set(STATUS_LED_IDLE);
+    } else if (link_status == LINK_STATUS_GOOD) {
+      status_led_set(STATUS_LED_LINK_GOOD);
+    } else if (link_status == LINK_STATUS_DEGRADED) {
+      status_led_set(STATUS_LED_LINK_DEGRADED);
     } else {
-      led_state = false;
+      status_led_set(STATUS_LED_LINK_LOST);
+    }
+
+    frame_scheduler_end(&scheduler, platform_micros());
+
+    portENTER_CRITICAL(&render_stats_lock);
+    render_stats.frames = scheduler.stats;
+    render_stats.clock = clock.stats;
+    render_stats.clock_running = clock.running;
+    render_stats.clock_rate = clock.rate;
+    render_stats.link_status = link_status;
+    portEXIT_CRITICAL(&render_stats_lock);
+  }
+}
+
+// Stats task - dumps the counters of every stage to the console every
+// STATS_INTERVAL_MS
+static void stats_task(void *arg) {
+  while (1) {
+    vTaskDelay(pdMS_TO_TICKS(STATS_INTERVAL_MS));
+
+    render_stats_t render;
+    portENTER_CRITICAL(&render_stats_lock);
+    render = render_stats;
+    portEXIT_CRITICAL(&render_stats_lock);
+
+    ESP_LOGI(TAG, "Debug: button_held=%d", app_events_button_held());
+    radio_sequence_stats_t rx_stats;
+    radio_get_sequence_stats(&rx_stats);
+    ESP_LOGI(TAG, "Radio: %lu received, %lu applied, %lu duplicate, %lu reordered, %lu gaps (%lu lost), %lu resyncs",
+             (unsigned long)rx_stats.received, (unsigned long)rx_stats.accepted, (unsigned long)rx_stats.duplicates,
+             (unsigned long)rx_stats.reorders, (unsigned long)rx_stats.gaps, (unsigned long)rx_stats.lost,
+             (unsigned long)rx_stats.resyncs);
+    link_quality_t quality;
+    radio_get_link_quality(&quality);
+    char jitter[96];
+    link_quality_format_jitter(&quality.stats, jitter, sizeof(jitter));
+    ESP_LOGI(TAG, "Link: %s, %u%% loss, %lu retransmits, interval %lu us, jitter %lu us, timeout %lu ms, jitter ms %s",
+             link_status_name(render.link_status), link_quality_loss_percent(&quality),
+             (unsigned long)quality.stats.retransmits, (unsigned long)quality.interval_us,
+             (unsigned long)quality.jitter_us, (unsigned long)link_quality_timeout_ms(&quality), jitter);
+    channel_hop_stats_t hop_stats;
+    radio_get_hop_stats(&hop_stats);
+    ESP_LOGI(TAG, "Channel: %lu hops, %lu announcements heard, %lu searches (%lu channels tried)",
+             (unsigned long)hop_stats.hops, (unsigned long)hop_stats.announcements,
+             (unsigned long)hop_stats.searches, (unsigned long)hop_stats.search_steps);
+    ESP_LOGI(TAG, "Clock: %s, rate %.4f, %lu boundaries, %lu corrections, %lu snaps, last error %ld ms",
+             render.clock_running ? "running" : "held", render.clock_rate, (unsigned long)render.clock.boundaries,
+             (unsigned long)render.clock.corrections, (unsigned long)render.clock.snaps,
+             (long)render.clock.last_error_ms);
+    ESP_LOGI(TAG, "Frames: %lu at %d Hz, %lu missed, %lu overruns, %lu skipped, work %lu us (max %lu)",
+             (unsigned long)render.frames.frames, RENDER_FRAME_RATE_HZ, (unsigned long)render.frames.missed,
+             (unsigned long)render.frames.overruns, (unsigned long)render.frames.skipped,
+             (unsigned long)render.frames.work_us, (unsigned long)render.frames.work_us_max);
+    power_limit_stats_t power;
+    display_get_power_stats(&play_clock_display, &power);
+    ESP_LOGI(TAG, "Power: %lu mA (requested %lu, peak %lu), limit %u/%d, %lu limited frames",
+             (unsigned long)power.estimate_ma, (unsigned long)power.requested_ma, (unsigned long)power.peak_ma,
+             power.limit, POWER_LIMIT_FULL, (unsigned long)power.limited_frames);
+    power_idle_stats_t idle_stats;
+    power_idle_get_stats(&idle_stats);
+    ESP_LOGI(TAG, "Idle: %s, %lu times, %lld ms in total", idle_stats.idle ? "yes" : "no",
+             (unsigned long)idle_stats.entries, (long long)(idle_stats.idle_us / 1000));
+    for (latency_stage_t stage = LATENCY_STAGE_PARSE; stage < LATENCY_STAGE_COUNT; stage++) {
+      latency_stage_stats_t latency;
+      latency_trace_get_stats(stage, &latency);
+      ESP_LOGI(TAG, "Latency rx->%s: n=%lu min %lu avg %lu p99 %lu max %lu us", latency_stage_name(stage),
+               (unsigned long)latency.count, (unsigned long)latency.min_us, (unsigned long)latency.avg_us,
+               (unsigned long)latency.p99_us, (unsigned long)latency.max_us);
     }
-  } else {
-    // Very fast blink when link is lost
-    led_state = (current_time % 200) < 100;
   }
-  gpio_set_level(STATUS_LED_PIN, led_state ? 1 : 0);
+}
 
-  vTaskDelay(pdMS_TO_TICKS(50));
+#if RUN_BENCHMARKS
+// The bit encoder behind the symbol cache, same symbols as the RMT bytes encoder
+static void bench_encode(const uint8_t *data, size_t size, const wire_map_t *map, uint32_t *symbols) {
+  const led_strip_encoder_config_t config = {.resolution = LED_TRANSPORT_RMT_RESOLUTION_HZ, .wire_map = map};
+  led_strip_encode_symbols(&config, data, size, (rmt_symbol_word_t *)symbols);
 }
 
+static void run_benchmarks(void) {
+  static bench_result_t results[BENCH_MAX_RESULTS];
+  ESP_LOGI(TAG, "Running benchmarks at %lu MHz", (unsigned long)platform_cycles_per_us());
+  size_t count = bench_run_all(bench_encode, results, BENCH_MAX_RESULTS);
+
+  printf("%s\n", BENCH_CSV_HEADER);
+  for (size_t i = 0; i < count; i++) {
+    char line[64];
+    bench_format(&results[i], line, sizeof(line));
+    printf("%s\n", line);
+  }
+}
+#endif
+
 void app_main(void) {
+#if RUN_BENCHMARKS
+  run_benchmarks();
+#endif
   setup();
 
-  while (1) {
-    loop();
+  if (xTaskCreatePinnedToCore(render_task, "render", RENDER_TASK_STACK_SIZE, NULL, RENDER_TASK_PRIORITY,
+                              NULL, RENDER_TASK_CORE) != pdPASS) {
+    ESP_LOGE(TAG, "Failed to create render task");
+    return;
+  }
+  if (xTaskCreatePinnedToCore(radio_task, "radio_rx", RADIO_TASK_STACK_SIZE, NULL, RADIO_TASK_PRIORITY, NULL,
+                              RADIO_TASK_CORE) != pdPASS) {
+    ESP_LOGE(TAG, "Failed to create radio task");
+  }
+  if (xTaskCreatePinnedToCore(stats_task, "stats", STATS_TASK_STACK_SIZE, NULL, STATS_TASK_PRIORITY, NULL,
+                              STATS_TASK_CORE) != pdPASS) {
+    ESP_LOGW(TAG, "Failed to create stats task - no diagnostics on the console");
   }
 }
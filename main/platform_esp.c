@@ -0,0 +1,171 @@
+#include "../include/platform.h"
+#include "driver/gpio.h"
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "nvs.h"
+
+static const char *TAG = "PLATFORM";
+
+static portMUX_TYPE critical_lock = portMUX_INITIALIZER_UNLOCKED;
+
+uint32_t platform_millis(void) {
+  return xTaskGetTickCount() * portTICK_PERIOD_MS;
+}
+
+IRAM_ATTR int64_t platform_micros(void) {
+  return esp_timer_get_time();
+}
+
+void platform_delay_ms(uint32_t ms) {
+  vTaskDelay(pdMS_TO_TICKS(ms));
+}
+
+void platform_delay_us(uint32_t us) {
+  esp_rom_delay_us(us);
+}
+
+uint32_t platform_cycles(void) {
+  return esp_cpu_get_cycle_count();
+}
+
+// Current clock, kept up to date by the clock driver when dynamic frequency
+// scaling (power_idle.h) switches it; ROM call, safe from an ISR
+uint32_t platform_cycles_per_us(void) {
+  return esp_rom_get_cpu_ticks_per_us();
+}
+
+platform_mutex_t platform_mutex_create(void) {
+  return (platform_mutex_t)xSemaphoreCreateMutex();
+}
+
+void platform_mutex_lock(platform_mutex_t mutex) {
+  xSemaphoreTake((SemaphoreHandle_t)mutex, portMAX_DELAY);
+}
+
+void platform_mutex_unlock(platform_mutex_t mutex) {
+  xSemaphoreGive((SemaphoreHandle_t)mutex);
+}
+
+platform_signal_t platform_signal_create(void) {
+  return (platform_signal_t)xSemaphoreCreateBinary();
+}
+
+PLATFORM_ISR_ATTR void platform_signal_give(platform_signal_t signal) {
+  if (!xPortInIsrContext()) {
+    xSemaphoreGive((SemaphoreHandle_t)signal);
+    return;
+  }
+
+  BaseType_t high_task_wakeup = pdFALSE;
+  xSemaphoreGiveFromISR((SemaphoreHandle_t)signal, &high_task_wakeup);
+  portYIELD_FROM_ISR(high_task_wakeup);
+}
+
+bool platform_signal_take(platform_signal_t signal, uint32_t timeout_ms) {
+  return xSemaphoreTake((SemaphoreHandle_t)signal, pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
+}
+
+PLATFORM_ISR_ATTR void platform_critical_enter(void) {
+  portENTER_CRITICAL_SAFE(&critical_lock);
+}
+
+PLATFORM_ISR_ATTR void platform_critical_exit(void) {
+  portEXIT_CRITICAL_SAFE(&critical_lock);
+}
+
+void *platform_malloc_internal(size_t size) {
+  return heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+}
+
+bool platform_storage_load(const char *space, const char *key, void *data, size_t *size) {
+  nvs_handle_t handle;
+  if (nvs_open(space, NVS_READONLY, &handle) != ESP_OK)
+    return false; // Namespace not written yet
+
+  esp_err_t err = nvs_get_blob(handle, key, data, size);
+  nvs_close(handle);
+  if (err != ESP_OK && err != ESP_ERR_NVS_NOT_FOUND) {
+    ESP_LOGW(TAG, "Failed to read %s/%s: %s", space, key, esp_err_to_name(err));
+  }
+  return err == ESP_OK;
+}
+
+bool platform_storage_store(const char *space, const char *key, const void *data, size_t size) {
+  nvs_handle_t handle;
+  esp_err_t err = nvs_open(space, NVS_READWRITE, &handle);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to open %s storage: %s", space, esp_err_to_name(err));
+    return false;
+  }
+
+  if (data != NULL) {
+    err = nvs_set_blob(handle, key, data, size);
+  } else {
+    err = nvs_erase_key(handle, key);
+    if (err == ESP_ERR_NVS_NOT_FOUND)
+      err = ESP_OK;
+  }
+  if (err == ESP_OK)
+    err = nvs_commit(handle);
+  nvs_close(handle);
+
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to store %s/%s: %s", space, key, esp_err_to_name(err));
+    return false;
+  }
+  return true;
+}
+
+void platform_gpio_config(int pin, platform_gpio_mode_t mode) {
+  gpio_reset_pin(pin);
+  if (mode == PLATFORM_GPIO_OUTPUT) {
+    gpio_set_direction(pin, GPIO_MODE_OUTPUT);
+  } else {
+    gpio_set_direction(pin, GPIO_MODE_INPUT);
+    gpio_set_pull_mode(pin, GPIO_PULLUP_ONLY);
+  }
+}
+
+PLATFORM_ISR_ATTR void platform_gpio_set(int pin, int level) {
+  gpio_set_level(pin, level);
+}
+
+int platform_gpio_get(int pin) {
+  return gpio_get_level(pin);
+}
+
+bool platform_gpio_irq(int pin, platform_isr_t handler, void *arg) {
+  gpio_config_t irq_config = {
+    .pin_bit_mask = 1ULL << pin,
+    .mode = GPIO_MODE_INPUT,
+    .pull_up_en = GPIO_PULLUP_ENABLE, // Open-drain style, active low
+    .pull_down_en = GPIO_PULLDOWN_DISABLE,
+    .intr_type = GPIO_INTR_NEGEDGE,
+  };
+  esp_err_t result = gpio_config(&irq_config);
+  if (result != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to configure IRQ pin %d: %s", pin, esp_err_to_name(result));
+    return false;
+  }
+
+  // The service may already be installed by another driver
+  result = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+  if (result != ESP_OK && result != ESP_ERR_INVALID_STATE) {
+    ESP_LOGE(TAG, "Failed to install GPIO ISR service: %s", esp_err_to_name(result));
+    return false;
+  }
+
+  result = gpio_isr_handler_add(pin, handler, arg);
+  if (result != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to add IRQ handler on GPIO %d: %s", pin, esp_err_to_name(result));
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,63 @@
+#include "../include/power_idle.h"
+#include "../include/platform.h"
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "sdkconfig.h"
+
+static const char *TAG = "POWER_IDLE";
+
+static esp_pm_lock_handle_t cpu_lock = NULL;
+static power_idle_stats_t stats;
+static int64_t idle_since_us = 0;
+
+bool power_idle_init(void) {
+  stats.idle = false;
+
+  esp_pm_config_t config = {
+    .max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+    .min_freq_mhz = POWER_IDLE_MIN_CPU_MHZ,
+    .light_sleep_enable = false, // The RMT channel keeps the APB clock; GPIO wakeups stay plain interrupts
+  };
+  esp_err_t result = esp_pm_configure(&config);
+  if (result != ESP_OK) {
+    ESP_LOGW(TAG, "Power management unavailable (%s) - CPU stays at %d MHz", esp_err_to_name(result),
+             CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ);
+    return false;
+  }
+
+  result = esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "render", &cpu_lock);
+  if (result != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to create CPU frequency lock: %s", esp_err_to_name(result));
+    return false;
+  }
+  esp_pm_lock_acquire(cpu_lock);
+  ESP_LOGI(TAG, "CPU %d MHz, %d MHz when idle", CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ, POWER_IDLE_MIN_CPU_MHZ);
+  return true;
+}
+
+void power_idle_set(bool idle) {
+  if (idle == stats.idle)
+    return;
+
+  int64_t now_us = platform_micros();
+  if (idle) {
+    if (cpu_lock != NULL) {
+      esp_pm_lock_release(cpu_lock);
+    }
+    idle_since_us = now_us;
+    stats.entries++;
+  } else {
+    if (cpu_lock != NULL) {
+      esp_pm_lock_acquire(cpu_lock);
+    }
+    stats.idle_us += now_us - idle_since_us;
+  }
+  stats.idle = idle;
+  ESP_LOGD(TAG, "%s", idle ? "Idle" : "Active");
+}
+
+void power_idle_get_stats(power_idle_stats_t *out) {
+  if (out) {
+    *out = stats;
+  }
+}
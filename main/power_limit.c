@@ -0,0 +1,49 @@
+#include "../include/power_limit.h"
+#include <string.h>
+
+void power_limit_init(power_limit_t *power, uint32_t budget_ma, uint32_t channel_ua, uint32_t idle_ma,
+                      uint16_t release_step) {
+  memset(power, 0, sizeof(*power));
+  power->budget_ma = budget_ma;
+  power->channel_ua = channel_ua;
+  power->idle_ma = idle_ma;
+  power->release_step = release_step > 0 ? release_step : 1;
+  power->limit = POWER_LIMIT_FULL;
+}
+
+// Draw of the lit LEDs alone, in mA
+static uint32_t dynamic_ma(const power_limit_t *power, uint32_t channel_sum, uint16_t limit) {
+  return (uint32_t)((uint64_t)channel_sum * power->channel_ua * limit / (255ULL * 1000 * POWER_LIMIT_FULL));
+}
+
+uint32_t power_limit_draw_ma(const power_limit_t *power, uint32_t channel_sum, uint16_t limit) {
+  return power->idle_ma + dynamic_ma(power, channel_sum, limit);
+}
+
+uint16_t power_limit_update(power_limit_t *power, uint32_t channel_sum) {
+  uint32_t requested = dynamic_ma(power, channel_sum, POWER_LIMIT_FULL);
+  uint32_t available = power->budget_ma > power->idle_ma ? power->budget_ma - power->idle_ma : 0;
+
+  // Largest scale that fits the budget; rounded down so the result stays inside it
+  uint16_t target = POWER_LIMIT_FULL;
+  if (requested > available) {
+    target = (uint16_t)((uint64_t)available * POWER_LIMIT_FULL / requested);
+  }
+
+  // Cut at once, recover in steps
+  if (target < power->limit) {
+    power->limit = target;
+  } else if (power->limit < target) {
+    uint32_t raised = power->limit + power->release_step;
+    power->limit = raised < target ? raised : target;
+  }
+
+  power->stats.requested_ma = power->idle_ma + requested;
+  power->stats.estimate_ma = power_limit_draw_ma(power, channel_sum, power->limit);
+  if (power->stats.estimate_ma > power->stats.peak_ma)
+    power->stats.peak_ma = power->stats.estimate_ma;
+  if (power->limit < POWER_LIMIT_FULL)
+    power->stats.limited_frames++;
+  power->stats.limit = power->limit;
+  return power->limit;
+}
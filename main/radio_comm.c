@@ -1,13 +1,56 @@
 #include "../include/radio_comm.h"
+#include "../include/latency_trace.h"
+#include "../include/platform.h"
+#include "../include/radio_protocol.h"
 #include "esp_log.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
 #include <string.h>
-#include "driver/spi_master.h"
-#include "driver/gpio.h"
 
 static const char *TAG = "RADIO_COMM";
 
+// IRQ wakeup: the ISR signals the task blocked in radio_wait_for_message()
+static gpio_num_t irq_pin = GPIO_NUM_NC;
+static platform_signal_t irq_signal = NULL;
+static volatile int64_t irq_time_us = 0; // Last falling edge, arrival time of the payloads it announced
+
+// RX_P_NO in STATUS reads 111 while the RX FIFO is empty
+#define NRF24_STATUS_RX_P_NO_MASK 0x0E
+#define RADIO_RX_FIFO_DEPTH 3
+
+// Sequence tracking across received messages, reset per listening session
+static radio_sequence_t rx_sequence;
+static link_quality_t link_quality;
+
+// Received power detector: bit 0 set when the channel carried more than -64 dBm
+// for 40 us after the receiver settled (130 us)
+#ifndef NRF24_REG_RPD
+#define NRF24_REG_RPD 0x09
+#endif
+#define RADIO_RPD_SETTLE_US 170
+
+// Channel following, owned by the task in radio_wait_for_message()
+static bool hopping = false;
+static channel_hop_rx_t hop;
+static channel_survey_t hop_survey;
+
+static inline bool rx_fifo_empty(uint8_t status) {
+  return (status & NRF24_STATUS_RX_P_NO_MASK) == NRF24_STATUS_RX_P_NO_MASK;
+}
+
+// 64-bit store isn't atomic - reread until the ISR didn't interleave
+static int64_t irq_timestamp(void) {
+  int64_t stamp;
+  do {
+    stamp = irq_time_us;
+  } while (stamp != irq_time_us);
+  return stamp;
+}
+
+static PLATFORM_ISR_ATTR void radio_irq_isr(void *arg) {
+  (void)arg;
+  irq_time_us = platform_micros();
+  platform_signal_give(irq_signal);
+}
+
 bool radio_begin(RadioComm *radio, gpio_num_t ce, gpio_num_t csn) {
   ESP_LOGI(TAG, "Initializing nRF24L01+ radio using radio_common");
 
@@ -27,44 +70,217 @@ bool radio_begin(RadioComm *radio, gpio_num_t ce, gpio_num_t csn) {
   return true;
 }
 
-
-
-bool radio_receive_message(RadioComm *radio, SystemState *state) {
+// Drain the RX FIFO; rx_us is when the payloads arrived (IRQ edge or poll)
+static bool receive_messages(RadioComm *radio, SystemState *state, int64_t rx_us) {
   if (!radio->initialized) {
     ESP_LOGE(TAG, "Radio not initialized");
     return false;
   }
 
+  // Single SPI transaction when nothing is pending
   uint8_t status = nrf24_get_status(radio);
-  ESP_LOGD(TAG, "Radio status: 0x%02X", status);
-  
-  // Check if RX FIFO has data (even if RX_DR flag isn't set)
-  uint8_t fifo_status = nrf24_read_register(radio, NRF24_REG_FIFO_STATUS);
-  bool rx_fifo_empty = (fifo_status & 0x01) != 0;
-  ESP_LOGD(TAG, "FIFO status: 0x%02X, RX empty: %s", fifo_status, rx_fifo_empty ? "yes" : "no");
-  
-  if (status & NRF24_STATUS_RX_DR) {
+  ESP_LOGV(TAG, "Radio status: 0x%02X", status);
+  if (!(status & NRF24_STATUS_RX_DR) && rx_fifo_empty(status)) {
+    return false;
+  }
+
+  // Clear RX_DR before draining - a payload landing mid-drain raises it (and
+  // the IRQ line) again, so nothing is left behind in the FIFO
+  nrf24_write_register(radio, NRF24_REG_STATUS, NRF24_STATUS_RX_DR);
+
+  radio_message_t batch[RADIO_RX_FIFO_DEPTH];
+  size_t count = 0;
+  while (!rx_fifo_empty(status) && count < RADIO_RX_FIFO_DEPTH) {
     uint8_t payload[RADIO_PAYLOAD_SIZE];
     nrf24_read_payload(radio, payload, RADIO_PAYLOAD_SIZE);
-    
-    // Clear RX_DR flag
-    nrf24_write_register(radio, NRF24_REG_STATUS, NRF24_STATUS_RX_DR);
-    
-    // Parse payload (format: seconds(2), r(1), g(1), b(1), sequence(1))
-    state->seconds = (payload[0] << 8) | payload[1];
-    state->r = payload[2];
-    state->g = payload[3];
-    state->b = payload[4];
-    state->sequence = payload[5];
-    state->last_status_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
-    state->link_alive = true;
-    
-    ESP_LOGI(TAG, "Message received: seconds=%d, RGB(%d,%d,%d), seq=%d",
-             state->seconds, state->r, state->g, state->b, state->sequence);
+    if (radio_protocol_parse(payload, RADIO_PAYLOAD_SIZE, &batch[count])) {
+      count++;
+    } else {
+      ESP_LOGW(TAG, "Dropping malformed payload");
+    }
+    status = nrf24_get_status(radio);
+  }
+  if (count == 0) {
+    return false;
+  }
+
+  // Hop announcements are followed from any frame, even a duplicate
+  if (hopping) {
+    for (size_t i = 0; i < count; i++) {
+      channel_hop_rx_on_message(&hop, &batch[i], rx_us);
+    }
+  }
+
+  // Any valid payload shows the link is up, even a duplicate
+  state->last_status_time = platform_millis();
+
+  // Only the newest message is applied; stale and repeated ones are counted
+  int newest = radio_sequence_process(&rx_sequence, batch, count);
+  link_quality_on_batch(&link_quality, &rx_sequence.stats, rx_us);
+  link_quality_summarize(&link_quality, &state->link);
+  if (newest < 0) {
+    ESP_LOGD(TAG, "Drained %d stale payload(s)", (int)count);
+    return false;
+  }
+
+  const radio_message_t *message = &batch[newest];
+  latency_trace_begin(message->sequence, rx_us);
+  latency_trace_mark(LATENCY_STAGE_PARSE);
+
+  system_state_apply(state, message);
+  state->rx_time_us = rx_us;
+
+  ESP_LOGD(TAG, "Message received: v%d seconds=%d, RGB(%d,%d,%d), seq=%d, fields 0x%04X (%d drained)",
+           message->version, state->seconds, state->r, state->g, state->b, state->sequence, message->fields,
+           (int)count);
+  return true;
+}
+
+bool radio_receive_message(RadioComm *radio, SystemState *state) {
+  return receive_messages(radio, state, platform_micros());
+}
+
+void radio_get_sequence_stats(radio_sequence_stats_t *stats) {
+  if (stats) {
+    *stats = rx_sequence.stats;
+  }
+}
+
+void radio_get_link_quality(link_quality_t *quality) {
+  if (quality) {
+    *quality = link_quality;
+  }
+}
+
+uint8_t radio_get_channel(RadioComm *radio) {
+  return nrf24_read_register(radio, NRF24_REG_RF_CH);
+}
+
+void radio_set_channel(RadioComm *radio, uint8_t channel) {
+  if (!radio->initialized || channel >= CHANNEL_SURVEY_CHANNELS)
+    return;
+
+  // RF_CH only takes effect through standby
+  platform_gpio_set(radio->ce_pin, 0);
+  nrf24_write_register(radio, NRF24_REG_RF_CH, channel);
+  platform_gpio_set(radio->ce_pin, 1);
+  ESP_LOGD(TAG, "Listening on channel %d", channel);
+}
+
+bool radio_survey(RadioComm *radio, channel_survey_t *survey, int sweeps) {
+  if (!radio->initialized)
+    return false;
+
+  uint8_t tuned = radio_get_channel(radio);
+  int64_t start_us = platform_micros();
+  for (int sweep = 0; sweep < sweeps; sweep++) {
+    for (uint8_t channel = 0; channel < CHANNEL_SURVEY_CHANNELS; channel++) {
+      platform_gpio_set(radio->ce_pin, 0);
+      nrf24_write_register(radio, NRF24_REG_RF_CH, channel);
+      platform_gpio_set(radio->ce_pin, 1);
+      platform_delay_us(RADIO_RPD_SETTLE_US);
+      channel_survey_add(survey, channel, (nrf24_read_register(radio, NRF24_REG_RPD) & 0x01) != 0);
+    }
+    survey->sweeps++;
+  }
+  platform_gpio_set(radio->ce_pin, 0);
+  nrf24_write_register(radio, NRF24_REG_RF_CH, tuned);
+  platform_gpio_set(radio->ce_pin, 1);
+
+  char map[CHANNEL_SURVEY_CHANNELS + 1];
+  channel_survey_format(survey, map);
+  ESP_LOGI(TAG, "Channel survey (%d sweeps, %ld ms): %s", sweeps, (long)((platform_micros() - start_us) / 1000),
+           map);
+  return true;
+}
+
+void radio_enable_hopping(RadioComm *radio, const uint8_t *channels, uint8_t count) {
+  if (!radio->initialized || count == 0)
+    return;
+
+  channel_survey_reset(&hop_survey);
+  channel_hop_rx_init(&hop, channels, count, radio_get_channel(radio), platform_micros());
+  hopping = true;
+  ESP_LOGI(TAG, "Channel hopping over %d channels, on channel %d", count, hop.channel);
+}
+
+void radio_get_hop_stats(channel_hop_stats_t *stats) {
+  if (stats) {
+    *stats = hop.stats;
+  }
+}
+
+// Retune for announced moves and search steps; returns how long the caller
+// may wait before the channel needs looking at again
+static uint32_t follow_hops(RadioComm *radio, uint32_t timeout_ms) {
+  int64_t next_us;
+  uint8_t tuned = hop.channel;
+  uint8_t channel = channel_hop_rx_poll(&hop, platform_micros(), &next_us);
+  if (hop.survey_due) {
+    // The controller went quiet - rank the hop set by what is busy here
+    radio_survey(radio, &hop_survey, RADIO_SURVEY_SWEEPS);
+    channel_hop_rx_rank(&hop, &hop_survey);
+    channel = channel_hop_rx_poll(&hop, platform_micros(), &next_us);
+  }
+  if (channel != tuned) {
+    radio_set_channel(radio, channel);
+  }
+
+  int64_t wait_us = next_us - platform_micros();
+  if (wait_us < 0)
+    wait_us = 0;
+  return wait_us / 1000 + 1 < timeout_ms ? (uint32_t)(wait_us / 1000 + 1) : timeout_ms;
+}
+
+bool radio_enable_irq(RadioComm *radio, gpio_num_t pin) {
+  if (!radio->initialized || pin == GPIO_NUM_NC)
+    return false;
+
+  if (irq_signal == NULL) {
+    irq_signal = platform_signal_create();
+    if (irq_signal == NULL) {
+      ESP_LOGE(TAG, "Failed to create IRQ signal");
+      return false;
+    }
+  }
+
+  // The IRQ output is open-drain style, active low
+  if (!platform_gpio_irq(pin, radio_irq_isr, NULL)) {
+    ESP_LOGE(TAG, "Failed to enable IRQ on GPIO %d", pin);
+    return false;
+  }
+
+  irq_pin = pin;
+  ESP_LOGI(TAG, "Radio IRQ enabled on GPIO %d", pin);
+  return true;
+}
+
+bool radio_wait_for_message(RadioComm *radio, SystemState *state, uint32_t timeout_ms) {
+  if (!radio->initialized)
+    return false;
+
+  if (hopping) {
+    timeout_ms = follow_hops(radio, timeout_ms);
+  }
+
+  if (irq_pin == GPIO_NUM_NC) {
+    // No IRQ line - poll the status register
+    uint32_t start = platform_millis();
+    while (!radio_receive_message(radio, state)) {
+      if (platform_millis() - start >= timeout_ms)
+        return false;
+      platform_delay_ms(RADIO_POLL_INTERVAL_MS);
+    }
     return true;
   }
 
-  return false;
+  // IRQ stays low while RX_DR is set, which also covers an edge whose signal
+  // was consumed by an earlier wait
+  if (platform_gpio_get(irq_pin) != 0 && !platform_signal_take(irq_signal, timeout_ms)) {
+    return false;
+  }
+  int64_t rx_us = irq_timestamp();
+  return receive_messages(radio, state, rx_us != 0 ? rx_us : platform_micros());
 }
 
 void radio_start_listening(RadioComm *radio) {
@@ -72,18 +288,20 @@ void radio_start_listening(RadioComm *radio) {
     return;
 
   // Ensure we're in RX mode
-  gpio_set_level(radio->ce_pin, 0);
+  platform_gpio_set(radio->ce_pin, 0);
   nrf24_write_register(radio, NRF24_REG_CONFIG, RADIO_CONFIG_RX_MODE);
-  vTaskDelay(pdMS_TO_TICKS(2)); // Small delay to ensure mode switch
+  platform_delay_ms(2); // Small delay to ensure mode switch
   
   // Clear any pending RX flags
   nrf24_write_register(radio, NRF24_REG_STATUS, RADIO_STATUS_CLEAR_ALL);
   
   // Flush RX FIFO to start fresh
   nrf24_flush_rx(radio);
+  radio_sequence_reset(&rx_sequence);
+  link_quality_init(&link_quality);
   
   // Start listening
-  gpio_set_level(radio->ce_pin, 1);
+  platform_gpio_set(radio->ce_pin, 1);
   
   // Log current configuration for debugging
   uint8_t config = nrf24_read_register(radio, NRF24_REG_CONFIG);
@@ -101,7 +319,7 @@ void radio_stop_listening(RadioComm *radio) {
   if (!radio->initialized)
     return;
 
-  gpio_set_level(radio->ce_pin, 0);
+  platform_gpio_set(radio->ce_pin, 0);
   ESP_LOGI(TAG, "Stopping radio listening");
 }
 
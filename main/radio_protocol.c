@@ -0,0 +1,257 @@
+#include "../include/radio_protocol.h"
+#include <string.h>
+
+static uint16_t read_u16(const uint8_t *bytes) {
+  return (bytes[0] << 8) | bytes[1];
+}
+
+// Displayed seconds of a countdown: a started second still shows
+static uint16_t clock_seconds(const radio_clock_t *clock) {
+  if (clock->flags & RADIO_CLOCK_BLANK)
+    return RADIO_PROTOCOL_BLANK_SECONDS;
+  uint16_t seconds = (clock->tenths + 9) / 10;
+  return seconds < RADIO_PROTOCOL_BLANK_SECONDS ? seconds : RADIO_PROTOCOL_BLANK_SECONDS - 1;
+}
+
+static bool parse_legacy(const uint8_t *payload, size_t length, radio_message_t *message) {
+  if (length < RADIO_PROTOCOL_LEGACY_SIZE)
+    return false;
+
+  // Format: seconds(2), r(1), g(1), b(1), sequence(1)
+  message->seconds = read_u16(&payload[0]);
+  message->r = payload[2];
+  message->g = payload[3];
+  message->b = payload[4];
+  message->sequence = payload[5];
+  message->fields = RADIO_FIELD(RADIO_RECORD_PLAY_CLOCK) | RADIO_FIELD(RADIO_RECORD_COLOR);
+  if (message->seconds == RADIO_PROTOCOL_BLANK_SECONDS) {
+    message->play_clock.flags = RADIO_CLOCK_BLANK;
+  } else {
+    message->play_clock.tenths = message->seconds < 6553 ? message->seconds * 10 : UINT16_MAX;
+  }
+  return true;
+}
+
+// False when a known record is too short; longer records are fine (fields
+// appended by newer versions)
+static bool parse_record(radio_message_t *message, uint8_t type, const uint8_t *value, uint8_t length) {
+  radio_clock_t *clock = NULL;
+  switch (type) {
+  case RADIO_RECORD_PLAY_CLOCK:
+    clock = &message->play_clock;
+    break;
+  case RADIO_RECORD_GAME_CLOCK:
+    clock = &message->game_clock;
+    break;
+  case RADIO_RECORD_SHOT_CLOCK:
+    clock = &message->shot_clock;
+    break;
+  case RADIO_RECORD_COLOR:
+    if (length < 3)
+      return false;
+    message->r = value[0];
+    message->g = value[1];
+    message->b = value[2];
+    break;
+  case RADIO_RECORD_PERIOD:
+    if (length < 1)
+      return false;
+    message->period = value[0];
+    break;
+  case RADIO_RECORD_COMMAND:
+    if (length < 2)
+      return false;
+    message->command_clock = value[0];
+    message->command = value[1];
+    break;
+  case RADIO_RECORD_HOP:
+    if (length < 2)
+      return false;
+    message->hop_channel = value[0];
+    message->hop_delay_ms = value[1] * RADIO_HOP_DELAY_UNIT_MS;
+    break;
+  default:
+    return true; // Unknown - skipped
+  }
+
+  if (clock != NULL) {
+    if (length < 3)
+      return false;
+    clock->tenths = read_u16(value);
+    clock->flags = value[2];
+  }
+  message->fields |= RADIO_FIELD(type);
+  return true;
+}
+
+bool radio_protocol_parse(const uint8_t *payload, size_t length, radio_message_t *message) {
+  if (!payload || !message || length == 0)
+    return false;
+
+  memset(message, 0, sizeof(*message));
+  message->seconds = RADIO_PROTOCOL_BLANK_SECONDS;
+  if ((payload[0] & 0xF0) != RADIO_PROTOCOL_MAGIC)
+    return parse_legacy(payload, length, message);
+
+  message->version = payload[0] & 0x0F;
+  if (message->version != RADIO_PROTOCOL_VERSION || length < RADIO_PROTOCOL_HEADER_SIZE)
+    return false;
+  message->sequence = payload[1];
+
+  if (length > RADIO_PROTOCOL_MAX_FRAME)
+    length = RADIO_PROTOCOL_MAX_FRAME;
+  size_t position = RADIO_PROTOCOL_HEADER_SIZE;
+  while (position < length && payload[position] != RADIO_RECORD_PAD) {
+    if (position + 2 > length)
+      return false;
+    uint8_t type = payload[position];
+    uint8_t record_length = payload[position + 1];
+    if (position + 2 + record_length > length)
+      return false;
+    if (!parse_record(message, type, &payload[position + 2], record_length))
+      return false;
+    position += 2 + record_length;
+  }
+
+  if (message->fields & RADIO_FIELD(RADIO_RECORD_PLAY_CLOCK)) {
+    message->seconds = clock_seconds(&message->play_clock);
+  }
+  return true;
+}
+
+static uint8_t *put_record(uint8_t *out, const uint8_t *end, uint8_t type, uint8_t length) {
+  if (out == NULL || end - out < 2 + length)
+    return NULL;
+  out[0] = type;
+  out[1] = length;
+  return out + 2;
+}
+
+static uint8_t *put_clock(uint8_t *out, const uint8_t *end, uint8_t type, const radio_clock_t *clock) {
+  uint8_t *value = put_record(out, end, type, 3);
+  if (value == NULL)
+    return NULL;
+  value[0] = clock->tenths >> 8;
+  value[1] = clock->tenths & 0xFF;
+  value[2] = clock->flags;
+  return value + 3;
+}
+
+size_t radio_protocol_encode(const radio_message_t *message, uint8_t *payload, size_t size) {
+  if (!message || !payload || size < RADIO_PROTOCOL_HEADER_SIZE)
+    return 0;
+
+  const uint8_t *end = payload + (size < RADIO_PROTOCOL_MAX_FRAME ? size : RADIO_PROTOCOL_MAX_FRAME);
+  payload[0] = RADIO_PROTOCOL_MAGIC | RADIO_PROTOCOL_VERSION;
+  payload[1] = message->sequence;
+  uint8_t *out = payload + RADIO_PROTOCOL_HEADER_SIZE;
+
+  if (message->fields & RADIO_FIELD(RADIO_RECORD_PLAY_CLOCK))
+    out = put_clock(out, end, RADIO_RECORD_PLAY_CLOCK, &message->play_clock);
+  if (message->fields & RADIO_FIELD(RADIO_RECORD_GAME_CLOCK))
+    out = put_clock(out, end, RADIO_RECORD_GAME_CLOCK, &message->game_clock);
+  if (message->fields & RADIO_FIELD(RADIO_RECORD_SHOT_CLOCK))
+    out = put_clock(out, end, RADIO_RECORD_SHOT_CLOCK, &message->shot_clock);
+  if (message->fields & RADIO_FIELD(RADIO_RECORD_COLOR)) {
+    uint8_t *value = put_record(out, end, RADIO_RECORD_COLOR, 3);
+    if (value != NULL) {
+      value[0] = message->r;
+      value[1] = message->g;
+      value[2] = message->b;
+    }
+    out = value != NULL ? value + 3 : NULL;
+  }
+  if (message->fields & RADIO_FIELD(RADIO_RECORD_PERIOD)) {
+    uint8_t *value = put_record(out, end, RADIO_RECORD_PERIOD, 1);
+    if (value != NULL) {
+      value[0] = message->period;
+    }
+    out = value != NULL ? value + 1 : NULL;
+  }
+  if (message->fields & RADIO_FIELD(RADIO_RECORD_COMMAND)) {
+    uint8_t *value = put_record(out, end, RADIO_RECORD_COMMAND, 2);
+    if (value != NULL) {
+      value[0] = message->command_clock;
+      value[1] = message->command;
+    }
+    out = value != NULL ? value + 2 : NULL;
+  }
+  if (message->fields & RADIO_FIELD(RADIO_RECORD_HOP)) {
+    uint8_t *value = put_record(out, end, RADIO_RECORD_HOP, 2);
+    if (value != NULL) {
+      uint16_t units = message->hop_delay_ms / RADIO_HOP_DELAY_UNIT_MS;
+      value[0] = message->hop_channel;
+      value[1] = units < UINT8_MAX ? units : UINT8_MAX;
+    }
+    out = value != NULL ? value + 2 : NULL;
+  }
+
+  return out != NULL ? (size_t)(out - payload) : 0;
+}
+
+// Signed distance from one sequence number to another across the wrap
+static inline int sequence_delta(uint8_t from, uint8_t to) {
+  return (int8_t)(uint8_t)(to - from);
+}
+
+void radio_sequence_reset(radio_sequence_t *sequence) {
+  memset(sequence, 0, sizeof(*sequence));
+}
+
+int radio_sequence_process(radio_sequence_t *sequence, const radio_message_t *messages, size_t count) {
+  if (count == 0)
+    return -1;
+
+  // Sort relative to the current state (or the first message) - a batch is at
+  // most a few entries deep, insertion sort it. Every message that has to move
+  // arrived out of order.
+  uint8_t reference = sequence->have_last ? sequence->last_sequence : messages[0].sequence;
+  uint8_t order[RADIO_SEQUENCE_MAX_BATCH];
+  if (count > RADIO_SEQUENCE_MAX_BATCH)
+    count = RADIO_SEQUENCE_MAX_BATCH;
+
+  for (size_t i = 0; i < count; i++) {
+    int delta = sequence_delta(reference, messages[i].sequence);
+    size_t j = i;
+    while (j > 0 && sequence_delta(reference, messages[order[j - 1]].sequence) > delta) {
+      order[j] = order[j - 1];
+      j--;
+    }
+    if (j != i) {
+      sequence->stats.reorders++;
+    }
+    order[j] = i;
+  }
+
+  int newest = -1;
+  for (size_t i = 0; i < count; i++) {
+    const radio_message_t *message = &messages[order[i]];
+    sequence->stats.received++;
+
+    if (sequence->have_last) {
+      int delta = sequence_delta(sequence->last_sequence, message->sequence);
+      if (delta == 0) {
+        sequence->stats.duplicates++;
+        continue;
+      }
+      if (delta < 0 && ++sequence->stale_run < RADIO_SEQUENCE_RESYNC_FRAMES) {
+        sequence->stats.reorders++;
+        continue;
+      }
+
+      if (delta < 0) {
+        sequence->stats.resyncs++;
+      } else if (delta > 1) {
+        sequence->stats.gaps++;
+        sequence->stats.lost += delta - 1;
+      }
+    }
+
+    sequence->have_last = true;
+    sequence->last_sequence = message->sequence;
+    sequence->stale_run = 0;
+    sequence->stats.accepted++;
+    newest = order[i];
+  }
+  return newest;
+}
@@ -0,0 +1,32 @@
+#include "../include/state_mailbox.h"
+
+#define STATE_MAILBOX_FRESH 0x80
+
+void state_mailbox_init(state_mailbox_t *mailbox, const SystemState *initial) {
+  for (int i = 0; i < 3; i++) {
+    mailbox->slots[i] = *initial;
+  }
+  mailbox->write_slot = 0;
+  mailbox->read_slot = 2;
+  atomic_init(&mailbox->shared, 1);
+}
+
+void state_mailbox_publish(state_mailbox_t *mailbox, const SystemState *state) {
+  mailbox->slots[mailbox->write_slot] = *state;
+
+  // Swap the filled slot in; release makes its contents visible to the consumer
+  uint8_t previous = atomic_exchange_explicit(&mailbox->shared, mailbox->write_slot | STATE_MAILBOX_FRESH,
+                                              memory_order_acq_rel);
+  mailbox->write_slot = previous & ~STATE_MAILBOX_FRESH;
+}
+
+bool state_mailbox_take(state_mailbox_t *mailbox, SystemState *state) {
+  if (!(atomic_load_explicit(&mailbox->shared, memory_order_relaxed) & STATE_MAILBOX_FRESH))
+    return false;
+
+  // Hand back the slot just read and pick up the newest one
+  uint8_t previous = atomic_exchange_explicit(&mailbox->shared, mailbox->read_slot, memory_order_acq_rel);
+  mailbox->read_slot = previous & ~STATE_MAILBOX_FRESH;
+  *state = mailbox->slots[mailbox->read_slot];
+  return true;
+}
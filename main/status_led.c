@@ -0,0 +1,96 @@
+#include "../include/status_led.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+static const char *TAG = "STATUS_LED";
+
+typedef struct {
+  uint16_t on_ms;  // 0 = steady off
+  uint16_t off_ms; // 0 = steady on
+} blink_t;
+
+static const blink_t patterns[STATUS_LED_PATTERN_COUNT] = {
+  [STATUS_LED_OFF] = {0, 1},
+  [STATUS_LED_ON] = {1, 0},
+  [STATUS_LED_LINK_GOOD] = {1000, 1000},
+  [STATUS_LED_LINK_DEGRADED] = {300, 300},
+  [STATUS_LED_LINK_LOST] = {100, 100},
+  [STATUS_LED_IDLE] = {50, 1950},
+  [STATUS_LED_FAULT_DISPLAY] = {100, 100},
+  [STATUS_LED_FAULT_RADIO] = {250, 250},
+};
+
+static gpio_num_t led_pin = GPIO_NUM_NC;
+static esp_timer_handle_t step_timer = NULL;
+static portMUX_TYPE led_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Shared between status_led_set() and the timer callback, under led_lock
+static status_led_pattern_t current = STATUS_LED_OFF;
+static bool lit = false;
+
+static bool blinking(const blink_t *blink) {
+  return blink->on_ms > 0 && blink->off_ms > 0;
+}
+
+// Next phase of the running pattern (esp_timer task)
+static void led_step(void *arg) {
+  portENTER_CRITICAL(&led_lock);
+  const blink_t *blink = &patterns[current];
+  bool running = blinking(blink);
+  if (running) {
+    lit = !lit;
+  }
+  bool level = lit;
+  uint32_t phase_ms = level ? blink->on_ms : blink->off_ms;
+  portEXIT_CRITICAL(&led_lock);
+
+  if (!running)
+    return; // Switched to a steady pattern meanwhile
+  gpio_set_level(led_pin, level ? 1 : 0);
+  esp_timer_start_once(step_timer, (uint64_t)phase_ms * 1000);
+}
+
+bool status_led_init(gpio_num_t pin) {
+  gpio_reset_pin(pin);
+  gpio_set_direction(pin, GPIO_MODE_OUTPUT);
+  gpio_set_level(pin, 0);
+
+  const esp_timer_create_args_t timer_args = {
+    .callback = led_step,
+    .arg = NULL,
+    .dispatch_method = ESP_TIMER_TASK,
+    .name = "status_led",
+    .skip_unhandled_events = true,
+  };
+  esp_err_t result = esp_timer_create(&timer_args, &step_timer);
+  if (result != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to create LED timer: %s", esp_err_to_name(result));
+    return false;
+  }
+  led_pin = pin;
+  return true;
+}
+
+void status_led_set(status_led_pattern_t pattern) {
+  if (step_timer == NULL || pattern >= STATUS_LED_PATTERN_COUNT)
+    return;
+
+  portENTER_CRITICAL(&led_lock);
+  bool changed = pattern != current;
+  if (changed) {
+    current = pattern;
+    lit = patterns[pattern].on_ms > 0;
+  }
+  bool level = lit;
+  portEXIT_CRITICAL(&led_lock);
+  if (!changed)
+    return;
+
+  // A step already under way sees the new pattern and restarts from there
+  esp_timer_stop(step_timer);
+  gpio_set_level(led_pin, level ? 1 : 0);
+  if (blinking(&patterns[pattern])) {
+    esp_timer_start_once(step_timer, (uint64_t)patterns[pattern].on_ms * 1000);
+  }
+}
@@ -0,0 +1,50 @@
+#include "../include/system_state.h"
+
+static radio_clock_t *state_clock(SystemState *state, uint8_t record) {
+  switch (record) {
+  case RADIO_RECORD_PLAY_CLOCK:
+    return &state->play_clock;
+  case RADIO_RECORD_GAME_CLOCK:
+    return &state->game_clock;
+  case RADIO_RECORD_SHOT_CLOCK:
+    return &state->shot_clock;
+  default:
+    return NULL;
+  }
+}
+
+void system_state_apply(SystemState *state, const radio_message_t *message) {
+  uint16_t fields = message->fields;
+  if (fields & RADIO_FIELD(RADIO_RECORD_PLAY_CLOCK)) {
+    state->seconds = message->seconds;
+    state->play_clock = message->play_clock;
+  }
+  if (fields & RADIO_FIELD(RADIO_RECORD_GAME_CLOCK))
+    state->game_clock = message->game_clock;
+  if (fields & RADIO_FIELD(RADIO_RECORD_SHOT_CLOCK))
+    state->shot_clock = message->shot_clock;
+  if (fields & RADIO_FIELD(RADIO_RECORD_PERIOD))
+    state->period = message->period;
+  if (fields & RADIO_FIELD(RADIO_RECORD_COLOR)) {
+    state->r = message->r;
+    state->g = message->g;
+    state->b = message->b;
+  }
+
+  // Run/stop commands override the run flag of the clock they name
+  state->command = RADIO_COMMAND_NONE;
+  if (fields & RADIO_FIELD(RADIO_RECORD_COMMAND)) {
+    state->command = message->command;
+    state->command_clock = message->command_clock;
+    radio_clock_t *clock = state_clock(state, message->command_clock);
+    if (clock != NULL && message->command == RADIO_COMMAND_RUN) {
+      clock->flags |= RADIO_CLOCK_RUNNING;
+    } else if (clock != NULL && message->command == RADIO_COMMAND_STOP) {
+      clock->flags &= ~RADIO_CLOCK_RUNNING;
+    }
+  }
+
+  state->protocol_version = message->version;
+  state->fields |= fields;
+  state->sequence = message->sequence;
+}